@@ -0,0 +1,108 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "algo/crypt/crc.h"
+#include "algo/range.h"
+#include "bench_support/benchmark.h"
+#include "io/memory_byte_stream.h"
+
+using namespace au;
+
+static const size_t bulk_size = 1024 * 1024 * 1024;
+static const size_t copy_size = 64 * 1024 * 1024;
+static const size_t small_size = 256;
+
+static bstr make_input(const size_t size)
+{
+    bstr input(size);
+    u32 seed = 1;
+    for (auto &c : input)
+    {
+        seed = seed * 1103515245 + 12345;
+        c = seed >> 16;
+    }
+    return input;
+}
+
+static void benchmark_crc(bench::Session &session)
+{
+    const auto input = make_input(bulk_size);
+    const auto data = input.get<const u8>();
+
+    session.measure("algo/crypt/crc32", bulk_size, 1, [&]()
+    {
+        algo::crypt::crc32(data, bulk_size);
+    });
+
+    session.measure("algo/crypt/crc32c", bulk_size, 1, [&]()
+    {
+        algo::crypt::crc(algo::crypt::CrcKind::Crc32c, data, bulk_size);
+    });
+
+    session.measure("algo/crypt/crc16-hca", bulk_size, 1, [&]()
+    {
+        algo::crypt::crc(algo::crypt::CrcKind::Crc16Hca, data, bulk_size);
+    });
+
+    // generic reflected slice-by-8, for comparison with the CRC-32 kernel
+    algo::crypt::Crc crc64({
+        64, 0x42F0E1EBA9EA3693, 0xFFFFFFFFFFFFFFFF, true, 0xFFFFFFFFFFFFFFFF});
+    session.measure("algo/crypt/crc64-xz", bulk_size, 1, [&]()
+    {
+        crc64.reset();
+        crc64.update(data, bulk_size);
+    });
+
+    // per-block checksums, as done by the HCA decoder
+    const auto small_count = copy_size / small_size;
+    session.measure("algo/crypt/crc16-hca-small", copy_size, 1, [&]()
+    {
+        for (const auto i : algo::range(small_count))
+        {
+            algo::crypt::crc(
+                algo::crypt::CrcKind::Crc16Hca,
+                data + i * small_size,
+                small_size);
+        }
+    });
+
+    const auto copy_input = input.substr(0, copy_size);
+    session.measure("algo/crypt/crc32-copy-then-checksum", copy_size, 1, [&]()
+    {
+        io::MemoryByteStream input_stream(copy_input);
+        io::MemoryByteStream output_stream;
+        output_stream.write(input_stream, copy_size);
+        algo::crypt::crc32(output_stream.seek(0).read_to_eof());
+    });
+
+    session.measure("algo/crypt/crc32-fused-copy", copy_size, 1, [&]()
+    {
+        io::MemoryByteStream input_stream(copy_input);
+        io::MemoryByteStream output_stream;
+        algo::crypt::Crc crc(algo::crypt::CrcKind::Crc32);
+        output_stream.write(
+            input_stream,
+            copy_size,
+            [&](const u8 *chunk, const size_t size)
+            {
+                crc.update(chunk, size);
+            });
+        crc.digest();
+    });
+}
+
+static auto _ = bench::register_benchmark("algo/crypt/crc", benchmark_crc);
@@ -0,0 +1,116 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "algo/crypt/aes.h"
+#include "algo/crypt/blowfish.h"
+#include "algo/crypt/hmac.h"
+#include "algo/crypt/md5.h"
+#include "algo/crypt/sha1.h"
+#include "algo/range.h"
+#include "bench_support/benchmark.h"
+#include "bench_support/fixtures.h"
+
+using namespace au;
+
+static const size_t bulk_size = 1024 * 1024;
+static const size_t small_count = 16 * 1024;
+
+static void benchmark_crypt(bench::Session &session)
+{
+    const auto input = bench::make_compressible_data(bulk_size);
+    const auto key = bench::make_compressible_data(32, 2);
+    const auto iv = bench::make_compressible_data(16, 3);
+
+    session.measure("algo/crypt/md5", bulk_size, 1, [&]()
+    {
+        algo::crypt::md5(input);
+    });
+
+    session.measure("algo/crypt/sha1", bulk_size, 1, [&]()
+    {
+        algo::crypt::sha1(input);
+    });
+
+    // per-block key derivation, as done by the NSA and CPZ5 decoders
+    session.measure("algo/crypt/md5+sha1-small", small_count * 8, 1, [&]()
+    {
+        for (const auto i : algo::range(small_count))
+        {
+            const auto block = input.substr(i * 8, 8);
+            algo::crypt::md5(block);
+            algo::crypt::sha1(block);
+        }
+    });
+
+    session.measure(
+        "algo/crypt/md5+sha1-small-streaming", small_count * 8, 1, [&]()
+    {
+        algo::crypt::Md5 md5;
+        algo::crypt::Sha1 sha1;
+        u8 md5_hash[algo::crypt::Md5::digest_size];
+        u8 sha1_hash[algo::crypt::Sha1::digest_size];
+        for (const auto i : algo::range(small_count))
+        {
+            md5.update(input.get<const u8>() + i * 8, 8);
+            md5.finalize(md5_hash);
+            sha1.update(input.get<const u8>() + i * 8, 8);
+            sha1.finalize(sha1_hash);
+        }
+    });
+
+    session.measure("algo/crypt/hmac-sha512-small", small_count * 16, 1, [&]()
+    {
+        for (const auto i : algo::range(small_count))
+        {
+            algo::crypt::hmac(
+                key, input.substr(i * 16, 16), algo::crypt::HmacKind::Sha512);
+        }
+    });
+
+    session.measure(
+        "algo/crypt/hmac-sha512-small-streaming", small_count * 16, 1, [&]()
+    {
+        algo::crypt::Hmac hmac(algo::crypt::HmacKind::Sha512);
+        u8 output[64];
+        for (const auto i : algo::range(small_count))
+        {
+            hmac.init(input.get<const u8>() + i * 16, 16);
+            hmac.update(key.get<const u8>(), key.size());
+            hmac.finalize(output);
+        }
+    });
+
+    const auto encrypted = algo::crypt::aes256_encrypt_cbc(input, iv, key);
+    session.measure("algo/crypt/aes256-cbc", bulk_size, 1, [&]()
+    {
+        algo::crypt::aes256_decrypt_cbc(encrypted, iv, key);
+    });
+
+    const algo::crypt::Blowfish blowfish(key);
+    session.measure("algo/crypt/blowfish", bulk_size, 1, [&]()
+    {
+        blowfish.decrypt(input);
+    });
+
+    session.measure("algo/crypt/blowfish-setup", 0, small_count / 16, [&]()
+    {
+        for (const auto i : algo::range(small_count / 16))
+            algo::crypt::Blowfish blowfish(input.substr(i * 16, 16));
+    });
+}
+
+static auto _ = bench::register_benchmark("algo/crypt", benchmark_crypt);
@@ -0,0 +1,86 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "algo/crypt/xor.h"
+#include "algo/binary.h"
+#include "algo/range.h"
+#include "bench_support/benchmark.h"
+
+using namespace au;
+
+static const size_t bulk_size = 256 * 1024 * 1024;
+
+static void benchmark_xor(bench::Session &session)
+{
+    bstr data(bulk_size);
+    const auto key = "\xBD\xAA\xBC\xB4\xAB\xB6\xBC\xB4\x01\x02\x03"_b;
+
+    // the loop most decoders used to carry around
+    session.measure("algo/crypt/xor-repeating-naive", bulk_size, 1, [&]()
+    {
+        for (const auto i : algo::range(data.size()))
+            data[i] ^= key[i % key.size()];
+    });
+
+    session.measure("algo/crypt/xor-repeating", bulk_size, 1, [&]()
+    {
+        algo::crypt::xor_repeating(data, key);
+    });
+
+    session.measure("algo/crypt/xor-rolling", bulk_size, 1, [&]()
+    {
+        algo::crypt::xor_rolling(data.get<u8>(), data.size(), 0xC5, 0x5C);
+    });
+
+    session.measure("algo/crypt/xor-packed-add", bulk_size, 1, [&]()
+    {
+        algo::crypt::xor_packed_add(
+            data.get<u8>(),
+            data.size(),
+            0xA73C5F9DA73C5F9D,
+            0xCE24F523CE24F523,
+            algo::crypt::PackedLanes::U32);
+    });
+
+    // QLiE's basic encryption, before and after
+    session.measure("algo/crypt/xor-packed-add-chained-naive", bulk_size, 1,
+        [&]()
+        {
+            auto current = data.get<u64>();
+            const auto end = current + data.size() / 8;
+            u64 key = 0xA73C5F9DA73C5F9D;
+            u64 feedback = 0x1234567812345678;
+            while (current < end)
+            {
+                key = algo::padd(key, 0xCE24F523CE24F523) ^ feedback;
+                feedback = *current++ ^= key;
+            }
+        });
+
+    session.measure("algo/crypt/xor-packed-add-chained", bulk_size, 1, [&]()
+    {
+        algo::crypt::xor_packed_add_chained(
+            data.get<u8>(),
+            data.size(),
+            0xA73C5F9DA73C5F9D,
+            0xCE24F523CE24F523,
+            0x1234567812345678,
+            algo::crypt::PackedLanes::U32);
+    });
+}
+
+static auto _ = bench::register_benchmark("algo/crypt/xor", benchmark_xor);
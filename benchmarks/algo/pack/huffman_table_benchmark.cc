@@ -0,0 +1,131 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "algo/pack/huffman_table.h"
+#include <array>
+#include "algo/range.h"
+#include "bench_support/benchmark.h"
+#include "bench_support/fixtures.h"
+#include "io/memory_byte_stream.h"
+
+using namespace au;
+
+static const size_t symbol_count = 4 * 1024 * 1024;
+
+namespace
+{
+    // The bitwise tree walk the decoders used before the table engine
+    struct Tree final
+    {
+        std::vector<std::array<u32, 2>> nodes;
+    };
+}
+
+static const u32 leaf_flag = 0x80000000;
+
+static std::vector<size_t> make_code_sizes()
+{
+    // an incomplete but realistic mix of short and long codes
+    std::vector<size_t> code_sizes(256);
+    for (const auto i : algo::range(256))
+        code_sizes[i] = i < 16 ? 5 : i < 80 ? 8 : i < 200 ? 11 : 14;
+    return code_sizes;
+}
+
+static Tree make_tree(const std::vector<algo::pack::HuffmanTable::Code> &codes)
+{
+    Tree tree;
+    tree.nodes.push_back({0, 0});
+    for (const auto &code : codes)
+    {
+        u32 node = 0;
+        for (const auto i : algo::range(code.size))
+        {
+            const auto bit = (code.bits >> (code.size - 1 - i)) & 1;
+            if (static_cast<size_t>(i) + 1 == code.size)
+            {
+                tree.nodes[node][bit] = code.symbol | leaf_flag;
+                break;
+            }
+            if (!tree.nodes[node][bit])
+            {
+                tree.nodes[node][bit] = tree.nodes.size();
+                tree.nodes.push_back({0, 0});
+            }
+            node = tree.nodes[node][bit];
+        }
+    }
+    return tree;
+}
+
+static void benchmark_huffman(bench::Session &session)
+{
+    const auto code_sizes = make_code_sizes();
+    const auto table = algo::pack::HuffmanTable::from_code_sizes(code_sizes);
+
+    // same canonical assignment as the table uses
+    std::vector<algo::pack::HuffmanTable::Code> codes;
+    u32 bits = 0;
+    size_t size = 0;
+    for (const auto code_size : {5, 8, 11, 14})
+    {
+        bits <<= code_size - size;
+        size = code_size;
+        for (const auto symbol : algo::range(256))
+            if (code_sizes[symbol] == size)
+                codes.push_back({bits++, size, static_cast<u32>(symbol)});
+    }
+    const auto tree = make_tree(codes);
+
+    const auto symbols = bench::make_compressible_data(symbol_count);
+    io::MemoryByteStream output_stream;
+    {
+        io::MsbBitStream bit_stream(output_stream);
+        for (const auto symbol : symbols)
+        {
+            const auto &code = codes[symbol];
+            bit_stream.write(code.size, code.bits);
+        }
+    }
+    const auto input = output_stream.seek(0).read_to_eof();
+
+    // symbols are bytes, so bytes per second read as symbols per second
+    session.measure("algo/pack/huffman/bitwise", symbols.size(), 1, [&]()
+    {
+        io::MsbBitStream bit_stream(input);
+        bstr output(symbols.size());
+        for (const auto i : algo::range(output.size()))
+        {
+            u32 node = 0;
+            do
+                node = tree.nodes[node][bit_stream.read(1)];
+            while (!(node & leaf_flag));
+            output[i] = node;
+        }
+    });
+
+    session.measure("algo/pack/huffman/table", symbols.size(), 1, [&]()
+    {
+        io::MsbBitStream bit_stream(input);
+        bstr output(symbols.size());
+        for (const auto i : algo::range(output.size()))
+            output[i] = table.decode(bit_stream);
+    });
+}
+
+static auto _ = bench::register_benchmark(
+    "algo/pack/huffman", benchmark_huffman);
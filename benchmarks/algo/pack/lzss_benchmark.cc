@@ -0,0 +1,60 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "algo/pack/lzss.h"
+#include "bench_support/benchmark.h"
+#include "bench_support/fixtures.h"
+
+using namespace au;
+
+static const size_t data_size = 4 * 1024 * 1024;
+
+static void benchmark_lzss(bench::Session &session)
+{
+    const auto input = bench::make_compressible_data(data_size);
+
+    algo::pack::BitwiseLzssSettings bitwise_settings;
+    bitwise_settings.position_bits = 12;
+    bitwise_settings.size_bits = 4;
+    bitwise_settings.min_match_size = 3;
+    bitwise_settings.initial_dictionary_pos = 0xFEE;
+    const auto bitwise_input
+        = algo::pack::lzss_compress(input, bitwise_settings);
+    session.measure("algo/pack/lzss/bitwise-decompress", input.size(), 1, [&]()
+    {
+        algo::pack::lzss_decompress(
+            bitwise_input, input.size(), bitwise_settings);
+    });
+
+    algo::pack::BytewiseLzssSettings bytewise_settings;
+    const auto bytewise_input
+        = algo::pack::lzss_compress(input, bytewise_settings);
+    session.measure("algo/pack/lzss/bytewise-decompress", input.size(), 1, [&]()
+    {
+        algo::pack::lzss_decompress(
+            bytewise_input, input.size(), bytewise_settings);
+    });
+
+    const auto small_input = input.substr(0, data_size / 16);
+    session.measure(
+        "algo/pack/lzss/bitwise-compress", small_input.size(), 1, [&]()
+        {
+            algo::pack::lzss_compress(small_input, bitwise_settings);
+        });
+}
+
+static auto _ = bench::register_benchmark("algo/pack/lzss", benchmark_lzss);
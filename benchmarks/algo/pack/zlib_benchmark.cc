@@ -0,0 +1,48 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "algo/pack/zlib.h"
+#include "bench_support/benchmark.h"
+#include "bench_support/fixtures.h"
+
+using namespace au;
+
+static const size_t data_size = 16 * 1024 * 1024;
+
+static void benchmark_zlib(bench::Session &session)
+{
+    const auto input = bench::make_compressible_data(data_size);
+    const auto deflated_input = algo::pack::zlib_deflate(
+        input,
+        algo::pack::ZlibKind::PlainZlib,
+        algo::pack::CompressionLevel::Good);
+
+    session.measure("algo/pack/zlib/inflate", input.size(), 1, [&]()
+    {
+        algo::pack::zlib_inflate(deflated_input);
+    });
+
+    session.measure("algo/pack/zlib/deflate-fast", input.size(), 1, [&]()
+    {
+        algo::pack::zlib_deflate(
+            input,
+            algo::pack::ZlibKind::PlainZlib,
+            algo::pack::CompressionLevel::Fast);
+    });
+}
+
+static auto _ = bench::register_benchmark("algo/pack/zlib", benchmark_zlib);
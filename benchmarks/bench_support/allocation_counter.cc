@@ -0,0 +1,68 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "bench_support/allocation_counter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace au;
+
+static std::atomic<u64> allocation_count(0);
+
+static void *allocate(const size_t size)
+{
+    allocation_count++;
+    if (auto ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+u64 bench::get_allocation_count()
+{
+    return allocation_count;
+}
+
+void *operator new(const size_t size)
+{
+    return allocate(size);
+}
+
+void *operator new[](const size_t size)
+{
+    return allocate(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, const size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, const size_t) noexcept
+{
+    std::free(ptr);
+}
@@ -20,9 +20,9 @@
 #include "types.h"
 
 namespace au {
-namespace algo {
-namespace crypt {
+namespace bench {
 
-    u32 crc32(const bstr &input);
+    // Number of heap allocations made through operator new so far
+    u64 get_allocation_count();
 
-} } }
+} }
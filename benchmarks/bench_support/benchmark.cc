@@ -0,0 +1,122 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "bench_support/benchmark.h"
+#include <algorithm>
+#include <chrono>
+#include "bench_support/allocation_counter.h"
+
+#if _WIN32
+    #include <windows.h>
+    #include <psapi.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+using namespace au;
+using namespace au::bench;
+
+static std::vector<Benchmark> &benchmarks()
+{
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+Session::Session(const double min_time, const size_t thread_count)
+    : min_time(min_time), thread_count(thread_count)
+{
+}
+
+size_t Session::get_thread_count() const
+{
+    return thread_count;
+}
+
+void Session::measure(
+    const std::string &name,
+    const uoff_t bytes,
+    const size_t files,
+    const std::function<void()> kernel)
+{
+    // warm up caches and lazily initialized tables
+    kernel();
+
+    size_t iterations = 0;
+    const auto allocations_begin = get_allocation_count();
+    const auto begin = std::chrono::steady_clock::now();
+    double seconds = 0;
+    do
+    {
+        kernel();
+        iterations++;
+        seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - begin).count();
+    }
+    while (seconds < min_time);
+
+    Result result;
+    result.name = name;
+    result.iterations = iterations;
+    result.seconds = seconds;
+    result.bytes_per_iteration = bytes;
+    result.files_per_iteration = files;
+    result.allocations = get_allocation_count() - allocations_begin;
+    result.peak_rss = get_peak_rss();
+    results.push_back(result);
+}
+
+const std::vector<Result> &Session::get_results() const
+{
+    return results;
+}
+
+std::vector<Benchmark> bench::get_benchmarks()
+{
+    auto ret = benchmarks();
+    std::sort(
+        ret.begin(),
+        ret.end(),
+        [](const Benchmark &a, const Benchmark &b) { return a.name < b.name; });
+    return ret;
+}
+
+bool bench::register_benchmark(
+    const std::string &name, const BenchmarkFunc func)
+{
+    benchmarks().push_back({name, func});
+    return true;
+}
+
+uoff_t bench::get_peak_rss()
+{
+    #if _WIN32
+        PROCESS_MEMORY_COUNTERS counters;
+        if (!GetProcessMemoryInfo(
+                GetCurrentProcess(), &counters, sizeof(counters)))
+            return 0;
+        return counters.PeakWorkingSetSize;
+    #else
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+            return 0;
+        #if __APPLE__
+            return usage.ru_maxrss;
+        #else
+            return static_cast<uoff_t>(usage.ru_maxrss) * 1024;
+        #endif
+    #endif
+}
@@ -0,0 +1,77 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "types.h"
+
+namespace au {
+namespace bench {
+
+    struct Result final
+    {
+        std::string name;
+        size_t iterations;
+        double seconds;
+        uoff_t bytes_per_iteration;
+        size_t files_per_iteration;
+        u64 allocations;
+        uoff_t peak_rss;
+    };
+
+    class Session final
+    {
+    public:
+        Session(const double min_time, const size_t thread_count);
+
+        size_t get_thread_count() const;
+
+        // Runs the kernel repeatedly for at least min_time seconds. Bytes and
+        // files describe the work done by a single call of the kernel.
+        void measure(
+            const std::string &name,
+            const uoff_t bytes,
+            const size_t files,
+            const std::function<void()> kernel);
+
+        const std::vector<Result> &get_results() const;
+
+    private:
+        const double min_time;
+        const size_t thread_count;
+        std::vector<Result> results;
+    };
+
+    using BenchmarkFunc = std::function<void(Session &)>;
+
+    struct Benchmark final
+    {
+        std::string name;
+        BenchmarkFunc func;
+    };
+
+    // Sorted by name, so that the results can be compared between runs
+    std::vector<Benchmark> get_benchmarks();
+    bool register_benchmark(const std::string &name, const BenchmarkFunc func);
+
+    // Peak resident set size of the whole process so far, in bytes
+    uoff_t get_peak_rss();
+
+} }
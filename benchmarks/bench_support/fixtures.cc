@@ -0,0 +1,168 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "bench_support/fixtures.h"
+#include <algorithm>
+#include "algo/locale.h"
+#include "algo/pack/zlib.h"
+#include "algo/range.h"
+#include "io/memory_byte_stream.h"
+
+using namespace au;
+using namespace au::bench;
+
+static const bstr xp3_magic = "XP3\r\n\x20\x0A\x1A\x8B\x67\x01"_b;
+
+namespace
+{
+    class XorShift final
+    {
+    public:
+        XorShift(const u32 seed) : state(seed ? seed : 1)
+        {
+        }
+
+        u32 next()
+        {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return state;
+        }
+
+    private:
+        u32 state;
+    };
+}
+
+static void write_chunk(
+    io::BaseByteStream &output_stream, const bstr &magic, const bstr &data)
+{
+    output_stream.write(magic);
+    output_stream.write_le<u64>(data.size());
+    output_stream.write(data);
+}
+
+bstr bench::make_compressible_data(const size_t size, const u32 seed)
+{
+    XorShift random(seed);
+    bstr output(size);
+    size_t pos = 0;
+    while (pos < size)
+    {
+        const auto roll = random.next();
+        const auto chunk_size = std::min<size_t>(size - pos, 4 + roll % 60);
+        if (pos > 256 && roll & 0x10000)
+        {
+            // repeat something recent, like most real data does
+            const auto max_distance = std::min<size_t>(pos, 4096);
+            const auto distance = 1 + (roll >> 20) % max_distance;
+            for (const auto i : algo::range(chunk_size))
+                output[pos + i] = output[pos + i - distance];
+        }
+        else
+        {
+            // skewed towards small values to give entropy coders some work
+            for (const auto i : algo::range(chunk_size))
+                output[pos + i] = (random.next() & random.next()) & 0xFF;
+        }
+        pos += chunk_size;
+    }
+    return output;
+}
+
+res::Image bench::make_test_image(const size_t width, const size_t height)
+{
+    res::Image image(width, height);
+    XorShift random(width ^ (height << 16));
+    for (const auto y : algo::range(height))
+    for (const auto x : algo::range(width))
+    {
+        auto &pixel = image.at(x, y);
+        pixel.r = (x * 255 / width) & 0xFF;
+        pixel.g = (y * 255 / height) & 0xFF;
+        pixel.b = ((x ^ y) + (random.next() & 7)) & 0xFF;
+        pixel.a = 0xFF - ((x + y) & 0x3F);
+    }
+    return image;
+}
+
+bstr bench::make_xp3_archive(
+    const std::vector<std::shared_ptr<io::File>> &input_files,
+    const size_t segment_size)
+{
+    io::MemoryByteStream output_stream;
+    output_stream.write(xp3_magic);
+    output_stream.write_le<u64>(0); // table offset, patched below
+
+    io::MemoryByteStream table_stream;
+    for (const auto &input_file : input_files)
+    {
+        const auto data = input_file->stream.seek(0).read_to_eof();
+        const auto name = algo::utf8_to_utf16(input_file->path.str());
+
+        io::MemoryByteStream segm_stream;
+        uoff_t total_size_comp = 0;
+        for (size_t pos = 0; pos < data.size(); pos += segment_size)
+        {
+            const auto segment = data.substr(pos, segment_size);
+            const auto segment_comp = algo::pack::zlib_deflate(
+                segment,
+                algo::pack::ZlibKind::PlainZlib,
+                algo::pack::CompressionLevel::Fast);
+            segm_stream.write_le<u32>(1);
+            segm_stream.write_le<u64>(output_stream.pos());
+            segm_stream.write_le<u64>(segment.size());
+            segm_stream.write_le<u64>(segment_comp.size());
+            output_stream.write(segment_comp);
+            total_size_comp += segment_comp.size();
+        }
+
+        io::MemoryByteStream info_stream;
+        info_stream.write_le<u32>(0);
+        info_stream.write_le<u64>(data.size());
+        info_stream.write_le<u64>(total_size_comp);
+        info_stream.write_le<u16>(name.size() / 2);
+        info_stream.write(name);
+
+        io::MemoryByteStream adlr_stream;
+        adlr_stream.write_le<u32>(0);
+
+        io::MemoryByteStream entry_stream;
+        write_chunk(entry_stream, "info"_b, info_stream.seek(0).read_to_eof());
+        write_chunk(entry_stream, "segm"_b, segm_stream.seek(0).read_to_eof());
+        write_chunk(entry_stream, "adlr"_b, adlr_stream.seek(0).read_to_eof());
+        write_chunk(table_stream, "File"_b, entry_stream.seek(0).read_to_eof());
+    }
+
+    const auto table_offset = output_stream.pos();
+    const auto table_data = table_stream.seek(0).read_to_eof();
+    const auto table_data_comp = algo::pack::zlib_deflate(table_data);
+    output_stream.write<u8>(1);
+    output_stream.write_le<u64>(table_data_comp.size());
+    output_stream.write_le<u64>(table_data.size());
+    output_stream.write(table_data_comp);
+    output_stream.seek(xp3_magic.size()).write_le<u64>(table_offset);
+    return output_stream.seek(0).read_to_eof();
+}
+
+std::unique_ptr<io::File> bench::read_test_file(const io::path &path)
+{
+    io::File file(path, io::FileMode::Read);
+    return std::make_unique<io::File>(
+        path.name(), file.stream.seek(0).read_to_eof());
+}
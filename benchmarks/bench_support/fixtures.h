@@ -0,0 +1,43 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "io/file.h"
+#include "res/image.h"
+
+namespace au {
+namespace bench {
+
+    // Pseudo-random data with a fair amount of repetition, so that the
+    // compressors have something to work with. Same seed gives same data.
+    bstr make_compressible_data(const size_t size, const u32 seed = 1);
+
+    res::Image make_test_image(const size_t width, const size_t height);
+
+    // Builds an unencrypted XP3 archive. Each file gets split into zlib
+    // compressed segments of given size.
+    bstr make_xp3_archive(
+        const std::vector<std::shared_ptr<io::File>> &input_files,
+        const size_t segment_size);
+
+    // Fixtures that cannot be generated are borrowed from the test suite.
+    std::unique_ptr<io::File> read_test_file(const io::path &path);
+
+} }
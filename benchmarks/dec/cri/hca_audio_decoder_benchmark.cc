@@ -15,34 +15,25 @@
 // You should have received a copy of the GNU General Public License
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
-#include "algo/crypt/crc32.h"
-#include "algo/range.h"
+#include "dec/cri/hca_audio_decoder.h"
+#include "bench_support/benchmark.h"
+#include "bench_support/fixtures.h"
 
 using namespace au;
 
-static u32 reverse(u32 x)
+static void benchmark_hca(bench::Session &session)
 {
-    x = ((x & 0x55555555) << 1) | ((x >> 1) & 0x55555555);
-    x = ((x & 0x33333333) << 2) | ((x >> 2) & 0x33333333);
-    x = ((x & 0x0F0F0F0F) << 4) | ((x >> 4) & 0x0F0F0F0F);
-    x = (x << 24) | ((x & 0xFF00) << 8) | ((x >> 8) & 0xFF00) | (x >> 24);
-    return x;
-}
+    Logger dummy_logger;
+    dummy_logger.mute();
 
-u32 algo::crypt::crc32(const bstr &input)
-{
-    u32 crc = 0xFFFFFFFF;
-    for (const auto c : input)
+    const dec::cri::HcaAudioDecoder decoder;
+    const auto input_file
+        = bench::read_test_file("tests/dec/cri/files/hca/test.hca");
+    const auto audio = decoder.decode(dummy_logger, *input_file);
+    session.measure("dec/cri/hca/decode", audio.samples.size(), 1, [&]()
     {
-        u32 byte = reverse(c);
-        for (const auto j : algo::range(8))
-        {
-            if (static_cast<int>(crc ^ byte) < 0)
-                crc = (crc << 1) ^ 0x04C11DB7;
-            else
-                crc = crc << 1;
-            byte <<= 1;
-        }
-    }
-    return reverse(~crc);
+        decoder.decode(dummy_logger, *input_file);
+    });
 }
+
+static auto _ = bench::register_benchmark("dec/cri/hca", benchmark_hca);
@@ -0,0 +1,37 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "dec/fc01/common/custom_lzss.h"
+#include "bench_support/benchmark.h"
+#include "bench_support/fixtures.h"
+
+using namespace au;
+
+static const size_t output_size = 4 * 1024 * 1024;
+
+static void benchmark_custom_lzss(bench::Session &session)
+{
+    // every byte sequence is a valid stream, so noise makes a fine input
+    const auto input = bench::make_compressible_data(output_size / 2);
+    session.measure("dec/fc01/common/custom-lzss", output_size, 1, [&]()
+    {
+        dec::fc01::common::custom_lzss_decompress(input, output_size);
+    });
+}
+
+static auto _ = bench::register_benchmark(
+    "dec/fc01/common/custom-lzss", benchmark_custom_lzss);
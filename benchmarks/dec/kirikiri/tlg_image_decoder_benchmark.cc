@@ -0,0 +1,48 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "dec/kirikiri/tlg_image_decoder.h"
+#include "bench_support/benchmark.h"
+#include "bench_support/fixtures.h"
+
+using namespace au;
+
+static const io::path dir = "tests/dec/kirikiri/files/tlg/";
+
+static void measure_tlg(
+    bench::Session &session, const std::string &name, const io::path &path)
+{
+    Logger dummy_logger;
+    dummy_logger.mute();
+
+    const dec::kirikiri::TlgImageDecoder decoder;
+    const auto input_file = bench::read_test_file(path);
+    const auto image = decoder.decode(dummy_logger, *input_file);
+    const auto image_size = image.width() * image.height() * 4;
+    session.measure(name, image_size, 1, [&]()
+    {
+        decoder.decode(dummy_logger, *input_file);
+    });
+}
+
+static void benchmark_tlg(bench::Session &session)
+{
+    measure_tlg(session, "dec/kirikiri/tlg/tlg5", dir / "14.tlg");
+    measure_tlg(session, "dec/kirikiri/tlg/tlg6", dir / "tlg6.tlg");
+}
+
+static auto _ = bench::register_benchmark("dec/kirikiri/tlg", benchmark_tlg);
@@ -0,0 +1,63 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "dec/kirikiri/xp3_archive_decoder.h"
+#include "algo/format.h"
+#include "algo/range.h"
+#include "bench_support/benchmark.h"
+#include "bench_support/fixtures.h"
+
+using namespace au;
+
+static const size_t file_count = 200;
+static const size_t file_size = 64 * 1024;
+static const size_t segment_size = 16 * 1024;
+
+static void benchmark_xp3(bench::Session &session)
+{
+    Logger dummy_logger;
+    dummy_logger.mute();
+
+    std::vector<std::shared_ptr<io::File>> input_files;
+    for (const auto i : algo::range(file_count))
+    {
+        input_files.push_back(std::make_shared<io::File>(
+            algo::format("dir/file-%03d.dat", i),
+            bench::make_compressible_data(file_size, i + 1)));
+    }
+    io::File archive_file(
+        "test.xp3", bench::make_xp3_archive(input_files, segment_size));
+
+    dec::kirikiri::Xp3ArchiveDecoder decoder;
+    decoder.plugin_manager.set("noop");
+
+    session.measure(
+        "dec/kirikiri/xp3/read-meta", archive_file.stream.size(), 1, [&]()
+        {
+            decoder.read_meta(dummy_logger, archive_file);
+        });
+
+    const auto meta = decoder.read_meta(dummy_logger, archive_file);
+    session.measure(
+        "dec/kirikiri/xp3/read-files", file_count * file_size, file_count, [&]()
+        {
+            for (const auto &entry : meta->entries)
+                decoder.read_file(dummy_logger, archive_file, *meta, *entry);
+        });
+}
+
+static auto _ = bench::register_benchmark("dec/kirikiri/xp3", benchmark_xp3);
@@ -0,0 +1,54 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "dec/microsoft/dxt/dxt_decoders.h"
+#include "bench_support/benchmark.h"
+#include "bench_support/fixtures.h"
+#include "io/memory_byte_stream.h"
+
+using namespace au;
+using namespace au::dec::microsoft;
+
+static const size_t width = 4096;
+static const size_t height = 4096;
+
+using DecodeFunc = std::function<std::unique_ptr<res::Image>(
+    io::BaseByteStream &, const size_t, const size_t)>;
+
+static void measure_dxt(
+    bench::Session &session,
+    const std::string &name,
+    const size_t block_size,
+    const DecodeFunc &decode_func)
+{
+    const auto input = bench::make_compressible_data(
+        (width / 4) * (height / 4) * block_size);
+    session.measure(name, width * height * 4, 1, [&]()
+    {
+        io::MemoryByteStream input_stream(input);
+        decode_func(input_stream, width, height);
+    });
+}
+
+static void benchmark_dxt(bench::Session &session)
+{
+    measure_dxt(session, "dec/microsoft/dxt/dxt1", 8, dxt::decode_dxt1);
+    measure_dxt(session, "dec/microsoft/dxt/dxt3", 16, dxt::decode_dxt3);
+    measure_dxt(session, "dec/microsoft/dxt/dxt5", 16, dxt::decode_dxt5);
+}
+
+static auto _ = bench::register_benchmark("dec/microsoft/dxt", benchmark_dxt);
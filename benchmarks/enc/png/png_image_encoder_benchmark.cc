@@ -0,0 +1,47 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "enc/png/png_image_encoder.h"
+#include "bench_support/benchmark.h"
+#include "bench_support/fixtures.h"
+#include "dec/png/png_image_decoder.h"
+
+using namespace au;
+
+static void benchmark_png(bench::Session &session)
+{
+    Logger dummy_logger;
+    dummy_logger.mute();
+
+    const auto image = bench::make_test_image(1024, 1024);
+    const auto image_size = image.width() * image.height() * 4;
+
+    const enc::png::PngImageEncoder encoder;
+    session.measure("enc/png/encode", image_size, 1, [&]()
+    {
+        encoder.encode(dummy_logger, image, "test.png");
+    });
+
+    const auto encoded_file = encoder.encode(dummy_logger, image, "test.png");
+    const dec::png::PngImageDecoder decoder;
+    session.measure("dec/png/decode", image_size, 1, [&]()
+    {
+        decoder.decode(dummy_logger, *encoded_file);
+    });
+}
+
+static auto _ = bench::register_benchmark("enc/png", benchmark_png);
@@ -0,0 +1,103 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "flow/parallel_unpacker.h"
+#include <atomic>
+#include "algo/format.h"
+#include "algo/range.h"
+#include "bench_support/benchmark.h"
+#include "bench_support/fixtures.h"
+#include "flow/file_saver_callback.h"
+
+using namespace au;
+
+static const size_t archive_count = 8;
+static const size_t file_count = 100;
+static const size_t file_size = 64 * 1024;
+static const size_t segment_size = 16 * 1024;
+
+static void measure_unpacking(
+    bench::Session &session,
+    const std::vector<std::shared_ptr<io::File>> &archive_files,
+    const size_t thread_count)
+{
+    Logger dummy_logger;
+    dummy_logger.mute();
+
+    std::atomic<size_t> saved_bytes(0);
+    const flow::FileSaverCallback file_saver(
+        [&](std::shared_ptr<io::File> saved_file)
+        {
+            saved_bytes += saved_file->stream.size();
+        });
+
+    const auto &registry = dec::Registry::instance();
+    const flow::ParallelUnpackerContext context(
+        dummy_logger,
+        file_saver,
+        registry,
+        true,
+        {"--plugin=noop"},
+        {"kirikiri/xp3"},
+        {{"png/png", flow::NestedImagePolicy::Keep}},
+        0);
+
+    session.measure(
+        algo::format("flow/parallel-unpacker/xp3-%d-threads", thread_count),
+        archive_files.size() * file_count * file_size,
+        archive_files.size() * file_count,
+        [&]()
+        {
+            flow::ParallelUnpacker unpacker(context);
+            for (const auto &archive_file : archive_files)
+            {
+                unpacker.add_input_file(
+                    archive_file->path,
+                    [=]() { return std::make_shared<io::File>(*archive_file); },
+                    archive_file->stream.size());
+            }
+            unpacker.run(thread_count);
+        });
+}
+
+static void benchmark_parallel_unpacker(bench::Session &session)
+{
+    if (!dec::Registry::instance().has_decoder("kirikiri/xp3"))
+        return;
+
+    std::vector<std::shared_ptr<io::File>> archive_files;
+    for (const auto i : algo::range(archive_count))
+    {
+        std::vector<std::shared_ptr<io::File>> input_files;
+        for (const auto j : algo::range(file_count))
+        {
+            input_files.push_back(std::make_shared<io::File>(
+                algo::format("file-%03d.dat", j),
+                bench::make_compressible_data(file_size, i * file_count + j)));
+        }
+        archive_files.push_back(std::make_shared<io::File>(
+            algo::format("archive-%d.xp3", i),
+            bench::make_xp3_archive(input_files, segment_size)));
+    }
+
+    measure_unpacking(session, archive_files, 1);
+    if (session.get_thread_count() > 1)
+        measure_unpacking(session, archive_files, session.get_thread_count());
+}
+
+static auto _ = bench::register_benchmark(
+    "flow/parallel-unpacker", benchmark_parallel_unpacker);
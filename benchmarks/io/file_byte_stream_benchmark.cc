@@ -0,0 +1,79 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "io/file_byte_stream.h"
+#include "algo/range.h"
+#include "bench_support/benchmark.h"
+#include "bench_support/fixtures.h"
+#include "io/file_system.h"
+
+using namespace au;
+
+static const io::path path = "trash.bench";
+static const size_t file_size = 16 * 1024 * 1024;
+static const size_t entry_count = 20000;
+static const size_t entry_size = 1024;
+
+static void benchmark_file_byte_stream(bench::Session &session)
+{
+    {
+        io::FileByteStream stream(path, io::FileMode::Write);
+        stream.write(bench::make_compressible_data(file_size));
+    }
+
+    // what reading archive entries used to cost: one open per entry
+    session.measure(
+        "io/file-byte-stream/entries-reopen",
+        entry_count * entry_size,
+        entry_count,
+        [&]()
+        {
+            for (const auto i : algo::range(entry_count))
+            {
+                io::FileByteStream stream(path, io::FileMode::Read);
+                stream.seek(i * 797 % (file_size - entry_size));
+                stream.read(entry_size);
+            }
+        });
+
+    io::FileByteStream archive_stream(path, io::FileMode::Read);
+    session.measure(
+        "io/file-byte-stream/entries-clone",
+        entry_count * entry_size,
+        entry_count,
+        [&]()
+        {
+            for (const auto i : algo::range(entry_count))
+            {
+                const auto stream = archive_stream.clone();
+                stream->seek(i * 797 % (file_size - entry_size));
+                stream->read(entry_size);
+            }
+        });
+
+    session.measure("io/file-byte-stream/small-reads", file_size, 1, [&]()
+    {
+        archive_stream.seek(0);
+        for (const auto i : algo::range(file_size / 4))
+            archive_stream.read_le<u32>();
+    });
+
+    io::remove(path);
+}
+
+static auto _ = bench::register_benchmark(
+    "io/file-byte-stream", benchmark_file_byte_stream);
@@ -0,0 +1,176 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include <thread>
+#include "algo/format.h"
+#include "algo/range.h"
+#include "algo/str.h"
+#include "arg_parser.h"
+#include "bench_support/benchmark.h"
+#include "entry_point.h"
+#include "io/program_path.h"
+#include "logger.h"
+#include "version.h"
+
+using namespace au;
+
+static std::string escape_json(const std::string &input)
+{
+    std::string output;
+    for (const auto c : input)
+    {
+        if (c == '"' || c == '\\')
+            output += '\\';
+        output += c;
+    }
+    return output;
+}
+
+static void print_text_results(
+    const Logger &logger, const std::vector<bench::Result> &results)
+{
+    for (const auto &result : results)
+    {
+        const auto seconds = result.seconds / result.iterations;
+        logger.info(
+            "%-44s %9.2f MB/s %9.2f files/s %9.0f allocs %7.1f MiB RSS\n",
+            result.name.c_str(),
+            result.bytes_per_iteration / seconds / 1000.0 / 1000.0,
+            result.files_per_iteration / seconds,
+            static_cast<double>(result.allocations) / result.iterations,
+            result.peak_rss / 1024.0 / 1024.0);
+    }
+}
+
+static void print_json_results(
+    const Logger &logger,
+    const std::vector<bench::Result> &results,
+    const size_t thread_count)
+{
+    logger.info("{\n");
+    logger.info(
+        "  \"version\": \"%s\",\n",
+        escape_json(au::version_long).c_str());
+    logger.info("  \"threads\": %d,\n", thread_count);
+    logger.info("  \"results\": [\n");
+    for (const auto i : algo::range(results.size()))
+    {
+        const auto &result = results[i];
+        const auto seconds = result.seconds / result.iterations;
+        logger.info(
+            "    {\"name\": \"%s\", \"iterations\": %d, \"seconds\": %f, "
+            "\"bytes_per_sec\": %.0f, \"files_per_sec\": %f, "
+            "\"allocations\": %.0f, \"peak_rss\": %llu}%s\n",
+            escape_json(result.name).c_str(),
+            result.iterations,
+            seconds,
+            result.bytes_per_iteration / seconds,
+            result.files_per_iteration / seconds,
+            static_cast<double>(result.allocations) / result.iterations,
+            static_cast<unsigned long long>(result.peak_rss),
+            i + 1 < static_cast<int>(results.size()) ? "," : "");
+    }
+    logger.info("  ]\n");
+    logger.info("}\n");
+}
+
+ENTRY_POINT(
+    Logger logger;
+    try
+    {
+        io::set_program_path_from_arg(arguments[0]);
+        arguments.erase(arguments.begin());
+
+        ArgParser arg_parser;
+        arg_parser.register_flag({"-h", "--help"})
+            ->set_description("Shows this message.");
+        arg_parser.register_flag({"--json"})
+            ->set_description("Prints the results as JSON.");
+        arg_parser.register_switch({"-f", "--filter"})
+            ->set_value_name("TEXT")
+            ->set_description("Runs only benchmarks whose name contains TEXT.");
+        arg_parser.register_switch({"-t", "--threads"})
+            ->set_value_name("NUM")
+            ->set_description(
+                "Sets worker thread count for end-to-end benchmarks. "
+                "By default, all available cores are used.");
+        arg_parser.register_switch({"--min-time"})
+            ->set_value_name("SECONDS")
+            ->set_description(
+                "Sets minimum time spent measuring each kernel "
+                "(defaults to 1).");
+        arg_parser.parse(arguments);
+
+        if (arg_parser.has_flag("-h") || arg_parser.has_flag("--help"))
+        {
+            logger.info(
+                "Usage: run_benchmarks [options]\n\n"
+                "Must be run from within the repository root directory.\n\n"
+                "[options] can be:\n\n");
+            arg_parser.print_help(logger);
+            return 0;
+        }
+
+        std::string filter;
+        if (arg_parser.has_switch("-f"))
+            filter = arg_parser.get_switch("-f");
+        else if (arg_parser.has_switch("--filter"))
+            filter = arg_parser.get_switch("--filter");
+
+        size_t thread_count = std::thread::hardware_concurrency();
+        if (arg_parser.has_switch("-t"))
+            thread_count = algo::from_string<int>(arg_parser.get_switch("-t"));
+        else if (arg_parser.has_switch("--threads"))
+        {
+            thread_count
+                = algo::from_string<int>(arg_parser.get_switch("--threads"));
+        }
+        if (!thread_count)
+            thread_count = 1;
+
+        const auto min_time = arg_parser.has_switch("--min-time")
+            ? algo::from_string<float>(arg_parser.get_switch("--min-time"))
+            : 1.0;
+
+        const auto json = arg_parser.has_flag("--json");
+        bench::Session session(min_time, thread_count);
+        for (const auto &benchmark : bench::get_benchmarks())
+        {
+            if (benchmark.name.find(filter) == std::string::npos)
+                continue;
+            const auto result_count = session.get_results().size();
+            benchmark.func(session);
+            if (!json)
+            {
+                print_text_results(
+                    logger,
+                    std::vector<bench::Result>(
+                        session.get_results().begin() + result_count,
+                        session.get_results().end()));
+            }
+        }
+
+        if (json)
+            print_json_results(logger, session.get_results(), thread_count);
+        return 0;
+    }
+    catch (const std::exception &e)
+    {
+        logger.err("Error: " + std::string(e.what()) + "\n");
+        return 1;
+    }
+)
@@ -0,0 +1,71 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "res/image.h"
+#include "bench_support/benchmark.h"
+
+using namespace au;
+
+static const size_t width = 4096;
+static const size_t height = 4096;
+static const size_t size = width * height * 4;
+
+static void benchmark_image(bench::Session &session)
+{
+    // decoders that produce BGRA pixels in a buffer of their own
+    session.measure("res/image/from-buffer-copy", size, 1, [&]()
+    {
+        const bstr data(size);
+        res::Image(width, height, data, res::PixelFormat::BGRA8888);
+    });
+
+    session.measure("res/image/from-buffer-adopt", size, 1, [&]()
+    {
+        bstr data(size);
+        res::Image(width, height, std::move(data), res::PixelFormat::BGRA8888);
+    });
+
+    res::Image image(width, height);
+    session.measure("res/image/flip-vertically", size, 1, [&]()
+    {
+        image.flip_vertically();
+    });
+
+    session.measure("res/image/flip-horizontally", size, 1, [&]()
+    {
+        image.flip_horizontally();
+    });
+
+    session.measure("res/image/crop", size, 1, [&]()
+    {
+        image.crop(width - 1, height + 1);
+        image.crop(width, height);
+    });
+
+    session.measure("res/image/offset", size, 1, [&]()
+    {
+        image.offset(1, 1);
+        image.offset(-1, -1);
+    });
+
+    session.measure("res/image/clone-view", size, 1, [&]()
+    {
+        res::Image(image.view(1, 1, width - 2, height - 2));
+    });
+}
+
+static auto _ = bench::register_benchmark("res/image", benchmark_image);
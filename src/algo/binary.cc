@@ -16,8 +16,7 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "algo/binary.h"
-#include "algo/range.h"
-#include "err.h"
+#include "algo/crypt/xor.h"
 
 using namespace au;
 
@@ -25,17 +24,13 @@ using namespace au;
 bstr algo::unxor(const bstr &input, const u8 key)
 {
     bstr output(input);
-    for (const auto i : algo::range(input.size()))
-        output[i] ^= key;
+    algo::crypt::xor_byte(output, key);
     return output;
 }
 
 bstr algo::unxor(const bstr &input, const bstr &key)
 {
-    if (!key.size())
-        throw err::BadDataSizeError();
     bstr output(input);
-    for (const auto i : algo::range(input.size()))
-        output[i] ^= key[i % key.size()];
+    algo::crypt::xor_repeating(output, key);
     return output;
 }
@@ -18,6 +18,7 @@
 #include "algo/crypt/blowfish.h"
 #include <cstring>
 #include <openssl/blowfish.h>
+#include "algo/range.h"
 #include "err.h"
 #include "types.h"
 
@@ -66,14 +67,16 @@ bstr Blowfish::decrypt(const bstr &input) const
 
 void Blowfish::decrypt_in_place(bstr &input) const
 {
-    size_t left = input.size() / BF_BLOCK;
-    size_t pos = 0;
+    decrypt_in_place(input.get<u8>(), input.size());
+}
 
-    while (left)
+void Blowfish::decrypt_in_place(u8 *input, const size_t size) const
+{
+    auto input_ptr = reinterpret_cast<BF_LONG*>(input);
+    for (const auto i : algo::range(size / BF_BLOCK))
     {
-        BF_decrypt(&input.get<BF_LONG>()[pos], p->key.get());
-        left--;
-        pos += BF_BLOCK / sizeof(BF_LONG);
+        BF_decrypt(input_ptr, p->key.get());
+        input_ptr += BF_BLOCK / sizeof(BF_LONG);
     }
 }
 
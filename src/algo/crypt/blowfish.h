@@ -31,6 +31,7 @@ namespace crypt {
         ~Blowfish();
         static size_t block_size();
         void decrypt_in_place(bstr &input) const;
+        void decrypt_in_place(u8 *input, const size_t size) const;
         bstr decrypt(const bstr &input) const;
         bstr encrypt(const bstr &input) const;
 
@@ -0,0 +1,350 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "algo/crypt/crc.h"
+#include <array>
+#include <cstring>
+#include "algo/endian.h"
+#include "algo/range.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+    #define CRC_USE_X86_KERNELS
+    #include <immintrin.h>
+#endif
+
+using namespace au;
+using namespace au::algo::crypt;
+
+namespace
+{
+    using Kernel = u64 (*)(const Crc::Engine &, u64, const u8 *, size_t);
+}
+
+// Reflected CRCs keep the state in the low bits, normal ones keep it in the
+// high bits of a 64-bit register, so that either kind of any width can run
+// through the same slice-by-8 loop: tables[j][b] is the CRC of byte b
+// followed by j zero bytes.
+struct Crc::Engine final
+{
+    Engine(const CrcSpec &spec);
+
+    CrcSpec spec;
+    u64 start_state;
+    std::array<std::array<u64, 256>, 8> tables;
+    Kernel kernel;
+};
+
+static u64 reflect(u64 value, const size_t width)
+{
+    u64 ret = 0;
+    for (const auto i : algo::range(width))
+    {
+        ret = (ret << 1) | (value & 1);
+        value >>= 1;
+    }
+    return ret;
+}
+
+static inline u64 load_le64(const u8 *input)
+{
+    u64 ret;
+    std::memcpy(&ret, input, 8);
+    return algo::from_little_endian(ret);
+}
+
+static inline u64 load_be64(const u8 *input)
+{
+    u64 ret;
+    std::memcpy(&ret, input, 8);
+    return algo::from_big_endian(ret);
+}
+
+static u64 update_reflected(
+    const Crc::Engine &engine, u64 state, const u8 *input, size_t size)
+{
+    const auto &t = engine.tables;
+    while (size >= 8)
+    {
+        const auto x = state ^ load_le64(input);
+        state = t[7][x & 0xFF]
+            ^ t[6][(x >> 8) & 0xFF]
+            ^ t[5][(x >> 16) & 0xFF]
+            ^ t[4][(x >> 24) & 0xFF]
+            ^ t[3][(x >> 32) & 0xFF]
+            ^ t[2][(x >> 40) & 0xFF]
+            ^ t[1][(x >> 48) & 0xFF]
+            ^ t[0][x >> 56];
+        input += 8;
+        size -= 8;
+    }
+    while (size--)
+        state = (state >> 8) ^ t[0][(state ^ *input++) & 0xFF];
+    return state;
+}
+
+static u64 update_normal(
+    const Crc::Engine &engine, u64 state, const u8 *input, size_t size)
+{
+    const auto &t = engine.tables;
+    while (size >= 8)
+    {
+        const auto x = state ^ load_be64(input);
+        state = t[7][x >> 56]
+            ^ t[6][(x >> 48) & 0xFF]
+            ^ t[5][(x >> 40) & 0xFF]
+            ^ t[4][(x >> 32) & 0xFF]
+            ^ t[3][(x >> 24) & 0xFF]
+            ^ t[2][(x >> 16) & 0xFF]
+            ^ t[1][(x >> 8) & 0xFF]
+            ^ t[0][x & 0xFF];
+        input += 8;
+        size -= 8;
+    }
+    while (size--)
+        state = (state << 8) ^ t[0][(state >> 56) ^ *input++];
+    return state;
+}
+
+#ifdef CRC_USE_X86_KERNELS
+    // Folds 64 bytes per iteration with carry-less multiplication and
+    // finishes with a Barrett reduction, after Intel's "Fast CRC Computation
+    // for Generic Polynomials Using PCLMULQDQ Instruction". The constants
+    // are specific to the CRC-32 polynomial.
+    __attribute__((target("pclmul,sse2")))
+    static inline __m128i load(const u8 *input)
+    {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+    }
+
+    __attribute__((target("pclmul,sse2")))
+    static inline __m128i fold(const __m128i x, const __m128i k)
+    {
+        return _mm_xor_si128(
+            _mm_clmulepi64_si128(x, k, 0x00),
+            _mm_clmulepi64_si128(x, k, 0x11));
+    }
+
+    __attribute__((target("pclmul,sse2")))
+    static u64 update_crc32_clmul(
+        const Crc::Engine &engine, u64 state, const u8 *input, size_t size)
+    {
+        if (size < 64)
+            return update_reflected(engine, state, input, size);
+
+        auto x1 = _mm_xor_si128(
+            load(input), _mm_cvtsi32_si128(static_cast<u32>(state)));
+        auto x2 = load(input + 0x10);
+        auto x3 = load(input + 0x20);
+        auto x4 = load(input + 0x30);
+        input += 64;
+        size -= 64;
+
+        const auto k1k2 = _mm_set_epi64x(0x01C6E41596, 0x0154442BD4);
+        while (size >= 64)
+        {
+            x1 = _mm_xor_si128(fold(x1, k1k2), load(input));
+            x2 = _mm_xor_si128(fold(x2, k1k2), load(input + 0x10));
+            x3 = _mm_xor_si128(fold(x3, k1k2), load(input + 0x20));
+            x4 = _mm_xor_si128(fold(x4, k1k2), load(input + 0x30));
+            input += 64;
+            size -= 64;
+        }
+
+        const auto k3k4 = _mm_set_epi64x(0x00CCAA009E, 0x01751997D0);
+        x1 = _mm_xor_si128(fold(x1, k3k4), x2);
+        x1 = _mm_xor_si128(fold(x1, k3k4), x3);
+        x1 = _mm_xor_si128(fold(x1, k3k4), x4);
+        while (size >= 16)
+        {
+            x1 = _mm_xor_si128(fold(x1, k3k4), load(input));
+            input += 16;
+            size -= 16;
+        }
+
+        // 128 bits to 64 bits
+        const auto mask = _mm_setr_epi32(~0, 0, ~0, 0);
+        x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+        x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+        const auto k5 = _mm_set_epi64x(0, 0x0163CD6124);
+        x2 = _mm_srli_si128(x1, 4);
+        x1 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), k5, 0x00);
+        x1 = _mm_xor_si128(x1, x2);
+
+        // Barrett reduction to 32 bits
+        const auto poly = _mm_set_epi64x(0x01F7011641, 0x01DB710641);
+        x2 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), poly, 0x10);
+        x2 = _mm_clmulepi64_si128(_mm_and_si128(x2, mask), poly, 0x00);
+        x1 = _mm_xor_si128(x1, x2);
+        state = static_cast<u32>(_mm_cvtsi128_si32(_mm_srli_si128(x1, 4)));
+
+        return update_reflected(engine, state, input, size);
+    }
+
+    __attribute__((target("sse4.2")))
+    static u64 update_crc32c_hw(
+        const Crc::Engine &engine, u64 state, const u8 *input, size_t size)
+    {
+        while (size >= 8)
+        {
+            u64 x;
+            std::memcpy(&x, input, 8);
+            state = _mm_crc32_u64(state, x);
+            input += 8;
+            size -= 8;
+        }
+        while (size--)
+            state = _mm_crc32_u8(static_cast<u32>(state), *input++);
+        return state;
+    }
+#endif
+
+static Kernel pick_kernel(const CrcSpec &spec)
+{
+    if (!spec.reflected)
+        return update_normal;
+    #ifdef CRC_USE_X86_KERNELS
+        if (spec.width == 32 && spec.poly == 0x04C11DB7
+            && __builtin_cpu_supports("pclmul"))
+        {
+            return update_crc32_clmul;
+        }
+        if (spec.width == 32 && spec.poly == 0x1EDC6F41
+            && __builtin_cpu_supports("sse4.2"))
+        {
+            return update_crc32c_hw;
+        }
+    #endif
+    return update_reflected;
+}
+
+Crc::Engine::Engine(const CrcSpec &spec) : spec(spec)
+{
+    if (spec.width < 1 || spec.width > 64)
+        throw std::logic_error("Unsupported CRC width");
+
+    const auto shift = 64 - spec.width;
+    if (spec.reflected)
+    {
+        const auto poly = reflect(spec.poly, spec.width);
+        for (const auto b : algo::range(256))
+        {
+            u64 r = b;
+            for (const auto i : algo::range(8))
+                r = (r >> 1) ^ (r & 1 ? poly : 0);
+            tables[0][b] = r;
+        }
+        for (const auto j : algo::range(1, 8))
+        for (const auto b : algo::range(256))
+        {
+            const auto prev = tables[j - 1][b];
+            tables[j][b] = (prev >> 8) ^ tables[0][prev & 0xFF];
+        }
+        start_state = reflect(spec.init, spec.width);
+    }
+    else
+    {
+        const auto poly = spec.poly << shift;
+        for (const auto b : algo::range(256))
+        {
+            u64 r = static_cast<u64>(b) << 56;
+            for (const auto i : algo::range(8))
+                r = (r << 1) ^ (r >> 63 ? poly : 0);
+            tables[0][b] = r;
+        }
+        for (const auto j : algo::range(1, 8))
+        for (const auto b : algo::range(256))
+        {
+            const auto prev = tables[j - 1][b];
+            tables[j][b] = (prev << 8) ^ tables[0][prev >> 56];
+        }
+        start_state = spec.init << shift;
+    }
+    kernel = pick_kernel(spec);
+}
+
+static std::shared_ptr<const Crc::Engine> get_engine(const CrcKind kind)
+{
+    static const auto crc16_hca = std::make_shared<const Crc::Engine>(
+        CrcSpec{16, 0x8005, 0, false, 0});
+    static const auto crc32 = std::make_shared<const Crc::Engine>(
+        CrcSpec{32, 0x04C11DB7, 0xFFFFFFFF, true, 0xFFFFFFFF});
+    static const auto crc32c = std::make_shared<const Crc::Engine>(
+        CrcSpec{32, 0x1EDC6F41, 0xFFFFFFFF, true, 0xFFFFFFFF});
+    switch (kind)
+    {
+        case CrcKind::Crc16Hca: return crc16_hca;
+        case CrcKind::Crc32: return crc32;
+        case CrcKind::Crc32c: return crc32c;
+    }
+    throw std::logic_error("Unknown CRC kind");
+}
+
+Crc::Crc(const CrcKind kind) : engine(get_engine(kind))
+{
+    reset();
+}
+
+Crc::Crc(const CrcSpec &spec) : engine(std::make_shared<const Engine>(spec))
+{
+    reset();
+}
+
+Crc::~Crc()
+{
+}
+
+void Crc::reset()
+{
+    state = engine->start_state;
+}
+
+void Crc::update(const u8 *input, const size_t size)
+{
+    state = engine->kernel(*engine, state, input, size);
+}
+
+void Crc::update(const bstr &input)
+{
+    update(input.get<const u8>(), input.size());
+}
+
+u64 Crc::digest() const
+{
+    const auto &spec = engine->spec;
+    const auto value = spec.reflected
+        ? state
+        : state >> (64 - spec.width);
+    const auto mask = spec.width == 64 ? ~0ull : (1ull << spec.width) - 1;
+    return (value ^ spec.xor_out) & mask;
+}
+
+u64 algo::crypt::crc(const CrcKind kind, const u8 *input, const size_t size)
+{
+    Crc crc(kind);
+    crc.update(input, size);
+    return crc.digest();
+}
+
+u32 algo::crypt::crc32(const u8 *input, const size_t size)
+{
+    return crc(CrcKind::Crc32, input, size);
+}
+
+u32 algo::crypt::crc32(const bstr &input)
+{
+    return crc32(input.get<const u8>(), input.size());
+}
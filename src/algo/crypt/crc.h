@@ -0,0 +1,75 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <memory>
+#include "types.h"
+
+namespace au {
+namespace algo {
+namespace crypt {
+
+    enum class CrcKind : u8
+    {
+        Crc16Hca, // CRC-16/UMTS, as used by HCA block checksums
+        Crc32,    // CRC-32/ISO-HDLC, as used by zip, gzip and PNG
+        Crc32c,   // CRC-32/ISCSI (Castagnoli)
+    };
+
+    // Arbitrary CRC in the usual Rocksoft notation. The polynomial and the
+    // initial value are given MSB-first, whatever the bit order.
+    struct CrcSpec final
+    {
+        size_t width;
+        u64 poly;
+        u64 init;
+        bool reflected;
+        u64 xor_out;
+    };
+
+    // Incremental CRC. The tables for the built-in kinds are set up once
+    // and shared, so instances are cheap to create per block; custom specs
+    // build their own tables, so those are better kept around. CRC-32 and
+    // CRC-32C switch to carry-less multiplication or to the dedicated CRC
+    // instruction respectively when the CPU has them.
+    class Crc final
+    {
+    public:
+        struct Engine;
+
+        Crc(const CrcKind kind);
+        Crc(const CrcSpec &spec);
+        ~Crc();
+
+        void reset();
+        void update(const u8 *input, const size_t size);
+        void update(const bstr &input);
+
+        // Doesn't change the state, so more data can follow.
+        u64 digest() const;
+
+    private:
+        std::shared_ptr<const Engine> engine;
+        u64 state;
+    };
+
+    u64 crc(const CrcKind kind, const u8 *input, const size_t size);
+    u32 crc32(const u8 *input, const size_t size);
+    u32 crc32(const bstr &input);
+
+} } }
@@ -16,49 +16,131 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "algo/crypt/hmac.h"
+#include <new>
 #include <openssl/evp.h>
-#include <openssl/hmac.h>
-#include <stdexcept>
+#include "algo/range.h"
 #include "err.h"
 
 using namespace au;
 using namespace au::algo::crypt;
 
-bstr algo::crypt::hmac(
-    const bstr &input, const bstr &key, const HmacKind hmac_kind)
-{
-    const EVP_MD *md;
-    if (hmac_kind == HmacKind::Sha512)
-        md = EVP_sha512();
-    else
-        throw err::NotSupportedError("Unimplemented hash kind");
+static const size_t block_size = 128;
+static const size_t max_digest_size = EVP_MAX_MD_SIZE;
 
-    unsigned int final_size;
-    bstr output(EVP_MAX_MD_SIZE);
+static EVP_MD_CTX *create_md_ctx()
+{
+    #if OPENSSL_VERSION_NUMBER < 0x10100000L
+        return EVP_MD_CTX_create();
+    #else
+        return EVP_MD_CTX_new();
+    #endif
+}
 
+static void destroy_md_ctx(EVP_MD_CTX *ctx)
+{
+    if (!ctx)
+        return;
     #if OPENSSL_VERSION_NUMBER < 0x10100000L
-        HMAC_CTX ctx;
-        HMAC_CTX_init(&ctx);
-        HMAC_Init_ex(&ctx, key.get<const u8>(), key.size(), md, NULL);
-        HMAC_Update(&ctx, input.get<const u8>(), input.size());
-        HMAC_Final(&ctx, output.get<u8>(), &final_size);
-        HMAC_CTX_cleanup(&ctx);
+        EVP_MD_CTX_destroy(ctx);
     #else
-        HMAC_CTX *ctx = HMAC_CTX_new();
-        if (!ctx)
-            throw std::bad_alloc();
-        try
-        {
-            HMAC_Init_ex(ctx, key.get<const u8>(), key.size(), md, NULL);
-            HMAC_Update(ctx, input.get<const u8>(), input.size());
-            HMAC_Final(ctx, output.get<u8>(), &final_size);
-            HMAC_CTX_free(ctx);
-        }
-        catch (...)
-        {
-            HMAC_CTX_free(ctx);
-        }
+        EVP_MD_CTX_free(ctx);
     #endif
+}
+
+// HMAC is built on top of reusable EVP digest contexts, which spares
+// setting up a new HMAC context for every key.
+struct Hmac::Priv final
+{
+    Priv();
+    ~Priv();
+
+    const EVP_MD *md;
+    EVP_MD_CTX *inner_ctx;
+    EVP_MD_CTX *outer_ctx;
+    u8 outer_key[block_size];
+};
+
+Hmac::Priv::Priv() :
+    md(EVP_sha512()),
+    inner_ctx(create_md_ctx()),
+    outer_ctx(create_md_ctx())
+{
+    if (!inner_ctx || !outer_ctx)
+    {
+        destroy_md_ctx(inner_ctx);
+        destroy_md_ctx(outer_ctx);
+        throw std::bad_alloc();
+    }
+}
+
+Hmac::Priv::~Priv()
+{
+    destroy_md_ctx(inner_ctx);
+    destroy_md_ctx(outer_ctx);
+}
+
+Hmac::Hmac(const HmacKind hmac_kind)
+{
+    if (hmac_kind != HmacKind::Sha512)
+        throw err::NotSupportedError("Unimplemented hash kind");
+    p.reset(new Priv());
+}
+
+Hmac::~Hmac()
+{
+}
 
-    return output.substr(0, final_size);
+size_t Hmac::digest_size() const
+{
+    return EVP_MD_size(p->md);
+}
+
+void Hmac::init(const u8 *key, size_t key_size)
+{
+    u8 key_hash[max_digest_size];
+    if (key_size > block_size)
+    {
+        unsigned int hash_size = 0;
+        EVP_Digest(key, key_size, key_hash, &hash_size, p->md, nullptr);
+        key = key_hash;
+        key_size = hash_size;
+    }
+
+    u8 inner_key[block_size];
+    for (const size_t i : algo::range(block_size))
+    {
+        const u8 c = i < key_size ? key[i] : 0;
+        inner_key[i] = c ^ 0x36;
+        p->outer_key[i] = c ^ 0x5C;
+    }
+    EVP_DigestInit_ex(p->inner_ctx, p->md, nullptr);
+    EVP_DigestUpdate(p->inner_ctx, inner_key, sizeof(inner_key));
+}
+
+void Hmac::update(const u8 *input, const size_t size)
+{
+    EVP_DigestUpdate(p->inner_ctx, input, size);
+}
+
+void Hmac::finalize(u8 *output)
+{
+    u8 inner_hash[max_digest_size];
+    unsigned int inner_hash_size = 0;
+    EVP_DigestFinal_ex(p->inner_ctx, inner_hash, &inner_hash_size);
+
+    EVP_DigestInit_ex(p->outer_ctx, p->md, nullptr);
+    EVP_DigestUpdate(p->outer_ctx, p->outer_key, sizeof(p->outer_key));
+    EVP_DigestUpdate(p->outer_ctx, inner_hash, inner_hash_size);
+    EVP_DigestFinal_ex(p->outer_ctx, output, nullptr);
+}
+
+bstr algo::crypt::hmac(
+    const bstr &input, const bstr &key, const HmacKind hmac_kind)
+{
+    Hmac hmac(hmac_kind);
+    bstr output(hmac.digest_size());
+    hmac.init(key.get<const u8>(), key.size());
+    hmac.update(input.get<const u8>(), input.size());
+    hmac.finalize(output.get<u8>());
+    return output;
 }
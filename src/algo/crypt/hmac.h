@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <memory>
 #include "types.h"
 
 namespace au {
@@ -28,6 +29,27 @@ namespace crypt {
         Sha512
     };
 
+    // Can be reinitialized with a new key for every message, so that
+    // callers computing many MACs don't allocate anything per message.
+    class Hmac final
+    {
+    public:
+        Hmac(const HmacKind hmac_kind);
+        ~Hmac();
+
+        size_t digest_size() const;
+
+        void init(const u8 *key, const size_t key_size);
+        void update(const u8 *input, const size_t size);
+
+        // Writes digest_size() bytes.
+        void finalize(u8 *output);
+
+    private:
+        struct Priv;
+        std::unique_ptr<Priv> p;
+    };
+
     bstr hmac(const bstr &input, const bstr &key, const HmacKind hmac_kind);
 
 } } }
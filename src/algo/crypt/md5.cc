@@ -19,29 +19,90 @@
 #include <openssl/md5.h>
 
 using namespace au;
+using namespace au::algo::crypt;
 
-bstr algo::crypt::md5(const bstr &input)
+const size_t Md5::digest_size;
+
+struct Md5::Priv final
+{
+    MD5_CTX ctx;
+    bool custom_init;
+    std::array<u32, 4> init;
+};
+
+Md5::Md5() : p(new Priv())
+{
+    p->custom_init = false;
+    reset();
+}
+
+Md5::Md5(const std::array<u32, 4> &custom_init) : p(new Priv())
+{
+    p->custom_init = true;
+    p->init = custom_init;
+    reset();
+}
+
+Md5::~Md5()
+{
+}
+
+void Md5::reset()
+{
+    MD5_Init(&p->ctx);
+    if (p->custom_init)
+    {
+        p->ctx.A = p->init[0];
+        p->ctx.B = p->init[1];
+        p->ctx.C = p->init[2];
+        p->ctx.D = p->init[3];
+    }
+}
+
+void Md5::update(const u8 *input, const size_t size)
+{
+    MD5_Update(&p->ctx, input, size);
+}
+
+void Md5::update(const bstr &input)
+{
+    update(input.get<const u8>(), input.size());
+}
+
+void Md5::finalize(u8 *output)
+{
+    MD5_Final(output, &p->ctx);
+    reset();
+}
+
+bstr Md5::finalize()
+{
+    bstr output(digest_size);
+    finalize(output.get<u8>());
+    return output;
+}
+
+bstr algo::crypt::md5(const u8 *input, const size_t size)
 {
+    // the state lives on the stack, unlike in Md5
     MD5_CTX ctx;
     MD5_Init(&ctx);
     u8 output[MD5_DIGEST_LENGTH];
-    MD5_Update(&ctx, input.get<const u8>(), input.size());
+    MD5_Update(&ctx, input, size);
     MD5_Final(output, &ctx);
     return bstr(output, MD5_DIGEST_LENGTH);
 }
 
+bstr algo::crypt::md5(const bstr &input)
+{
+    return md5(input.get<const u8>(), input.size());
+}
+
 bstr algo::crypt::md5(
     const bstr &input,
     const std::array<u32, 4> &custom_init)
 {
-    MD5_CTX ctx;
-    MD5_Init(&ctx);
-    ctx.A = custom_init[0];
-    ctx.B = custom_init[1];
-    ctx.C = custom_init[2];
-    ctx.D = custom_init[3];
-    u8 output[MD5_DIGEST_LENGTH];
-    MD5_Update(&ctx, input.get<const u8>(), input.size());
-    MD5_Final(output, &ctx);
-    return bstr(output, MD5_DIGEST_LENGTH);
+    Md5 md5(custom_init);
+    md5.update(input);
+    return md5.finalize();
 }
@@ -18,12 +18,38 @@
 #pragma once
 
 #include <array>
+#include <memory>
 #include "types.h"
 
 namespace au {
 namespace algo {
 namespace crypt {
 
+    // Incremental MD5 that can be reset and reused, so that callers hashing
+    // many small blocks don't allocate anything per block.
+    class Md5 final
+    {
+    public:
+        static const size_t digest_size = 16;
+
+        Md5();
+        Md5(const std::array<u32, 4> &custom_init);
+        ~Md5();
+
+        void reset();
+        void update(const u8 *input, const size_t size);
+        void update(const bstr &input);
+
+        // Writes digest_size bytes and resets the state.
+        void finalize(u8 *output);
+        bstr finalize();
+
+    private:
+        struct Priv;
+        std::unique_ptr<Priv> p;
+    };
+
+    bstr md5(const u8 *input, const size_t size);
     bstr md5(const bstr &input);
     bstr md5(const bstr &input, const std::array<u32, 4> &custom_init);
 
@@ -19,13 +19,63 @@
 #include <openssl/sha.h>
 
 using namespace au;
+using namespace au::algo::crypt;
 
-bstr algo::crypt::sha1(const bstr &input)
+const size_t Sha1::digest_size;
+
+struct Sha1::Priv final
+{
+    SHA_CTX ctx;
+};
+
+Sha1::Sha1() : p(new Priv())
+{
+    reset();
+}
+
+Sha1::~Sha1()
+{
+}
+
+void Sha1::reset()
+{
+    SHA1_Init(&p->ctx);
+}
+
+void Sha1::update(const u8 *input, const size_t size)
+{
+    SHA1_Update(&p->ctx, input, size);
+}
+
+void Sha1::update(const bstr &input)
+{
+    update(input.get<const u8>(), input.size());
+}
+
+void Sha1::finalize(u8 *output)
+{
+    SHA1_Final(output, &p->ctx);
+    reset();
+}
+
+bstr Sha1::finalize()
+{
+    bstr output(digest_size);
+    finalize(output.get<u8>());
+    return output;
+}
+
+bstr algo::crypt::sha1(const u8 *input, const size_t size)
 {
     SHA_CTX ctx;
     SHA1_Init(&ctx);
     u8 output[SHA_DIGEST_LENGTH];
-    SHA1_Update(&ctx, input.get<const u8>(), input.size());
+    SHA1_Update(&ctx, input, size);
     SHA1_Final(output, &ctx);
     return bstr(output, SHA_DIGEST_LENGTH);
 }
+
+bstr algo::crypt::sha1(const bstr &input)
+{
+    return sha1(input.get<const u8>(), input.size());
+}
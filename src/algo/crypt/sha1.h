@@ -17,12 +17,36 @@
 
 #pragma once
 
+#include <memory>
 #include "types.h"
 
 namespace au {
 namespace algo {
 namespace crypt {
 
+    // Incremental SHA-1, reusable the same way as Md5.
+    class Sha1 final
+    {
+    public:
+        static const size_t digest_size = 20;
+
+        Sha1();
+        ~Sha1();
+
+        void reset();
+        void update(const u8 *input, const size_t size);
+        void update(const bstr &input);
+
+        // Writes digest_size bytes and resets the state.
+        void finalize(u8 *output);
+        bstr finalize();
+
+    private:
+        struct Priv;
+        std::unique_ptr<Priv> p;
+    };
+
+    bstr sha1(const u8 *input, const size_t size);
     bstr sha1(const bstr &input);
 
 } } }
@@ -0,0 +1,380 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "algo/crypt/xor.h"
+#include <algorithm>
+#include <cstring>
+#include "algo/binary.h"
+#include "algo/range.h"
+#include "err.h"
+
+#if defined(__SSE2__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define XOR_USE_SSE2
+    #include <emmintrin.h>
+#endif
+
+#if defined(__GNUC__) && defined(__x86_64__)
+    #define XOR_USE_X86_KERNELS
+    #include <immintrin.h>
+#endif
+
+using namespace au;
+using namespace au::algo::crypt;
+
+namespace
+{
+    using XorKernel = void (*)(u8 *, const u8 *, size_t);
+}
+
+// Short inputs are not worth building a keystream for.
+static const size_t min_stream_input_size = 64;
+
+// Repeating keys are unrolled to at least this many bytes so that the
+// vector loops get to run for a while before having to wrap around.
+static const size_t min_stream_size = 256;
+
+static void xor_block_scalar(u8 *data, const u8 *stream, size_t size)
+{
+    while (size >= 8)
+    {
+        u64 x, y;
+        std::memcpy(&x, data, 8);
+        std::memcpy(&y, stream, 8);
+        x ^= y;
+        std::memcpy(data, &x, 8);
+        data += 8;
+        stream += 8;
+        size -= 8;
+    }
+    while (size--)
+        *data++ ^= *stream++;
+}
+
+#ifdef XOR_USE_SSE2
+    static void xor_block_sse2(u8 *data, const u8 *stream, size_t size)
+    {
+        while (size >= 16)
+        {
+            const auto x = _mm_loadu_si128(reinterpret_cast<__m128i*>(data));
+            const auto y = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(stream));
+            _mm_storeu_si128(
+                reinterpret_cast<__m128i*>(data), _mm_xor_si128(x, y));
+            data += 16;
+            stream += 16;
+            size -= 16;
+        }
+        xor_block_scalar(data, stream, size);
+    }
+#endif
+
+#ifdef XOR_USE_X86_KERNELS
+    __attribute__((target("avx2")))
+    static void xor_block_avx2(u8 *data, const u8 *stream, size_t size)
+    {
+        while (size >= 32)
+        {
+            const auto x = _mm256_loadu_si256(
+                reinterpret_cast<__m256i*>(data));
+            const auto y = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(stream));
+            _mm256_storeu_si256(
+                reinterpret_cast<__m256i*>(data), _mm256_xor_si256(x, y));
+            data += 32;
+            stream += 32;
+            size -= 32;
+        }
+        xor_block_scalar(data, stream, size);
+    }
+#endif
+
+static XorKernel pick_xor_kernel()
+{
+    #ifdef XOR_USE_X86_KERNELS
+        if (__builtin_cpu_supports("avx2"))
+            return xor_block_avx2;
+    #endif
+    #ifdef XOR_USE_SSE2
+        return xor_block_sse2;
+    #else
+        return xor_block_scalar;
+    #endif
+}
+
+static void xor_block(u8 *data, const u8 *stream, const size_t size)
+{
+    static const auto kernel = pick_xor_kernel();
+    kernel(data, stream, size);
+}
+
+// XORs data with a keystream that repeats every stream_size bytes.
+static void xor_periodic(
+    u8 *data, size_t size, const u8 *stream, const size_t stream_size)
+{
+    while (size)
+    {
+        const auto chunk_size = std::min(size, stream_size);
+        xor_block(data, stream, chunk_size);
+        data += chunk_size;
+        size -= chunk_size;
+    }
+}
+
+void algo::crypt::xor_repeating(
+    u8 *data,
+    const size_t size,
+    const u8 *key,
+    const size_t key_size,
+    const size_t key_pos)
+{
+    if (!key_size)
+        throw err::BadDataSizeError();
+    auto pos = key_pos % key_size;
+
+    if (size < min_stream_input_size)
+    {
+        for (const auto i : algo::range(size))
+        {
+            data[i] ^= key[pos++];
+            if (pos == key_size)
+                pos = 0;
+        }
+        return;
+    }
+
+    // long keys make for a good enough keystream themselves
+    if (key_size >= min_stream_size)
+    {
+        const auto done = std::min(size, key_size - pos);
+        xor_block(data, key + pos, done);
+        xor_periodic(data + done, size - done, key, key_size);
+        return;
+    }
+
+    u8 stream[min_stream_size * 2];
+    const auto stream_size
+        = (min_stream_size + key_size - 1) / key_size * key_size;
+    for (const auto i : algo::range(stream_size))
+    {
+        stream[i] = key[pos++];
+        if (pos == key_size)
+            pos = 0;
+    }
+    xor_periodic(data, size, stream, stream_size);
+}
+
+void algo::crypt::xor_repeating(
+    bstr &data, const bstr &key, const size_t key_pos)
+{
+    xor_repeating(
+        data.get<u8>(), data.size(), key.get<const u8>(), key.size(), key_pos);
+}
+
+void algo::crypt::xor_byte(u8 *data, const size_t size, const u8 key)
+{
+    xor_repeating(data, size, &key, 1);
+}
+
+void algo::crypt::xor_byte(bstr &data, const u8 key)
+{
+    xor_byte(data.get<u8>(), data.size(), key);
+}
+
+void algo::crypt::xor_rolling(
+    u8 *data, const size_t size, const u8 key, const u8 step)
+{
+    // the keystream wraps around after 256 bytes
+    u8 stream[0x100];
+    const auto stream_size = std::min<size_t>(size, sizeof(stream));
+    u8 value = key;
+    for (const auto i : algo::range(stream_size))
+    {
+        stream[i] = value;
+        value += step;
+    }
+    if (size < min_stream_input_size)
+    {
+        for (const auto i : algo::range(size))
+            data[i] ^= stream[i];
+        return;
+    }
+    xor_periodic(data, size, stream, stream_size);
+}
+
+template<PackedLanes lanes> static inline u64 add(const u64 a, const u64 b)
+{
+    switch (lanes)
+    {
+        case PackedLanes::U8: return algo::padb(a, b);
+        case PackedLanes::U16: return algo::padw(a, b);
+        case PackedLanes::U32: return algo::padd(a, b);
+        default: return a + b;
+    }
+}
+
+static inline u64 load_block(const u8 *data)
+{
+    u64 block;
+    std::memcpy(&block, data, 8);
+    return block;
+}
+
+static inline void store_block(u8 *data, const u64 block)
+{
+    std::memcpy(data, &block, 8);
+}
+
+#ifdef XOR_USE_SSE2
+    template<PackedLanes lanes> static inline __m128i add(
+        const __m128i a, const __m128i b)
+    {
+        switch (lanes)
+        {
+            case PackedLanes::U8: return _mm_add_epi8(a, b);
+            case PackedLanes::U16: return _mm_add_epi16(a, b);
+            case PackedLanes::U32: return _mm_add_epi32(a, b);
+            default: return _mm_add_epi64(a, b);
+        }
+    }
+
+    // Every block's key depends only on its index, so two blocks are done
+    // at once, with the keys advancing by two steps per iteration.
+    template<PackedLanes lanes> static void xor_packed_add_impl(
+        u8 *data, size_t size, u64 key, const u64 step)
+    {
+        const auto step1 = _mm_set1_epi64x(static_cast<long long>(step));
+        const auto step2 = add<lanes>(step1, step1);
+        const auto key1 = add<lanes>(
+            _mm_set1_epi64x(static_cast<long long>(key)), step1);
+        auto keys = _mm_unpacklo_epi64(key1, add<lanes>(key1, step1));
+        while (size >= 16)
+        {
+            const auto x = _mm_loadu_si128(reinterpret_cast<__m128i*>(data));
+            _mm_storeu_si128(
+                reinterpret_cast<__m128i*>(data), _mm_xor_si128(x, keys));
+            keys = add<lanes>(keys, step2);
+            data += 16;
+            size -= 16;
+        }
+        if (size >= 8)
+        {
+            const auto x = _mm_loadl_epi64(reinterpret_cast<__m128i*>(data));
+            _mm_storel_epi64(
+                reinterpret_cast<__m128i*>(data), _mm_xor_si128(x, keys));
+        }
+    }
+
+    // The feedback chain rules out processing several blocks at once, but
+    // native lane additions still beat emulating them with masks.
+    template<PackedLanes lanes> static void xor_packed_add_chained_impl(
+        u8 *data, size_t size, u64 key, const u64 step, u64 feedback)
+    {
+        const auto step1 = _mm_set_epi64x(0, static_cast<long long>(step));
+        auto keys = _mm_set_epi64x(0, static_cast<long long>(key));
+        auto last = _mm_set_epi64x(0, static_cast<long long>(feedback));
+        while (size >= 8)
+        {
+            keys = _mm_xor_si128(add<lanes>(keys, step1), last);
+            const auto x = _mm_loadl_epi64(reinterpret_cast<__m128i*>(data));
+            last = _mm_xor_si128(x, keys);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(data), last);
+            data += 8;
+            size -= 8;
+        }
+    }
+#else
+    template<PackedLanes lanes> static void xor_packed_add_impl(
+        u8 *data, size_t size, u64 key, const u64 step)
+    {
+        while (size >= 8)
+        {
+            key = add<lanes>(key, step);
+            store_block(data, load_block(data) ^ key);
+            data += 8;
+            size -= 8;
+        }
+    }
+
+    template<PackedLanes lanes> static void xor_packed_add_chained_impl(
+        u8 *data, size_t size, u64 key, const u64 step, u64 feedback)
+    {
+        while (size >= 8)
+        {
+            key = add<lanes>(key, step) ^ feedback;
+            feedback = load_block(data) ^ key;
+            store_block(data, feedback);
+            data += 8;
+            size -= 8;
+        }
+    }
+#endif
+
+void algo::crypt::xor_packed_add(
+    u8 *data,
+    const size_t size,
+    u64 key,
+    const u64 step,
+    const PackedLanes lanes)
+{
+    switch (lanes)
+    {
+        case PackedLanes::U8:
+            return xor_packed_add_impl<PackedLanes::U8>(data, size, key, step);
+        case PackedLanes::U16:
+            return xor_packed_add_impl<PackedLanes::U16>(
+                data, size, key, step);
+        case PackedLanes::U32:
+            return xor_packed_add_impl<PackedLanes::U32>(
+                data, size, key, step);
+        case PackedLanes::U64:
+            return xor_packed_add_impl<PackedLanes::U64>(
+                data, size, key, step);
+    }
+}
+
+void algo::crypt::xor_packed_add_chained(
+    u8 *data,
+    const size_t size,
+    u64 key,
+    const u64 step,
+    u64 feedback,
+    const PackedLanes lanes)
+{
+    switch (lanes)
+    {
+        case PackedLanes::U8:
+            return xor_packed_add_chained_impl<PackedLanes::U8>(
+                data, size, key, step, feedback);
+        case PackedLanes::U16:
+            return xor_packed_add_chained_impl<PackedLanes::U16>(
+                data, size, key, step, feedback);
+        case PackedLanes::U32:
+            return xor_packed_add_chained_impl<PackedLanes::U32>(
+                data, size, key, step, feedback);
+        case PackedLanes::U64:
+            return xor_packed_add_chained_impl<PackedLanes::U64>(
+                data, size, key, step, feedback);
+    }
+}
+
+void algo::crypt::transform_bytes(
+    u8 *data, const size_t size, const u8 *table)
+{
+    for (const auto i : algo::range(size))
+        data[i] = table[data[i]];
+}
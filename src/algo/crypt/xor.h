@@ -0,0 +1,84 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "types.h"
+
+namespace au {
+namespace algo {
+namespace crypt {
+
+    // Lane width of the additions in a packed-add keystream, matching
+    // algo::padb, padw and padd (and a plain 64-bit add).
+    enum class PackedLanes : u8
+    {
+        U8,
+        U16,
+        U32,
+        U64,
+    };
+
+    // XORs data with key repeated over it, starting at given position of
+    // the key. This is the common "data[i] ^= key[(i + pos) % size]" loop.
+    void xor_repeating(
+        u8 *data,
+        const size_t size,
+        const u8 *key,
+        const size_t key_size,
+        const size_t key_pos = 0);
+
+    void xor_repeating(bstr &data, const bstr &key, const size_t key_pos = 0);
+
+    // XORs every byte of data with given key.
+    void xor_byte(u8 *data, const size_t size, const u8 key);
+    void xor_byte(bstr &data, const u8 key);
+
+    // XORs data with the byte keystream key, key + step, key + 2 * step...
+    void xor_rolling(u8 *data, const size_t size, const u8 key, const u8 step);
+
+    // XORs consecutive 64-bit blocks of data with a keystream that gets
+    // step added lane-wise before each block. A trailing partial block is
+    // left as is.
+    void xor_packed_add(
+        u8 *data,
+        const size_t size,
+        u64 key,
+        const u64 step,
+        const PackedLanes lanes);
+
+    // Same as above, except that each decrypted block is also XOR-ed into
+    // the keystream, starting with given feedback value:
+    //
+    //     key = add(key, step) ^ feedback;
+    //     feedback = *block ^= key;
+    //
+    // The chain makes this inherently serial.
+    void xor_packed_add_chained(
+        u8 *data,
+        const size_t size,
+        u64 key,
+        const u64 step,
+        u64 feedback,
+        const PackedLanes lanes);
+
+    // Maps every byte of data through given 256-entry table. Handy for
+    // per-byte transforms such as "rotr((x - a) ^ b, c)" that would
+    // otherwise be computed over and over.
+    void transform_bytes(u8 *data, const size_t size, const u8 *table);
+
+} } }
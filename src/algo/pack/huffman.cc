@@ -16,7 +16,7 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "algo/pack/huffman.h"
-#include "io/msb_bit_stream.h"
+#include "algo/pack/huffman_table.h"
 
 using namespace au;
 using namespace au::algo::pack;
@@ -53,15 +53,27 @@ bstr algo::pack::decode_huffman(
     const bstr &input,
     const size_t target_size)
 {
-    bstr output;
-    output.resize(target_size);
     io::MsbBitStream input_stream(input);
-    while (output.size() < target_size && input_stream.left())
-    {
-        auto byte = huffman_tree.root;
-        while (byte >= 256 && byte <= 511)
-            byte = huffman_tree.nodes[input_stream.read(1)][byte];
-        output += static_cast<const u8>(byte);
-    }
+    return decode_huffman(huffman_tree, input_stream, target_size);
+}
+
+bstr algo::pack::decode_huffman(
+    const HuffmanTree &huffman_tree,
+    io::MsbBitStream &input_stream,
+    const size_t target_size)
+{
+    const auto table = HuffmanTable::from_tree(
+        huffman_tree.root,
+        [](const u32 node) { return node < 256 || node > 511; },
+        [&](const u32 node, const u32 bit)
+        {
+            return huffman_tree.nodes[bit][node];
+        });
+
+    bstr output(target_size);
+    size_t output_size = 0;
+    while (output_size < target_size && input_stream.left())
+        output[output_size++] = table.decode(input_stream);
+    output.resize(output_size);
     return output;
 }
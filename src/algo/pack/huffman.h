@@ -18,6 +18,7 @@
 #pragma once
 
 #include "io/base_bit_stream.h"
+#include "io/msb_bit_stream.h"
 
 namespace au {
 namespace algo {
@@ -38,4 +39,9 @@ namespace pack {
         const bstr &input,
         const size_t target_size);
 
+    bstr decode_huffman(
+        const HuffmanTree &huffman_tree,
+        io::MsbBitStream &input_stream,
+        const size_t target_size);
+
 } } }
@@ -0,0 +1,183 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "algo/pack/huffman_table.h"
+#include <algorithm>
+#include <map>
+#include "algo/range.h"
+#include "err.h"
+
+using namespace au;
+using namespace au::algo::pack;
+
+static const size_t max_code_size = 32;
+
+const u32 HuffmanTable::invalid_node;
+
+static u32 get_mask(const size_t bits)
+{
+    return (1ull << bits) - 1;
+}
+
+static void collect_codes(
+    std::vector<HuffmanTable::Code> &codes,
+    const u32 node,
+    const u32 bits,
+    const size_t size,
+    const std::function<bool(const u32)> &is_leaf,
+    const std::function<u32(const u32, const u32)> &get_child)
+{
+    if (node == HuffmanTable::invalid_node)
+        return;
+    if (is_leaf(node))
+    {
+        codes.push_back({bits, size, node});
+        return;
+    }
+    if (size == max_code_size)
+        throw err::CorruptDataError("Huffman code too long");
+    for (const auto bit : algo::range(2))
+    {
+        collect_codes(
+            codes,
+            get_child(node, bit),
+            (bits << 1) | bit,
+            size + 1,
+            is_leaf,
+            get_child);
+    }
+}
+
+HuffmanTable::HuffmanTable(
+    const std::vector<Code> &codes, const size_t table_bits)
+{
+    size_t max_size = 0;
+    std::vector<const Code*> code_ptrs;
+    for (const auto &code : codes)
+    {
+        if (code.size > max_code_size)
+            throw err::CorruptDataError("Huffman code too long");
+        max_size = std::max(max_size, code.size);
+        code_ptrs.push_back(&code);
+    }
+
+    // short codes need no more than a small primary table
+    this->table_bits = std::min(table_bits, max_size);
+    entries.resize(1 << this->table_bits);
+    fill_table(0, this->table_bits, 0, code_ptrs, table_bits);
+}
+
+void HuffmanTable::fill_table(
+    const size_t offset,
+    const size_t bits,
+    const size_t consumed,
+    const std::vector<const Code*> &codes,
+    const size_t max_bits)
+{
+    std::map<u32, std::vector<const Code*>> longer_codes;
+    for (const auto code : codes)
+    {
+        const auto rest = code->size - consumed;
+        const auto rest_bits = code->bits & get_mask(rest);
+        if (rest > bits)
+        {
+            longer_codes[rest_bits >> (rest - bits)].push_back(code);
+            continue;
+        }
+
+        const auto first = rest_bits << (bits - rest);
+        for (const auto i : algo::range(1 << (bits - rest)))
+        {
+            auto &entry = entries[offset + first + i];
+            if (entry.valid)
+                throw err::CorruptDataError("Ambiguous Huffman code");
+            entry.value = code->symbol;
+            entry.size = rest;
+            entry.next_bits = 0;
+            entry.valid = true;
+        }
+    }
+
+    for (const auto &it : longer_codes)
+    {
+        size_t max_rest = 0;
+        for (const auto code : it.second)
+            max_rest = std::max(max_rest, code->size - consumed - bits);
+        const auto next_bits = std::min(max_bits, max_rest);
+        const auto next_offset = entries.size();
+        entries.resize(next_offset + (1 << next_bits));
+
+        auto &entry = entries[offset + it.first];
+        if (entry.valid)
+            throw err::CorruptDataError("Ambiguous Huffman code");
+        entry.value = next_offset;
+        entry.size = bits;
+        entry.next_bits = next_bits;
+        entry.valid = true;
+        fill_table(
+            next_offset, next_bits, consumed + bits, it.second, max_bits);
+    }
+}
+
+HuffmanTable HuffmanTable::from_tree(
+    const u32 root,
+    const std::function<bool(const u32 node)> &is_leaf,
+    const std::function<u32(const u32 node, const u32 bit)> &get_child,
+    const size_t table_bits)
+{
+    std::vector<Code> codes;
+    collect_codes(codes, root, 0, 0, is_leaf, get_child);
+    return HuffmanTable(codes, table_bits);
+}
+
+HuffmanTable HuffmanTable::from_code_sizes(
+    const std::vector<size_t> &code_sizes, const size_t table_bits)
+{
+    std::vector<size_t> size_counts(max_code_size + 1);
+    for (const auto size : code_sizes)
+    {
+        if (size > max_code_size)
+            throw err::CorruptDataError("Huffman code too long");
+        size_counts[size]++;
+    }
+
+    std::vector<u32> next_bits(max_code_size + 1);
+    u32 bits = 0;
+    size_counts[0] = 0;
+    for (const auto size : algo::range(1, max_code_size + 1))
+    {
+        bits = (bits + size_counts[size - 1]) << 1;
+        next_bits[size] = bits;
+    }
+
+    std::vector<Code> codes;
+    for (const auto symbol : algo::range(code_sizes.size()))
+    {
+        const auto size = code_sizes[symbol];
+        if (size)
+        {
+            codes.push_back(
+                {next_bits[size]++, size, static_cast<u32>(symbol)});
+        }
+    }
+    return HuffmanTable(codes, table_bits);
+}
+
+void HuffmanTable::throw_invalid_code()
+{
+    throw err::CorruptDataError("Invalid Huffman code");
+}
@@ -0,0 +1,102 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <functional>
+#include <vector>
+#include "io/msb_bit_stream.h"
+#include "types.h"
+
+namespace au {
+namespace algo {
+namespace pack {
+
+    // Decodes Huffman codes by looking up several bits at once rather than
+    // walking the tree one bit at a time. Codes that do not fit in the
+    // primary table continue in subtables.
+    class HuffmanTable final
+    {
+    public:
+        struct Code final
+        {
+            u32 bits;
+            size_t size;
+            u32 symbol;
+        };
+
+        // Marks tree branches that no valid input can reach.
+        static const u32 invalid_node = 0xFFFFFFFF;
+
+        HuffmanTable(
+            const std::vector<Code> &codes, const size_t table_bits = 9);
+
+        // Builds a table for an arbitrary binary tree. Leaf nodes decode to
+        // their own index.
+        static HuffmanTable from_tree(
+            const u32 root,
+            const std::function<bool(const u32 node)> &is_leaf,
+            const std::function<u32(const u32 node, const u32 bit)> &get_child,
+            const size_t table_bits = 9);
+
+        // Builds a table for canonical codes, given the code size of every
+        // symbol. Symbols with a code size of 0 do not occur.
+        static HuffmanTable from_code_sizes(
+            const std::vector<size_t> &code_sizes,
+            const size_t table_bits = 9);
+
+        inline u32 decode(io::MsbBitStream &bit_stream) const
+        {
+            size_t offset = 0;
+            size_t bits = table_bits;
+            while (true)
+            {
+                const auto index = offset + bit_stream.peek_bits(bits);
+                const auto &entry = entries[index];
+                if (!entry.valid)
+                    throw_invalid_code();
+                bit_stream.skip_bits(entry.size);
+                if (!entry.next_bits)
+                    return entry.value;
+                offset = entry.value;
+                bits = entry.next_bits;
+            }
+        }
+
+    private:
+        struct Entry final
+        {
+            u32 value;
+            u8 size;
+            u8 next_bits;
+            bool valid;
+        };
+
+        [[noreturn]] static void throw_invalid_code();
+
+        void fill_table(
+            const size_t offset,
+            const size_t bits,
+            const size_t consumed,
+            const std::vector<const Code*> &codes,
+            const size_t max_bits);
+
+        size_t table_bits;
+        std::vector<Entry> entries;
+    };
+
+} } }
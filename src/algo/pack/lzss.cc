@@ -16,13 +16,13 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "algo/pack/lzss.h"
-#include <array>
-#include "algo/ptr.h"
+#include "algo/pack/lzss_decoder.h"
 #include "algo/range.h"
 #include "io/memory_byte_stream.h"
 #include "io/msb_bit_stream.h"
 
 using namespace au;
+using namespace au::algo::pack;
 
 namespace
 {
@@ -173,36 +173,29 @@ bstr algo::pack::lzss_decompress(
     const size_t output_size,
     const BitwiseLzssSettings &settings)
 {
-    std::vector<u8> dict(1 << settings.position_bits, 0);
-    auto dict_ptr
-        = algo::make_cyclic_ptr(dict.data(), dict.size())
-        + settings.initial_dictionary_pos;
+    LzssWindow window(
+        1 << settings.position_bits, settings.initial_dictionary_pos, 0);
 
     bstr output(output_size);
-    auto output_ptr = algo::make_ptr(output);
-    while (output_ptr.left())
+    const auto output_ptr = output.get<u8>();
+    size_t output_pos = 0;
+    while (output_pos < output_size)
     {
         if (input_stream.read(1))
         {
-            const auto b = input_stream.read(8);
-            *output_ptr++ = b;
-            *dict_ptr++ = b;
-        }
-        else
-        {
-            auto look_behind_pos = input_stream.read(settings.position_bits);
-            auto repetitions = input_stream.read(settings.size_bits)
-                + settings.min_match_size;
-            auto source_ptr
-                = algo::make_cyclic_ptr(dict.data(), dict.size())
-                + look_behind_pos;
-            while (repetitions-- && output_ptr.left())
-            {
-                const auto b = *source_ptr++;
-                *output_ptr++ = b;
-                *dict_ptr++ = b;
-            }
+            output_ptr[output_pos++] = input_stream.read(8);
+            continue;
         }
+        const auto look_behind_pos = input_stream.read(settings.position_bits);
+        const auto repetitions = input_stream.read(settings.size_bits)
+            + settings.min_match_size;
+        const auto size = std::min(repetitions, output_size - output_pos);
+        window.copy(
+            output_ptr,
+            output_pos,
+            window.get_distance(output_pos, look_behind_pos),
+            size);
+        output_pos += size;
     }
     return output;
 }
@@ -212,50 +205,8 @@ bstr algo::pack::lzss_decompress(
     const size_t output_size,
     const BytewiseLzssSettings &settings)
 {
-    std::array<u8, 0x1000> dict = {0};
-    auto dict_ptr
-        = algo::make_cyclic_ptr(dict.data(), dict.size())
-        + settings.initial_dictionary_pos;
-
-    bstr output(output_size);
-    auto output_ptr = algo::make_ptr(output);
-    auto input_ptr = algo::make_ptr(input);
-
-    u16 control = 0;
-    while (output_ptr.left())
-    {
-        control >>= 1;
-        if (!(control & 0x100))
-        {
-            if (!input_ptr.left()) break;
-            control = *input_ptr++ | 0xFF00;
-        }
-        if (control & 1)
-        {
-            if (!input_ptr.left()) break;
-            const auto b = *input_ptr++;
-            *output_ptr++ = b;
-            *dict_ptr++ = b;
-        }
-        else
-        {
-            if (input_ptr.left() < 2) break;
-            const auto lo = *input_ptr++;
-            const auto hi = *input_ptr++;
-            const auto look_behind_pos = lo | ((hi & 0xF0) << 4);
-            auto repetitions = (hi & 0xF) + 3;
-            auto source_ptr
-                = algo::make_cyclic_ptr(dict.data(), dict.size())
-                + look_behind_pos;
-            while (repetitions-- && output_ptr.left())
-            {
-                const auto b = *source_ptr++;
-                *output_ptr++ = b;
-                *dict_ptr++ = b;
-            }
-        }
-    }
-    return output;
+    return LzssDecoder<BaseLzssFormat>(settings.initial_dictionary_pos)
+        .decode(input, output_size);
 }
 
 LzssEncoderState::LzssEncoderState(
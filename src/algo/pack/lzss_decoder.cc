@@ -0,0 +1,63 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "algo/pack/lzss_decoder.h"
+#include "algo/range.h"
+
+using namespace au;
+using namespace au::algo::pack;
+
+LzssWindow::LzssWindow(
+    const size_t size, const size_t initial_pos, const u8 fill) :
+    ring(size, fill),
+    mask(size - 1),
+    start_pos(initial_pos & mask)
+{
+}
+
+u8 *LzssWindow::dictionary()
+{
+    return ring.data();
+}
+
+void LzssWindow::copy_from_ring(
+    u8 *output,
+    const size_t output_pos,
+    const size_t distance,
+    const size_t size) const
+{
+    // positions before the output start map onto the ring, which has not
+    // been overwritten since the last commit()
+    for (const auto i : algo::range(size))
+    {
+        const auto source_pos = output_pos + i - distance;
+        output[output_pos + i] = output_pos + i >= distance
+            ? output[source_pos]
+            : ring[(start_pos + source_pos) & mask];
+    }
+}
+
+void LzssWindow::commit(const u8 *output, const size_t output_size)
+{
+    const auto size = std::min(output_size, ring.size());
+    const auto source = output + output_size - size;
+    const auto target_pos = (start_pos + output_size - size) & mask;
+    const auto first_part = std::min(size, ring.size() - target_pos);
+    std::memcpy(ring.data() + target_pos, source, first_part);
+    std::memcpy(ring.data(), source + first_part, size - first_part);
+    start_pos = (start_pos + output_size) & mask;
+}
@@ -0,0 +1,218 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "algo/range.h"
+#include "types.h"
+
+namespace au {
+namespace algo {
+namespace pack {
+
+    // LZSS dictionary for decoders that write straight into their output.
+    // Output produced since the last commit() is treated as the newest part
+    // of the dictionary, so copies that stay within it need neither a ring
+    // buffer nor wraparound checks; only references reaching further back
+    // fall back to the ring.
+    class LzssWindow final
+    {
+    public:
+        LzssWindow(const size_t size, const size_t initial_pos, const u8 fill);
+
+        u8 *dictionary();
+
+        // Converts an absolute dictionary position to how far behind given
+        // output position it lies.
+        inline size_t get_distance(
+            const size_t output_pos, const size_t dictionary_pos) const
+        {
+            return ((start_pos + output_pos - dictionary_pos - 1) & mask) + 1;
+        }
+
+        // Appends size bytes that start distance bytes behind output_pos.
+        inline void copy(
+            u8 *output,
+            const size_t output_pos,
+            const size_t distance,
+            const size_t size) const
+        {
+            if (distance > output_pos)
+            {
+                copy_from_ring(output, output_pos, distance, size);
+                return;
+            }
+            const auto target = output + output_pos;
+            const auto source = target - distance;
+            if (distance >= size)
+            {
+                std::memcpy(target, source, size);
+                return;
+            }
+            // overlapping copies repeat the last distance bytes
+            for (const auto i : algo::range(size))
+                target[i] = source[i];
+        }
+
+        // Moves the output into the dictionary, so that the next call can
+        // refer to it.
+        void commit(const u8 *output, const size_t output_size);
+
+    private:
+        void copy_from_ring(
+            u8 *output,
+            const size_t output_pos,
+            const size_t distance,
+            const size_t size) const;
+
+        std::vector<u8> ring;
+        size_t mask;
+        size_t start_pos;
+    };
+
+    // Byte oriented LZSS variants, described at compile time so that each
+    // gets its own specialized loop. Formats derive from this and override
+    // whatever differs from the classic Okumura layout.
+    struct BaseLzssFormat
+    {
+        static const size_t dictionary_size = 0x1000;
+        static const size_t initial_dictionary_pos = 0xFEE;
+        static const u8 dictionary_fill = 0;
+
+        // Every control byte holds eight flags.
+        static const bool msb_first_flags = false;
+        static const bool literal_flag = true;
+
+        // Applied to every control byte and literal.
+        static const u8 input_xor = 0;
+
+        // Whether read_match() yields distances rather than absolute
+        // dictionary positions.
+        static const bool relative_offsets = false;
+
+        // Reads a repetition, returning false if the input runs out.
+        static inline bool read_match(
+            const u8 *&input_ptr,
+            const u8 *input_end,
+            size_t &offset,
+            size_t &size)
+        {
+            if (input_end - input_ptr < 2)
+                return false;
+            const auto lo = input_ptr[0];
+            const auto hi = input_ptr[1];
+            input_ptr += 2;
+            offset = lo | ((hi & 0xF0) << 4);
+            size = (hi & 0x0F) + 3;
+            return true;
+        }
+    };
+
+    template<typename Format> class LzssDecoder final
+    {
+        static_assert(
+            !(Format::dictionary_size & (Format::dictionary_size - 1)),
+            "Dictionary size must be a power of two");
+
+    public:
+        LzssDecoder(
+            const size_t initial_dictionary_pos
+                = Format::initial_dictionary_pos) :
+            window(
+                Format::dictionary_size,
+                initial_dictionary_pos,
+                Format::dictionary_fill)
+        {
+        }
+
+        // For formats that come with a preset dictionary.
+        u8 *dictionary()
+        {
+            return window.dictionary();
+        }
+
+        // Decodes until either the output is full or the input runs out.
+        // Returns how many input bytes were used; output_size is updated to
+        // how many bytes were produced. The dictionary carries over to the
+        // next call.
+        size_t decode(
+            const u8 *input,
+            const size_t input_size,
+            u8 *output,
+            size_t &output_size)
+        {
+            const auto input_end = input + input_size;
+            auto input_ptr = input;
+            size_t output_pos = 0;
+            u8 flags = 0;
+            size_t flags_left = 0;
+            while (output_pos < output_size)
+            {
+                if (!flags_left)
+                {
+                    if (input_ptr == input_end)
+                        break;
+                    flags = *input_ptr++ ^ Format::input_xor;
+                    flags_left = 8;
+                }
+                const bool flag = Format::msb_first_flags
+                    ? (flags & 0x80) != 0
+                    : (flags & 1) != 0;
+                flags = Format::msb_first_flags ? flags << 1 : flags >> 1;
+                flags_left--;
+
+                if (flag == Format::literal_flag)
+                {
+                    if (input_ptr == input_end)
+                        break;
+                    output[output_pos++] = *input_ptr++ ^ Format::input_xor;
+                    continue;
+                }
+
+                size_t offset, size;
+                if (!Format::read_match(input_ptr, input_end, offset, size))
+                    break;
+                const auto distance = Format::relative_offsets
+                    ? offset
+                    : window.get_distance(output_pos, offset);
+                size = std::min(size, output_size - output_pos);
+                window.copy(output, output_pos, distance, size);
+                output_pos += size;
+            }
+            window.commit(output, output_pos);
+            output_size = output_pos;
+            return input_ptr - input;
+        }
+
+        // Output that the input runs short of is left zeroed.
+        bstr decode(const bstr &input, const size_t output_size)
+        {
+            bstr output(output_size);
+            auto size = output_size;
+            decode(
+                input.get<const u8>(), input.size(), output.get<u8>(), size);
+            return output;
+        }
+
+    private:
+        LzssWindow window;
+    };
+
+} } }
@@ -20,6 +20,7 @@
 #include <memory>
 #include <zlib.h>
 #include "algo/format.h"
+#include "algo/scratch.h"
 #include "err.h"
 #include "io/memory_byte_stream.h"
 
@@ -49,7 +50,8 @@ static bstr process_stream(
     if (init_func(s, window_bits) != Z_OK)
         throw std::logic_error("Failed to initialize zlib stream");
 
-    bstr output, input_chunk, output_chunk(buffer_size);
+    bstr output, input_chunk;
+    algo::ScratchBuffer output_chunk(buffer_size, false);
     size_t written = 0;
     int ret;
     const auto initial_pos = input_stream.pos();
@@ -63,12 +65,19 @@ static bstr process_stream(
             s.avail_in = input_chunk.size();
         }
 
-        s.next_out = output_chunk.get<Bytef>();
-        s.avail_out = output_chunk.size();
+        s.next_out = output_chunk->get<Bytef>();
+        s.avail_out = output_chunk->size();
 
         ret = process_func(s);
-        output += output_chunk.substr(0, s.total_out - written);
-        written = s.total_out;
+        if (s.total_out != written)
+        {
+            output.resize(s.total_out);
+            std::memcpy(
+                output.get<u8>() + written,
+                output_chunk->get<const u8>(),
+                s.total_out - written);
+            written = s.total_out;
+        }
         if (ret == Z_BUF_ERROR)
         {
             input_chunk += input_stream.read(
@@ -0,0 +1,150 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "algo/parallel.h"
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+
+using namespace au;
+using namespace au::algo;
+
+namespace
+{
+    struct Group final
+    {
+        Group(const size_t count, const std::function<void(size_t)> &func);
+
+        const size_t count;
+        const std::function<void(size_t)> &func;
+        size_t next_index;
+        size_t finished_count;
+        std::exception_ptr exception;
+    };
+}
+
+// Both the group queue and group progress are guarded by a single mutex;
+// items are meant to be coarse enough for it not to matter.
+static std::mutex mutex;
+static std::condition_variable state_changed;
+static std::deque<std::shared_ptr<Group>> groups;
+
+Group::Group(const size_t count, const std::function<void(size_t)> &func) :
+    count(count),
+    func(func),
+    next_index(0),
+    finished_count(0)
+{
+}
+
+static void unpublish(const std::shared_ptr<Group> &group)
+{
+    for (auto it = groups.begin(); it != groups.end(); ++it)
+    {
+        if (*it == group)
+        {
+            groups.erase(it);
+            return;
+        }
+    }
+}
+
+// Runs a single item of given group. Expects the lock to be held.
+static void run_item(
+    std::unique_lock<std::mutex> &lock, const std::shared_ptr<Group> &group)
+{
+    const auto index = group->next_index++;
+    if (group->next_index == group->count)
+        unpublish(group);
+    lock.unlock();
+
+    std::exception_ptr exception;
+    try
+    {
+        group->func(index);
+    }
+    catch (...)
+    {
+        exception = std::current_exception();
+    }
+
+    lock.lock();
+    if (exception && !group->exception)
+    {
+        group->exception = exception;
+        group->finished_count += group->count - group->next_index;
+        if (group->next_index != group->count)
+            unpublish(group);
+        group->next_index = group->count;
+    }
+    group->finished_count++;
+    if (group->finished_count == group->count)
+        state_changed.notify_all();
+}
+
+static bool run_pending_item(std::unique_lock<std::mutex> &lock)
+{
+    if (groups.empty())
+        return false;
+    // the oldest group comes first so that callers finish in order
+    const auto group = groups.front();
+    run_item(lock, group);
+    return true;
+}
+
+void algo::parallel_for(
+    const size_t count, const std::function<void(size_t)> &func)
+{
+    if (!count)
+        return;
+    if (count == 1)
+    {
+        func(0);
+        return;
+    }
+
+    const auto group = std::make_shared<Group>(count, func);
+    std::unique_lock<std::mutex> lock(mutex);
+    groups.push_back(group);
+    state_changed.notify_all();
+
+    while (group->next_index < group->count)
+        run_item(lock, group);
+
+    // the remaining items are running on other threads; rather than
+    // blocking, help with whatever else is pending in the meantime
+    while (group->finished_count < group->count)
+    {
+        if (!run_pending_item(lock))
+            state_changed.wait(lock);
+    }
+
+    if (group->exception)
+        std::rethrow_exception(group->exception);
+}
+
+void algo::help_parallel_for(const std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    if (groups.empty())
+        state_changed.wait_for(lock, timeout);
+    while (run_pending_item(lock))
+    {
+    }
+}
@@ -0,0 +1,40 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+
+namespace au {
+namespace algo {
+
+    // Calls func for every index in [0, count). The calling thread works
+    // through the indices itself while idle worker threads that called
+    // help_parallel_for() pick up the rest, so the work never needs more
+    // threads than the unpacker was given and simply runs serially when
+    // every worker is busy. Nested calls are fine. The first exception
+    // thrown by func cancels the indices not started yet and is rethrown
+    // once the ones already running finish.
+    void parallel_for(
+        const size_t count, const std::function<void(size_t)> &func);
+
+    // Runs pending parallel_for() work, waiting up to given time for some
+    // to show up. Meant to be called by otherwise idle worker threads.
+    void help_parallel_for(const std::chrono::milliseconds timeout);
+
+} }
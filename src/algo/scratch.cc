@@ -0,0 +1,127 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "algo/scratch.h"
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+using namespace au;
+using namespace au::algo;
+
+static const size_t max_pooled_bytes = 64 * 1024 * 1024;
+
+static thread_local std::vector<std::unique_ptr<bstr>> pool;
+static std::atomic<u64> borrow_count(0);
+static std::atomic<u64> allocation_count(0);
+static std::atomic<u64> allocated_bytes(0);
+
+ScratchBuffer::ScratchBuffer(const size_t size, const bool zeroed)
+{
+    // take the smallest buffer that fits, or else the biggest one so that
+    // it has to grow the least
+    auto best = pool.end();
+    for (auto it = pool.begin(); it != pool.end(); ++it)
+    {
+        if (best == pool.end())
+        {
+            best = it;
+            continue;
+        }
+        const auto capacity = (*it)->capacity();
+        const auto best_capacity = (*best)->capacity();
+        if (best_capacity >= size
+            ? capacity >= size && capacity < best_capacity
+            : capacity > best_capacity)
+        {
+            best = it;
+        }
+    }
+
+    if (best != pool.end())
+    {
+        buffer = std::move(*best);
+        pool.erase(best);
+    }
+    else
+        buffer = std::make_unique<bstr>();
+
+    borrow_count++;
+    const auto old_capacity = buffer->capacity();
+    if (zeroed)
+        buffer->resize(0);
+    buffer->resize(size);
+    if (buffer->capacity() != old_capacity)
+    {
+        allocation_count++;
+        allocated_bytes += buffer->capacity();
+    }
+}
+
+ScratchBuffer::~ScratchBuffer()
+{
+    pool.push_back(std::move(buffer));
+}
+
+bstr &ScratchBuffer::operator *()
+{
+    return *buffer;
+}
+
+const bstr &ScratchBuffer::operator *() const
+{
+    return *buffer;
+}
+
+bstr *ScratchBuffer::operator ->()
+{
+    return buffer.get();
+}
+
+const bstr *ScratchBuffer::operator ->() const
+{
+    return buffer.get();
+}
+
+void algo::trim_scratch()
+{
+    std::sort(
+        pool.begin(),
+        pool.end(),
+        [](const std::unique_ptr<bstr> &a, const std::unique_ptr<bstr> &b)
+        {
+            return a->capacity() < b->capacity();
+        });
+    size_t total_bytes = 0;
+    auto it = pool.begin();
+    while (it != pool.end()
+        && total_bytes + (*it)->capacity() <= max_pooled_bytes)
+    {
+        total_bytes += (*it)->capacity();
+        ++it;
+    }
+    pool.erase(it, pool.end());
+}
+
+ScratchStats algo::get_scratch_stats()
+{
+    ScratchStats stats;
+    stats.borrow_count = borrow_count;
+    stats.allocation_count = allocation_count;
+    stats.allocated_bytes = allocated_bytes;
+    return stats;
+}
@@ -0,0 +1,65 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <memory>
+#include "types.h"
+
+namespace au {
+namespace algo {
+
+    // A temporary buffer borrowed from the calling thread's scratch pool for
+    // the lifetime of the object. Giving it back keeps the allocation, so
+    // decoders that need big temporaries on every call stop going through
+    // malloc and faulting in fresh pages for every file.
+    class ScratchBuffer final
+    {
+    public:
+        // Unless zeroed is false, the contents start zeroed like bstr(size).
+        ScratchBuffer(const size_t size, const bool zeroed = true);
+        ScratchBuffer(const ScratchBuffer &other) = delete;
+        ~ScratchBuffer();
+
+        ScratchBuffer &operator =(const ScratchBuffer &other) = delete;
+
+        // Resizing is fine; the buffer goes back to the pool either way.
+        bstr &operator *();
+        const bstr &operator *() const;
+        bstr *operator ->();
+        const bstr *operator ->() const;
+
+    private:
+        std::unique_ptr<bstr> buffer;
+    };
+
+    struct ScratchStats final
+    {
+        u64 borrow_count;
+        u64 allocation_count;
+        u64 allocated_bytes;
+    };
+
+    // Drops the calling thread's pooled buffers beyond a fixed budget. Meant
+    // to be called between tasks, so that a single huge input doesn't pin
+    // its temporaries for the rest of the run.
+    void trim_scratch();
+
+    // Totals across all threads since the start of the program.
+    ScratchStats get_scratch_stats();
+
+} }
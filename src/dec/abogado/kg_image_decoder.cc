@@ -219,7 +219,7 @@ res::Image KgImageDecoder::decode_impl(
     }
 
     image->flip_vertically();
-    return *image;
+    return std::move(*image);
 }
 
 static auto _
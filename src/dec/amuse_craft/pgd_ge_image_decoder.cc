@@ -212,7 +212,8 @@ res::Image PgdGeImageDecoder::decode_impl(
         data = apply_delta_filter(delta_spec, data, width, height, channels);
 
         if (channels == 4)
-            return res::Image(width, height, data, res::PixelFormat::BGRA8888);
+            return res::Image(
+                width, height, std::move(data), res::PixelFormat::BGRA8888);
         if (channels == 3)
             return res::Image(width, height, data, res::PixelFormat::BGR888);
         throw err::UnsupportedBitDepthError(depth);
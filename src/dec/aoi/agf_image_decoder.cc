@@ -81,7 +81,8 @@ res::Image AgfImageDecoder::decode_impl(
             output_ptr.append_self(source_pos, repetitions);
         }
     }
-    return res::Image(width, height, output, res::PixelFormat::BGRA8888);
+    return res::Image(
+        width, height, std::move(output), res::PixelFormat::BGRA8888);
 }
 
 static auto _ = dec::register_decoder<AgfImageDecoder>("aoi/agf");
@@ -26,7 +26,7 @@ using namespace au;
 using namespace au::dec::bgi::cbg;
 
 static bstr decompress_huffman(
-    io::BaseBitStream &bit_stream, const Tree &tree, size_t output_size)
+    io::MsbBitStream &bit_stream, const Tree &tree, size_t output_size)
 {
     bstr output(output_size);
     for (const auto i : algo::range(output.size()))
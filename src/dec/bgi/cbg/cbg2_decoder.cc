@@ -17,12 +17,21 @@
 
 #include "dec/bgi/cbg/cbg2_decoder.h"
 #include <array>
+#include <cstring>
+#include "algo/parallel.h"
 #include "algo/range.h"
+#include "algo/scratch.h"
 #include "dec/bgi/cbg/cbg_common.h"
 #include "err.h"
 #include "io/memory_byte_stream.h"
 #include "io/msb_bit_stream.h"
 
+#if defined(__SSE2__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define CBG2_USE_SSE2
+    #include <emmintrin.h>
+#endif
+
 using namespace au;
 using namespace au::dec::bgi::cbg;
 
@@ -48,6 +57,12 @@ namespace
     using FloatTable = std::array<float, block_dim2>;
     using FloatTablePair = std::array<FloatTable, 2>;
     using FloatTableTriplet = std::array<FloatTable, 3>;
+
+    struct Band final
+    {
+        size_t size_orig;
+        bstr data;
+    };
 }
 
 static FloatTablePair read_ac_mul_pair(const bstr &input)
@@ -80,140 +95,272 @@ static FloatTablePair read_ac_mul_pair(const bstr &input)
     return ac_mul_pair;
 }
 
-static s16 jpeg_ftoi(float result)
-{
-    int a = 0x80 + ((static_cast<int>(result)) >> 3);
-    if (a < 0)
-        return 0;
-    if (a < 0xFF)
-        return static_cast<s16>(a);
-    if (a < 0x180)
-        return 0xFF;
-    return 0;
-}
-
-static void jpeg_dct_float(
-    FloatTable &output, const u16 *ac, const FloatTable &ac_mul)
-{
-    s16 inptr[block_dim2];
-    float dv[block_dim2];
-    float tp[block_dim2];
-    float tmp0, tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7;
-    float tmp10, tmp11, tmp12, tmp13;
-    float z5, z10, z11, z12, z13;
-
-    for (const auto i : algo::range(block_dim2))
+#ifdef CBG2_USE_SSE2
+    static __m128 jpeg_ftoi(const __m128 result)
     {
-        inptr[i] = ac[i];
-        dv[i] = ac_mul[i];
+        const auto a = _mm_add_epi32(
+            _mm_srai_epi32(_mm_cvttps_epi32(result), 3),
+            _mm_set1_epi32(0x80));
+        const auto below_ff = _mm_cmplt_epi32(a, _mm_set1_epi32(0xFF));
+        const auto below_180 = _mm_cmplt_epi32(a, _mm_set1_epi32(0x180));
+        const auto negative = _mm_cmplt_epi32(a, _mm_setzero_si128());
+        const auto value = _mm_or_si128(
+            _mm_and_si128(below_ff, a),
+            _mm_andnot_si128(
+                below_ff, _mm_and_si128(below_180, _mm_set1_epi32(0xFF))));
+        return _mm_cvtepi32_ps(_mm_andnot_si128(negative, value));
     }
 
-    for (const auto i : algo::range(block_dim))
+    // Processes four columns at once, performing exactly the same float
+    // operations as the scalar version so that the output doesn't change.
+    static void jpeg_dct_float(
+        FloatTable &output, const u16 *ac, const FloatTable &ac_mul)
     {
-        if (!inptr[8 + i] && !inptr[16 + i]
-            && !inptr[24 + i] && !inptr[32 + i]
-            && !inptr[40 + i] && !inptr[48 + i]
-            && !inptr[56 + i])
+        const auto sqrt2 = _mm_set1_ps(1.414213562f);
+        const auto c1 = _mm_set1_ps(1.847759065f);
+        const auto c2 = _mm_set1_ps(1.082392200f);
+        const auto c3 = _mm_set1_ps(2.613125930f);
+        const auto minus_c3 = _mm_set1_ps(-2.613125930f);
+
+        float tp[block_dim2];
+        for (const auto half : algo::range(0, block_dim, 4))
         {
-            tmp0 = inptr[i] * dv[i];
-            tp[i] = tmp0;
-            tp[8 + i] = tmp0;
-            tp[16 + i] = tmp0;
-            tp[24 + i] = tmp0;
-            tp[32 + i] = tmp0;
-            tp[40 + i] = tmp0;
-            tp[48 + i] = tmp0;
-            tp[56 + i] = tmp0;
-            continue;
+            __m128 in[block_dim];
+            for (const auto k : algo::range(block_dim))
+            {
+                const auto row_ptr = &ac[k * block_dim + half];
+                const auto words = _mm_loadl_epi64(
+                    reinterpret_cast<const __m128i*>(row_ptr));
+                const auto ints
+                    = _mm_srai_epi32(_mm_unpacklo_epi16(words, words), 16);
+                in[k] = _mm_mul_ps(
+                    _mm_cvtepi32_ps(ints),
+                    _mm_loadu_ps(&ac_mul[k * block_dim + half]));
+            }
+
+            auto tmp10 = _mm_add_ps(in[0], in[4]);
+            auto tmp11 = _mm_sub_ps(in[0], in[4]);
+            auto tmp13 = _mm_add_ps(in[2], in[6]);
+            auto tmp12 = _mm_sub_ps(
+                _mm_mul_ps(_mm_sub_ps(in[2], in[6]), sqrt2), tmp13);
+            const auto tmp0 = _mm_add_ps(tmp10, tmp13);
+            const auto tmp3 = _mm_sub_ps(tmp10, tmp13);
+            const auto tmp1 = _mm_add_ps(tmp11, tmp12);
+            const auto tmp2 = _mm_sub_ps(tmp11, tmp12);
+
+            const auto z13 = _mm_add_ps(in[5], in[3]);
+            const auto z10 = _mm_sub_ps(in[5], in[3]);
+            const auto z11 = _mm_add_ps(in[1], in[7]);
+            const auto z12 = _mm_sub_ps(in[1], in[7]);
+
+            const auto tmp7 = _mm_add_ps(z11, z13);
+            tmp11 = _mm_mul_ps(_mm_sub_ps(z11, z13), sqrt2);
+            const auto z5 = _mm_mul_ps(_mm_add_ps(z10, z12), c1);
+            tmp10 = _mm_sub_ps(_mm_mul_ps(z12, c2), z5);
+            tmp12 = _mm_add_ps(_mm_mul_ps(z10, minus_c3), z5);
+
+            const auto tmp6 = _mm_sub_ps(tmp12, tmp7);
+            const auto tmp5 = _mm_sub_ps(tmp11, tmp6);
+            const auto tmp4 = _mm_add_ps(tmp10, tmp5);
+
+            _mm_storeu_ps(&tp[0 * block_dim + half], _mm_add_ps(tmp0, tmp7));
+            _mm_storeu_ps(&tp[7 * block_dim + half], _mm_sub_ps(tmp0, tmp7));
+            _mm_storeu_ps(&tp[1 * block_dim + half], _mm_add_ps(tmp1, tmp6));
+            _mm_storeu_ps(&tp[6 * block_dim + half], _mm_sub_ps(tmp1, tmp6));
+            _mm_storeu_ps(&tp[2 * block_dim + half], _mm_add_ps(tmp2, tmp5));
+            _mm_storeu_ps(&tp[5 * block_dim + half], _mm_sub_ps(tmp2, tmp5));
+            _mm_storeu_ps(&tp[4 * block_dim + half], _mm_add_ps(tmp3, tmp4));
+            _mm_storeu_ps(&tp[3 * block_dim + half], _mm_sub_ps(tmp3, tmp4));
         }
 
-        tmp0 = inptr[i] * dv[i];
-        tmp1 = inptr[16 + i] * dv[16 + i];
-        tmp2 = inptr[32 + i] * dv[32 + i];
-        tmp3 = inptr[48 + i] * dv[48 + i];
-        tmp10 = tmp0 + tmp2;
-        tmp11 = tmp0 - tmp2;
-        tmp13 = tmp1 + tmp3;
-        tmp12 = (tmp1 - tmp3) * 1.414213562f - tmp13;
-        tmp0 = tmp10 + tmp13;
-        tmp3 = tmp10 - tmp13;
-        tmp1 = tmp11 + tmp12;
-        tmp2 = tmp11 - tmp12;
-        tmp4 = inptr[8 + i] * dv[8 + i];
-        tmp5 = inptr[24 + i] * dv[24 + i];
-        tmp6 = inptr[40 + i] * dv[40 + i];
-        tmp7 = inptr[56 + i] * dv[56 + i];
-        z13 = tmp6 + tmp5;
-        z10 = tmp6 - tmp5;
-        z11 = tmp4 + tmp7;
-        z12 = tmp4 - tmp7;
-
-        tmp7 = z11 + z13;
-        tmp11 = (z11 - z13) * 1.414213562f;
-        z5 = (z10 + z12) * 1.847759065f;
-        tmp10 = z12 * 1.082392200f - z5;
-        tmp12 = z10 * (-2.613125930f) + z5;
-
-        tmp6 = tmp12 - tmp7;
-        tmp5 = tmp11 - tmp6;
-        tmp4 = tmp10 + tmp5;
-
-        tp[i] = tmp0 + tmp7;
-        tp[56 + i] = tmp0 - tmp7;
-        tp[8 + i] = tmp1 + tmp6;
-        tp[48 + i] = tmp1 - tmp6;
-        tp[16 + i] = tmp2 + tmp5;
-        tp[40 + i] = tmp2 - tmp5;
-        tp[32 + i] = tmp3 + tmp4;
-        tp[24 + i] = tmp3 - tmp4;
-    }
+        // rows are transposed so that four of them are processed at once
+        for (const auto half : algo::range(0, block_dim, 4))
+        {
+            __m128 t[block_dim];
+            for (const auto k : algo::range(0, block_dim, 4))
+            {
+                for (const auto j : algo::range(4))
+                    t[k + j] = _mm_loadu_ps(&tp[(half + j) * block_dim + k]);
+                _MM_TRANSPOSE4_PS(t[k], t[k + 1], t[k + 2], t[k + 3]);
+            }
 
-    for (const auto i : algo::range(block_dim))
+            auto tmp10 = _mm_add_ps(t[0], t[4]);
+            auto tmp11 = _mm_sub_ps(t[0], t[4]);
+            const auto tmp13 = _mm_add_ps(t[2], t[6]);
+            auto tmp12 = _mm_sub_ps(
+                _mm_mul_ps(_mm_sub_ps(t[2], t[6]), sqrt2), tmp13);
+            const auto tmp0 = _mm_add_ps(tmp10, tmp13);
+            const auto tmp3 = _mm_sub_ps(tmp10, tmp13);
+            const auto tmp1 = _mm_add_ps(tmp11, tmp12);
+            const auto tmp2 = _mm_sub_ps(tmp11, tmp12);
+
+            const auto z13 = _mm_add_ps(t[5], t[3]);
+            const auto z10 = _mm_sub_ps(t[5], t[3]);
+            const auto z11 = _mm_add_ps(t[1], t[7]);
+            const auto z12 = _mm_sub_ps(t[1], t[7]);
+
+            const auto tmp7 = _mm_add_ps(z11, z13);
+            tmp11 = _mm_mul_ps(_mm_sub_ps(z11, z13), sqrt2);
+            const auto z5 = _mm_mul_ps(_mm_add_ps(z10, z12), c1);
+            tmp10 = _mm_sub_ps(z5, _mm_mul_ps(z12, c2));
+            tmp12 = _mm_sub_ps(z5, _mm_mul_ps(z10, c3));
+
+            const auto tmp6 = _mm_sub_ps(tmp12, tmp7);
+            const auto tmp5 = _mm_sub_ps(tmp11, tmp6);
+            const auto tmp4 = _mm_sub_ps(tmp10, tmp5);
+
+            __m128 out[block_dim];
+            out[0] = jpeg_ftoi(_mm_add_ps(tmp0, tmp7));
+            out[7] = jpeg_ftoi(_mm_sub_ps(tmp0, tmp7));
+            out[1] = jpeg_ftoi(_mm_add_ps(tmp1, tmp6));
+            out[6] = jpeg_ftoi(_mm_sub_ps(tmp1, tmp6));
+            out[2] = jpeg_ftoi(_mm_add_ps(tmp2, tmp5));
+            out[5] = jpeg_ftoi(_mm_sub_ps(tmp2, tmp5));
+            out[3] = jpeg_ftoi(_mm_add_ps(tmp3, tmp4));
+            out[4] = jpeg_ftoi(_mm_sub_ps(tmp3, tmp4));
+
+            for (const auto k : algo::range(0, block_dim, 4))
+            {
+                _MM_TRANSPOSE4_PS(out[k], out[k + 1], out[k + 2], out[k + 3]);
+                for (const auto j : algo::range(4))
+                {
+                    _mm_storeu_ps(
+                        &output[(half + j) * block_dim + k], out[k + j]);
+                }
+            }
+        }
+    }
+#else
+    static s16 jpeg_ftoi(float result)
     {
-        z5 = tp[i * block_dim];
-        tmp10 = z5 + tp[block_dim * i + 4];
-        tmp11 = z5 - tp[block_dim * i + 4];
-
-        tmp13 = tp[block_dim * i + 2] + tp[block_dim * i + 6];
-        tmp12 = (tp[block_dim * i + 2] - tp[block_dim * i + 6])
-            * 1.414213562f - tmp13;
-
-        tmp0 = tmp10 + tmp13;
-        tmp3 = tmp10 - tmp13;
-        tmp1 = tmp11 + tmp12;
-        tmp2 = tmp11 - tmp12;
-
-        z13 = tp[block_dim * i + 5] + tp[block_dim * i + 3];
-        z10 = tp[block_dim * i + 5] - tp[block_dim * i + 3];
-        z11 = tp[block_dim * i + 1] + tp[block_dim * i + 7];
-        z12 = tp[block_dim * i + 1] - tp[block_dim * i + 7];
-
-        tmp7 = z11 + z13;
-        tmp11 = (z11 - z13) * 1.414213562f;
-
-        z5 = (z10 + z12) * 1.847759065f;
-        tmp10 = z5 - z12 * 1.082392200f;
-        tmp12 = z5 - z10 * 2.613125930f;
-
-        tmp6 = tmp12 - tmp7;
-        tmp5 = tmp11 - tmp6;
-        tmp4 = tmp10 - tmp5;
-
-        output[i * block_dim] = jpeg_ftoi(tmp0 + tmp7);
-        output[i * block_dim + 7] = jpeg_ftoi(tmp0 - tmp7);
-        output[i * block_dim + 1] = jpeg_ftoi(tmp1 + tmp6);
-        output[i * block_dim + 6] = jpeg_ftoi(tmp1 - tmp6);
-        output[i * block_dim + 2] = jpeg_ftoi(tmp2 + tmp5);
-        output[i * block_dim + 5] = jpeg_ftoi(tmp2 - tmp5);
-        output[i * block_dim + 3] = jpeg_ftoi(tmp3 + tmp4);
-        output[i * block_dim + 4] = jpeg_ftoi(tmp3 - tmp4);
+        int a = 0x80 + ((static_cast<int>(result)) >> 3);
+        if (a < 0)
+            return 0;
+        if (a < 0xFF)
+            return static_cast<s16>(a);
+        if (a < 0x180)
+            return 0xFF;
+        return 0;
     }
-}
 
-static u8 get_component(float value)
-{
-    return std::max(0.0f, std::min(255.0f, value));
-}
+    static void jpeg_dct_float(
+        FloatTable &output, const u16 *ac, const FloatTable &ac_mul)
+    {
+        s16 inptr[block_dim2];
+        float dv[block_dim2];
+        float tp[block_dim2];
+        float tmp0, tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7;
+        float tmp10, tmp11, tmp12, tmp13;
+        float z5, z10, z11, z12, z13;
+
+        for (const auto i : algo::range(block_dim2))
+        {
+            inptr[i] = ac[i];
+            dv[i] = ac_mul[i];
+        }
+
+        for (const auto i : algo::range(block_dim))
+        {
+            if (!inptr[8 + i] && !inptr[16 + i]
+                && !inptr[24 + i] && !inptr[32 + i]
+                && !inptr[40 + i] && !inptr[48 + i]
+                && !inptr[56 + i])
+            {
+                tmp0 = inptr[i] * dv[i];
+                tp[i] = tmp0;
+                tp[8 + i] = tmp0;
+                tp[16 + i] = tmp0;
+                tp[24 + i] = tmp0;
+                tp[32 + i] = tmp0;
+                tp[40 + i] = tmp0;
+                tp[48 + i] = tmp0;
+                tp[56 + i] = tmp0;
+                continue;
+            }
+
+            tmp0 = inptr[i] * dv[i];
+            tmp1 = inptr[16 + i] * dv[16 + i];
+            tmp2 = inptr[32 + i] * dv[32 + i];
+            tmp3 = inptr[48 + i] * dv[48 + i];
+            tmp10 = tmp0 + tmp2;
+            tmp11 = tmp0 - tmp2;
+            tmp13 = tmp1 + tmp3;
+            tmp12 = (tmp1 - tmp3) * 1.414213562f - tmp13;
+            tmp0 = tmp10 + tmp13;
+            tmp3 = tmp10 - tmp13;
+            tmp1 = tmp11 + tmp12;
+            tmp2 = tmp11 - tmp12;
+            tmp4 = inptr[8 + i] * dv[8 + i];
+            tmp5 = inptr[24 + i] * dv[24 + i];
+            tmp6 = inptr[40 + i] * dv[40 + i];
+            tmp7 = inptr[56 + i] * dv[56 + i];
+            z13 = tmp6 + tmp5;
+            z10 = tmp6 - tmp5;
+            z11 = tmp4 + tmp7;
+            z12 = tmp4 - tmp7;
+
+            tmp7 = z11 + z13;
+            tmp11 = (z11 - z13) * 1.414213562f;
+            z5 = (z10 + z12) * 1.847759065f;
+            tmp10 = z12 * 1.082392200f - z5;
+            tmp12 = z10 * (-2.613125930f) + z5;
+
+            tmp6 = tmp12 - tmp7;
+            tmp5 = tmp11 - tmp6;
+            tmp4 = tmp10 + tmp5;
+
+            tp[i] = tmp0 + tmp7;
+            tp[56 + i] = tmp0 - tmp7;
+            tp[8 + i] = tmp1 + tmp6;
+            tp[48 + i] = tmp1 - tmp6;
+            tp[16 + i] = tmp2 + tmp5;
+            tp[40 + i] = tmp2 - tmp5;
+            tp[32 + i] = tmp3 + tmp4;
+            tp[24 + i] = tmp3 - tmp4;
+        }
+
+        for (const auto i : algo::range(block_dim))
+        {
+            z5 = tp[i * block_dim];
+            tmp10 = z5 + tp[block_dim * i + 4];
+            tmp11 = z5 - tp[block_dim * i + 4];
+
+            tmp13 = tp[block_dim * i + 2] + tp[block_dim * i + 6];
+            tmp12 = (tp[block_dim * i + 2] - tp[block_dim * i + 6])
+                * 1.414213562f - tmp13;
+
+            tmp0 = tmp10 + tmp13;
+            tmp3 = tmp10 - tmp13;
+            tmp1 = tmp11 + tmp12;
+            tmp2 = tmp11 - tmp12;
+
+            z13 = tp[block_dim * i + 5] + tp[block_dim * i + 3];
+            z10 = tp[block_dim * i + 5] - tp[block_dim * i + 3];
+            z11 = tp[block_dim * i + 1] + tp[block_dim * i + 7];
+            z12 = tp[block_dim * i + 1] - tp[block_dim * i + 7];
+
+            tmp7 = z11 + z13;
+            tmp11 = (z11 - z13) * 1.414213562f;
+
+            z5 = (z10 + z12) * 1.847759065f;
+            tmp10 = z5 - z12 * 1.082392200f;
+            tmp12 = z5 - z10 * 2.613125930f;
+
+            tmp6 = tmp12 - tmp7;
+            tmp5 = tmp11 - tmp6;
+            tmp4 = tmp10 - tmp5;
+
+            output[i * block_dim] = jpeg_ftoi(tmp0 + tmp7);
+            output[i * block_dim + 7] = jpeg_ftoi(tmp0 - tmp7);
+            output[i * block_dim + 1] = jpeg_ftoi(tmp1 + tmp6);
+            output[i * block_dim + 6] = jpeg_ftoi(tmp1 - tmp6);
+            output[i * block_dim + 2] = jpeg_ftoi(tmp2 + tmp5);
+            output[i * block_dim + 5] = jpeg_ftoi(tmp2 - tmp5);
+            output[i * block_dim + 3] = jpeg_ftoi(tmp3 + tmp4);
+            output[i * block_dim + 4] = jpeg_ftoi(tmp3 - tmp4);
+        }
+    }
+#endif
 
 static std::vector<u16> decompress_block(
     size_t output_size,
@@ -274,23 +421,56 @@ static std::vector<u16> decompress_block(
     return color_info;
 }
 
-static void process_24bit_block(
-    const std::vector<u16> &color_info,
-    const FloatTablePair &ac_mul_pair,
-    size_t width,
-    u8 *rgb_out)
-{
-    FloatTableTriplet yuv_in;
-    for (const auto i : algo::range(width / block_dim))
+#ifdef CBG2_USE_SSE2
+    static void convert_ycbcr_block(
+        const FloatTableTriplet &yuv_in, const size_t width, u8 *rgb_out)
     {
-        for (const auto channel : algo::range(3))
+        const auto zero = _mm_setzero_ps();
+        const auto max = _mm_set1_ps(255.0f);
+        const auto alpha = _mm_set1_epi32(0xFF000000);
+        for (const auto y : algo::range(block_dim))
+        for (const auto x : algo::range(0, block_dim, 4))
         {
-            jpeg_dct_float(
-                yuv_in[channel],
-                &color_info[i * block_dim2 + channel * width * block_dim],
-                ac_mul_pair[channel > 0]);
+            const auto offset = y * block_dim + x;
+            const auto cy = _mm_loadu_ps(&yuv_in[0][offset]);
+            const auto cb = _mm_loadu_ps(&yuv_in[1][offset]);
+            const auto cr = _mm_loadu_ps(&yuv_in[2][offset]);
+
+            auto r = _mm_sub_ps(
+                _mm_add_ps(cy, _mm_mul_ps(_mm_set1_ps(1.402f), cr)),
+                _mm_set1_ps(178.956f));
+            auto g = _mm_add_ps(cy, _mm_set1_ps(44.04992f));
+            g = _mm_sub_ps(g, _mm_mul_ps(_mm_set1_ps(0.34414f), cb));
+            g = _mm_add_ps(g, _mm_set1_ps(91.90992f));
+            g = _mm_sub_ps(g, _mm_mul_ps(_mm_set1_ps(0.71414f), cr));
+            auto b = _mm_sub_ps(
+                _mm_add_ps(cy, _mm_mul_ps(_mm_set1_ps(1.772f), cb)),
+                _mm_set1_ps(226.316f));
+
+            r = _mm_max_ps(_mm_min_ps(r, max), zero);
+            g = _mm_max_ps(_mm_min_ps(g, max), zero);
+            b = _mm_max_ps(_mm_min_ps(b, max), zero);
+
+            const auto pixels = _mm_or_si128(
+                _mm_or_si128(
+                    _mm_cvttps_epi32(b),
+                    _mm_slli_epi32(_mm_cvttps_epi32(g), 8)),
+                _mm_or_si128(
+                    _mm_slli_epi32(_mm_cvttps_epi32(r), 16), alpha));
+            _mm_storeu_si128(
+                reinterpret_cast<__m128i*>(&rgb_out[(y * width + x) * 4]),
+                pixels);
         }
+    }
+#else
+    static u8 get_component(float value)
+    {
+        return std::max(0.0f, std::min(255.0f, value));
+    }
 
+    static void convert_ycbcr_block(
+        const FloatTableTriplet &yuv_in, const size_t width, u8 *rgb_out)
+    {
         for (const auto y : algo::range(block_dim))
         for (const auto x : algo::range(block_dim))
         {
@@ -309,6 +489,26 @@ static void process_24bit_block(
             rgb_ptr[1] = get_component(g);
             rgb_ptr[2] = get_component(r);
         }
+    }
+#endif
+
+static void process_24bit_block(
+    const std::vector<u16> &color_info,
+    const FloatTablePair &ac_mul_pair,
+    size_t width,
+    u8 *rgb_out)
+{
+    FloatTableTriplet yuv_in;
+    for (const auto i : algo::range(width / block_dim))
+    {
+        for (const auto channel : algo::range(3))
+        {
+            jpeg_dct_float(
+                yuv_in[channel],
+                &color_info[i * block_dim2 + channel * width * block_dim],
+                ac_mul_pair[channel > 0]);
+        }
+        convert_ycbcr_block(yuv_in, width, rgb_out);
         rgb_out += 4 * block_dim;
     }
 }
@@ -383,6 +583,23 @@ static void process_alpha(
     }
 }
 
+static void decode_band(
+    const Band &band,
+    const Tree &tree1,
+    const Tree &tree2,
+    const FloatTablePair &ac_mul_pair,
+    const size_t channels,
+    const size_t pad_width,
+    u8 *rgb_out)
+{
+    const auto color_info = decompress_block(
+        band.size_orig, band.data, tree1, tree2);
+    if (channels == 1)
+        process_8bit_block(color_info, ac_mul_pair, pad_width, rgb_out);
+    else
+        process_24bit_block(color_info, ac_mul_pair, pad_width, rgb_out);
+}
+
 std::unique_ptr<res::Image> Cbg2Decoder::decode(
     io::BaseByteStream &input_stream) const
 {
@@ -411,56 +628,51 @@ std::unique_ptr<res::Image> Cbg2Decoder::decode(
     for (const auto i : algo::range(block_count + 1))
         block_offsets[i] = raw_stream.read_le<u32>();
 
-    bstr bmp_data(pad_width * pad_height * 4);
-    for (const auto i : algo::range(bmp_data.size()))
-        bmp_data.get<u8>()[i] = 0xFF;
+    if (channels != 1 && channels != 3 && channels != 4)
+        throw err::UnsupportedChannelCountError(channels);
 
+    // bands only depend on their own compressed data, so they get split
+    // up front and decoded into disjoint rows of the output bitmap
+    std::vector<Band> bands(block_count);
     for (const auto i : algo::range(block_count))
     {
         raw_stream.seek(block_offsets[i]);
         raw_stream.skip((pad_width + block_dim2 - 1) / block_dim2);
-        const auto block_size_orig = read_variable_data(raw_stream);
+        bands[i].size_orig = read_variable_data(raw_stream);
         int block_size_comp = block_offsets[i + 1] - raw_stream.pos();
         if (block_size_comp < 0)
             block_size_comp = raw_stream.size() - raw_stream.pos();
         const auto expected_width
             = pad_width * block_dim * (depth == 8 ? 1 : 3);
-        if (expected_width != block_size_orig)
+        if (expected_width != bands[i].size_orig)
             throw err::BadDataSizeError();
+        bands[i].data = raw_stream.read(block_size_comp);
+    }
 
-        const auto block_data = raw_stream.read(block_size_comp);
-        const auto color_info = decompress_block(
-            block_size_orig, block_data, tree1, tree2);
+    algo::ScratchBuffer bmp_data(pad_width * pad_height * 4, false);
+    std::memset(bmp_data->get<u8>(), 0xFF, bmp_data->size());
 
-        if (channels == 3 || channels == 4)
-        {
-            process_24bit_block(
-                color_info,
-                ac_mul_pair,
-                pad_width,
-                &bmp_data.get<u8>()[pad_width * block_dim * 4 * i]);
-        }
-        else if (channels == 1)
-        {
-            process_8bit_block(
-                color_info,
-                ac_mul_pair,
-                pad_width,
-                &bmp_data.get<u8>()[pad_width * block_dim * 4 * i]);
-        }
-        else
-            throw err::UnsupportedChannelCountError(channels);
-    }
+    algo::parallel_for(block_count, [&](const size_t i)
+    {
+        decode_band(
+            bands[i],
+            tree1,
+            tree2,
+            ac_mul_pair,
+            channels,
+            pad_width,
+            &bmp_data->get<u8>()[pad_width * block_dim * 4 * i]);
+    });
 
     if (channels == 4)
     {
         raw_stream.seek(block_offsets[block_count]);
         if (raw_stream.read_le<u32>() == 1)
-            process_alpha(bmp_data, raw_stream, pad_width);
+            process_alpha(*bmp_data, raw_stream, pad_width);
     }
 
     auto image = std::make_unique<res::Image>(
-        pad_width, pad_height, bmp_data, res::PixelFormat::BGRA8888);
+        pad_width, pad_height, *bmp_data, res::PixelFormat::BGRA8888);
     image->crop(width, height);
     return image;
 }
@@ -79,12 +79,9 @@ NodeInfo &Tree::operator[](size_t index)
     return *nodes[index];
 }
 
-u32 Tree::get_leaf(io::BaseBitStream &bit_stream) const
+u32 Tree::get_leaf(io::MsbBitStream &bit_stream) const
 {
-    u32 node = nodes.size() - 1;
-    while (node >= size)
-        node = nodes.at(node)->children[bit_stream.read(1)];
-    return node;
+    return table->decode(bit_stream);
 }
 
 Tree cbg::build_tree(const FreqTable &freq_table, bool greedy)
@@ -150,5 +147,14 @@ Tree cbg::build_tree(const FreqTable &freq_table, bool greedy)
         if (freq >= freq_sum)
             break;
     }
+
+    tree.table = std::make_shared<algo::pack::HuffmanTable>(
+        algo::pack::HuffmanTable::from_tree(
+            tree.nodes.size() - 1,
+            [&](const u32 node) { return node < tree.size; },
+            [&](const u32 node, const u32 bit)
+            {
+                return tree.nodes.at(node)->children[bit];
+            }));
     return tree;
 }
@@ -18,8 +18,9 @@
 #pragma once
 
 #include <memory>
-#include "io/base_bit_stream.h"
+#include "algo/pack/huffman_table.h"
 #include "io/base_byte_stream.h"
+#include "io/msb_bit_stream.h"
 #include "types.h"
 
 namespace au {
@@ -40,12 +41,13 @@ namespace cbg {
 
     struct Tree final
     {
-        u32 get_leaf(io::BaseBitStream &bit_stream) const;
+        u32 get_leaf(io::MsbBitStream &bit_stream) const;
 
         NodeInfo &operator[](size_t);
 
         u32 size;
         std::vector<std::shared_ptr<NodeInfo>> nodes;
+        std::shared_ptr<algo::pack::HuffmanTable> table;
     };
 
     u32 read_variable_data(io::BaseByteStream &input_stream);
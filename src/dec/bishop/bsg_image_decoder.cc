@@ -124,7 +124,7 @@ res::Image BsgImageDecoder::decode_impl(
                 input_file.stream, output_ptr + i, data_size / 4, 4);
         }
         image = std::make_unique<res::Image>(
-            width, height, output, res::PixelFormat::BGRA8888);
+            width, height, std::move(output), res::PixelFormat::BGRA8888);
     }
     else if (color_type == 1)
     {
@@ -163,7 +163,7 @@ res::Image BsgImageDecoder::decode_impl(
         throw err::NotSupportedError("Unsupported image parameters");
 
     image->flip_vertically();
-    return *image;
+    return std::move(*image);
 }
 
 static auto _ = dec::register_decoder<BsgImageDecoder>("bishop/bsg");
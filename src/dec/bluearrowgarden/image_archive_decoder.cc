@@ -98,11 +98,13 @@ std::unique_ptr<io::File> ImageArchiveDecoder::read_file_impl(
 {
     const auto meta = static_cast<const CustomArchiveMeta*>(&m);
     const auto entry = static_cast<const CustomArchiveEntry*>(&e);
-    res::Image image(*meta->image);
-    image.offset(
+    // only the entry's part of the atlas gets copied
+    res::Image image(entry->width, entry->height);
+    image.overlay(
+        *meta->image,
         -entry->rect[0].x * meta->image->width(),
-        -entry->rect[0].y * meta->image->height());
-    image.crop(entry->width, entry->height);
+        -entry->rect[0].y * meta->image->height(),
+        res::Image::OverlayKind::OverwriteAll);
     return enc::png::PngImageEncoder().encode(logger, image, entry->path);
 }
 
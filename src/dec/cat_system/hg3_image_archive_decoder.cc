@@ -141,7 +141,7 @@ static std::unique_ptr<res::Image> decode_img0000(
 
     output = delta_transform(output, width, height, depth);
     auto image = std::make_unique<res::Image>(
-        width, height, output, res::PixelFormat::BGRA8888);
+        width, height, std::move(output), res::PixelFormat::BGRA8888);
     image->flip_vertically();
     return image;
 }
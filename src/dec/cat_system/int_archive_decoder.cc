@@ -20,6 +20,7 @@
 #include "algo/crypt/mt.h"
 #include "algo/range.h"
 #include "algo/str.h"
+#include "dec/derived_key_cache.h"
 #include "dec/microsoft/exe_archive_decoder.h"
 #include "err.h"
 #include "io/file_system.h"
@@ -168,9 +169,13 @@ std::unique_ptr<dec::ArchiveMeta> IntArchiveDecoder::read_meta_impl(
     const auto file_count = input_file.stream.read_le<u32>();
     const auto name_size = 64;
 
+    // the game id is the same for every archive of a given game
     const auto executable_paths = find_executables(input_file.path);
-    const auto resource_keys = get_resource_keys(logger, executable_paths);
-    const auto game_id = get_game_id(resource_keys);
+    const auto game_id = dec::DerivedKeyCache::get(
+        "cat-system/int", executable_paths, [&]()
+        {
+            return get_game_id(get_resource_keys(logger, executable_paths));
+        });
 
     const auto table_seed = get_table_seed(game_id);
 
@@ -189,6 +194,11 @@ std::unique_ptr<dec::ArchiveMeta> IntArchiveDecoder::read_meta_impl(
         }
     }
 
+    // the key schedule is costly, so it is set up once for all entries
+    std::unique_ptr<algo::crypt::Blowfish> bf;
+    if (meta->encrypted)
+        bf = std::make_unique<algo::crypt::Blowfish>(meta->file_key);
+
     input_file.stream.seek(8);
     for (const auto i : algo::range(file_count))
     {
@@ -206,10 +216,9 @@ std::unique_ptr<dec::ArchiveMeta> IntArchiveDecoder::read_meta_impl(
             entry->path = algo::trim_to_zero(
                 decrypt_name(name, table_seed + i).str());
 
-            algo::crypt::Blowfish bf(meta->file_key);
             bstr offset_and_size = input_file.stream.read(8);
             offset_and_size.get<u32>()[0] += i;
-            offset_and_size = bf.decrypt(offset_and_size);
+            bf->decrypt_in_place(offset_and_size);
             entry->offset = offset_and_size.get<const u32>()[0];
             entry->size = offset_and_size.get<const u32>()[1];
         }
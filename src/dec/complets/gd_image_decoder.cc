@@ -205,7 +205,9 @@ res::Image GdImageDecoder::decode_impl(
             algo::format("Unknown compression type: %x", compression_type));
     }
 
-    return res::Image(width, height, output, fmt).flip_vertically();
+    res::Image image(width, height, output, fmt);
+    image.flip_vertically();
+    return image;
 }
 
 static auto _ = dec::register_decoder<GdImageDecoder>("complets/gd");
@@ -16,7 +16,7 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "dec/cronus/common.h"
-#include "algo/range.h"
+#include "algo/crypt/xor.h"
 
 using namespace au;
 
@@ -30,11 +30,7 @@ u32 dec::cronus::get_delta_key(const bstr &input)
 
 void dec::cronus::delta_decrypt(bstr &input, u32 initial_key)
 {
-    auto current_key = initial_key;
-    const auto key_delta = initial_key % 32;
-    for (const auto i : algo::range(input.size()))
-    {
-        input[i] ^= current_key;
-        current_key += key_delta;
-    }
+    // only the low byte of the key ever reaches the data
+    algo::crypt::xor_rolling(
+        input.get<u8>(), input.size(), initial_key, initial_key % 32);
 }
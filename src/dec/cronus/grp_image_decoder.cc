@@ -218,7 +218,7 @@ res::Image GrpImageDecoder::decode_impl(
     if (header->flip)
         image->flip_vertically();
 
-    return *image;
+    return std::move(*image);
 }
 
 static auto _ = dec::register_decoder<GrpImageDecoder>("cronus/grp");
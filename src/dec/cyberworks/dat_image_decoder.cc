@@ -149,7 +149,7 @@ static std::unique_ptr<res::Image> decode_type_a3(
     }
 
     return std::make_unique<res::Image>(
-        width, height, output, res::PixelFormat::BGRA8888);
+        width, height, std::move(output), res::PixelFormat::BGRA8888);
 }
 
 static std::unique_ptr<res::Image> decode_type_a4(
@@ -205,7 +205,7 @@ static std::unique_ptr<res::Image> decode_type_a4(
     }
 
     return std::make_unique<res::Image>(
-        width, height, output, res::PixelFormat::BGRA8888);
+        width, height, std::move(output), res::PixelFormat::BGRA8888);
 }
 
 static std::unique_ptr<res::Image> decode_type_a(
@@ -266,13 +266,13 @@ res::Image DatImageDecoder::decode_impl(
     if (magic == 'a')
     {
         input_file.stream.seek(2);
-        return *decode_type_a(input_file.stream, plugin);
+        return std::move(*decode_type_a(input_file.stream, plugin));
     }
 
     if (magic == 'c')
     {
         input_file.stream.seek(5);
-        return *decode_type_c(logger, input_file.stream);
+        return std::move(*decode_type_c(logger, input_file.stream));
     }
 
     throw err::RecognitionError("Unknown image type");
@@ -0,0 +1,259 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "dec/derived_key_cache.h"
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "algo/range.h"
+#include "err.h"
+#include "io/file_byte_stream.h"
+#include "io/file_system.h"
+
+using namespace au;
+using namespace au::dec;
+
+namespace
+{
+    struct SourceFile final
+    {
+        io::path path;
+        uoff_t size;
+        u64 last_write_time;
+    };
+
+    struct Slot final
+    {
+        bool ready = false;
+        bstr key;
+        std::vector<SourceFile> source_files;
+    };
+}
+
+static const bstr magic = "AU_KEYS\x02"_b;
+
+// smallest possible serialized slot and source file, used to reject counts
+// that can't fit in what is left of the file
+static const uoff_t min_slot_size = 4 + 4 + 4;
+static const uoff_t min_source_file_size = 4 + 8 + 8;
+
+static std::mutex mutex;
+static std::condition_variable slot_ready;
+static std::map<std::string, std::shared_ptr<Slot>> slots;
+
+static std::string make_slot_name(
+    const std::string &decoder_name,
+    const std::vector<SourceFile> &source_files)
+{
+    auto slot_name = decoder_name;
+    for (const auto &source_file : source_files)
+    {
+        slot_name += "|" + source_file.path.str()
+            + "|" + std::to_string(source_file.size)
+            + "|" + std::to_string(source_file.last_write_time);
+    }
+    return slot_name;
+}
+
+static SourceFile inspect_source_file(const io::path &path)
+{
+    SourceFile source_file;
+    source_file.path = io::absolute(path);
+    source_file.size = io::file_size(source_file.path);
+    source_file.last_write_time = io::last_write_time(source_file.path);
+    return source_file;
+}
+
+static bool is_up_to_date(const SourceFile &source_file)
+{
+    if (!io::is_regular_file(source_file.path))
+        return false;
+    const auto current = inspect_source_file(source_file.path);
+    return current.size == source_file.size
+        && current.last_write_time == source_file.last_write_time;
+}
+
+static bstr read_string(io::BaseByteStream &input_stream)
+{
+    const auto size = input_stream.read_le<u32>();
+    if (size > input_stream.left())
+        throw err::BadDataSizeError();
+    return input_stream.read(size);
+}
+
+static size_t read_count(
+    io::BaseByteStream &input_stream, const uoff_t min_size)
+{
+    const auto count = input_stream.read_le<u32>();
+    if (count > input_stream.left() / min_size)
+        throw err::BadDataSizeError();
+    return count;
+}
+
+static void write_string(io::BaseByteStream &output_stream, const bstr &str)
+{
+    output_stream.write_le<u32>(str.size());
+    output_stream.write(str);
+}
+
+static std::map<std::string, std::shared_ptr<Slot>> read_slots(
+    io::BaseByteStream &input_stream)
+{
+    if (input_stream.left() < magic.size()
+        || input_stream.read(magic.size()) != magic)
+    {
+        throw err::RecognitionError("Not a key cache file");
+    }
+
+    std::map<std::string, std::shared_ptr<Slot>> loaded_slots;
+    const auto slot_count = read_count(input_stream, min_slot_size);
+    for (const auto i : algo::range(slot_count))
+    {
+        const auto slot_name = read_string(input_stream).str();
+        auto slot = std::make_shared<Slot>();
+        slot->ready = true;
+        slot->key = read_string(input_stream);
+        const auto source_file_count
+            = read_count(input_stream, min_source_file_size);
+        bool up_to_date = true;
+        for (const auto j : algo::range(source_file_count))
+        {
+            SourceFile source_file;
+            source_file.path = read_string(input_stream).str();
+            source_file.size = input_stream.read_le<u64>();
+            source_file.last_write_time = input_stream.read_le<u64>();
+            up_to_date &= is_up_to_date(source_file);
+            slot->source_files.push_back(source_file);
+        }
+        if (up_to_date)
+            loaded_slots[slot_name] = slot;
+    }
+    return loaded_slots;
+}
+
+bstr DerivedKeyCache::get(
+    const std::string &decoder_name,
+    const std::vector<io::path> &source_paths,
+    const std::function<bstr()> &derive_func)
+{
+    if (source_paths.empty())
+        return derive_func();
+
+    std::vector<SourceFile> source_files;
+    for (const auto &path : source_paths)
+        source_files.push_back(inspect_source_file(path));
+    const auto slot_name = make_slot_name(decoder_name, source_files);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        const auto it = slots.find(slot_name);
+        if (it == slots.end())
+            break;
+        if (it->second->ready)
+            return it->second->key;
+        slot_ready.wait(lock);
+    }
+
+    const auto slot = std::make_shared<Slot>();
+    slots[slot_name] = slot;
+    lock.unlock();
+
+    bstr key;
+    try
+    {
+        key = derive_func();
+    }
+    catch (...)
+    {
+        lock.lock();
+        slots.erase(slot_name);
+        slot_ready.notify_all();
+        throw;
+    }
+
+    lock.lock();
+    slot->key = key;
+    slot->source_files = source_files;
+    slot->ready = true;
+    slot_ready.notify_all();
+    return key;
+}
+
+bool DerivedKeyCache::load(const io::path &path)
+{
+    if (!io::exists(path))
+        return true;
+
+    std::map<std::string, std::shared_ptr<Slot>> loaded_slots;
+    try
+    {
+        io::FileByteStream input_stream(path, io::FileMode::Read);
+        loaded_slots = read_slots(input_stream);
+    }
+    catch (...)
+    {
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    for (const auto &kv : loaded_slots)
+        slots.insert(kv);
+    return true;
+}
+
+void DerivedKeyCache::save(const io::path &path)
+{
+    std::map<std::string, std::shared_ptr<Slot>> ready_slots;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (const auto &kv : slots)
+            if (kv.second->ready)
+                ready_slots.insert(kv);
+    }
+
+    io::FileByteStream output_stream(path, io::FileMode::Write);
+    output_stream.write(magic);
+    output_stream.write_le<u32>(ready_slots.size());
+    for (const auto &kv : ready_slots)
+    {
+        write_string(output_stream, kv.first);
+        write_string(output_stream, kv.second->key);
+        output_stream.write_le<u32>(kv.second->source_files.size());
+        for (const auto &source_file : kv.second->source_files)
+        {
+            write_string(output_stream, source_file.path.str());
+            output_stream.write_le<u64>(source_file.size);
+            output_stream.write_le<u64>(source_file.last_write_time);
+        }
+    }
+}
+
+void DerivedKeyCache::clear()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    for (auto it = slots.begin(); it != slots.end(); )
+    {
+        // keys being derived right now are left for their callers
+        if (it->second->ready)
+            it = slots.erase(it);
+        else
+            ++it;
+    }
+}
@@ -0,0 +1,57 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <functional>
+#include <vector>
+#include "io/path.h"
+#include "types.h"
+
+namespace au {
+namespace dec {
+
+    // Process-wide cache of key material that decoders derive from files
+    // other than the archive itself (game executables, .tpm files and so
+    // on), so that it gets derived once per game rather than once per
+    // archive.
+    class DerivedKeyCache final
+    {
+    public:
+        // Returns the key cached for given decoder and source files, calling
+        // derive_func if there is none. Keys are looked up by the absolute
+        // paths, sizes and modification times of the source files, so adding,
+        // removing or changing any of them makes the lookup miss. Concurrent
+        // callers asking for the same key wait for the first one instead of
+        // deriving it again. Errors thrown by derive_func and keys derived
+        // from no source files at all are not cached.
+        static bstr get(
+            const std::string &decoder_name,
+            const std::vector<io::path> &source_paths,
+            const std::function<bstr()> &derive_func);
+
+        // Persisted entries whose source files have changed are dropped
+        // when loading. Loading a file that doesn't exist does nothing;
+        // loading an unreadable or corrupt file loads nothing and returns
+        // false.
+        static bool load(const io::path &path);
+        static void save(const io::path &path);
+
+        static void clear();
+    };
+
+} }
@@ -16,6 +16,7 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "dec/dxlib/dx_archive_decoder.h"
+#include "algo/crypt/xor.h"
 #include "algo/locale.h"
 #include "algo/range.h"
 #include "io/memory_byte_stream.h"
@@ -56,13 +57,9 @@ namespace
 static bstr decrypt(
     io::BaseByteStream &input_stream, size_t size, const bstr &key)
 {
-    auto j = input_stream.pos();
+    const auto key_pos = input_stream.pos();
     auto ret = input_stream.read(size);
-    for (const auto i : algo::range(size))
-    {
-        ret[i] ^= key[j % key.size()];
-        j++;
-    }
+    algo::crypt::xor_repeating(ret, key, key_pos);
     return ret;
 }
 
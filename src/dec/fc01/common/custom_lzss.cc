@@ -16,52 +16,37 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "dec/fc01/common/custom_lzss.h"
-#include "algo/range.h"
-#include "err.h"
-#include "io/memory_byte_stream.h"
-
-// Modified LZSS routine
-// - repetition count and look behind pos differs
-// - EOF is okay
+#include "algo/pack/lzss_decoder.h"
 
 using namespace au;
 using namespace au::dec::fc01;
 
-bstr common::custom_lzss_decompress(const bstr &input, size_t output_size)
+namespace
 {
-    io::MemoryByteStream input_stream(input);
-    const size_t dict_size = 0x1000;
-    size_t dict_pos = 0xFEE;
-    u8 dict[dict_size] {};
-
-    bstr output(output_size);
-    auto output_ptr = output.get<u8>();
-    auto output_end = output.end<const u8>();
-
-    u16 control = 0;
-    while (output_ptr < output_end && input_stream.left())
+    // Modified LZSS routine
+    // - repetition count and look behind pos differs
+    // - EOF is okay
+    struct CustomLzssFormat final : algo::pack::BaseLzssFormat
     {
-        control >>= 1;
-        if (!(control & 0x100))
-            control = input_stream.read<u8>() | 0xFF00;
-
-        if (control & 1)
+        static inline bool read_match(
+            const u8 *&input_ptr,
+            const u8 *input_end,
+            size_t &offset,
+            size_t &size)
         {
-            const auto byte = input_stream.read<u8>();
-            dict[dict_pos++] = *output_ptr++ = byte;
-            dict_pos %= dict_size;
-            continue;
+            if (input_end - input_ptr < 2)
+                return false;
+            const auto tmp = input_ptr[0] | (input_ptr[1] << 8);
+            input_ptr += 2;
+            offset = tmp & 0xFFF;
+            size = (tmp >> 12) + 3;
+            return true;
         }
+    };
+}
 
-        const u16 tmp = input_stream.read_le<u16>();
-        u32 look_behind_pos = tmp % dict_size;
-        u16 repetitions = (tmp >> 12) + 3;
-        while (repetitions-- && output_ptr < output_end)
-        {
-            dict[dict_pos++] = *output_ptr++ = dict[look_behind_pos++];
-            look_behind_pos %= dict_size;
-            dict_pos %= dict_size;
-        }
-    }
-    return output;
+bstr common::custom_lzss_decompress(const bstr &input, size_t output_size)
+{
+    return algo::pack::LzssDecoder<CustomLzssFormat>().decode(
+        input, output_size);
 }
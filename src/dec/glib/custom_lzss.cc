@@ -16,14 +16,36 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "dec/glib/custom_lzss.h"
-#include "algo/range.h"
+#include "algo/pack/lzss_decoder.h"
+#include "err.h"
 #include "io/memory_byte_stream.h"
 
-// Modified LZSS routines (repetition count is negated)
-
 using namespace au;
 using namespace au::dec;
 
+namespace
+{
+    // Modified LZSS routines (repetition count is negated)
+    struct CustomLzssFormat final : algo::pack::BaseLzssFormat
+    {
+        static inline bool read_match(
+            const u8 *&input_ptr,
+            const u8 *input_end,
+            size_t &offset,
+            size_t &size)
+        {
+            if (input_end - input_ptr < 2)
+                return false;
+            const auto lo = input_ptr[0];
+            const auto hi = input_ptr[1];
+            input_ptr += 2;
+            offset = lo | ((hi & 0xF0) << 4);
+            size = (~hi & 0x0F) + 3;
+            return true;
+        }
+    };
+}
+
 bstr glib::custom_lzss_decompress(const bstr &input, const size_t output_size)
 {
     io::MemoryByteStream output_stream(input);
@@ -33,40 +55,16 @@ bstr glib::custom_lzss_decompress(const bstr &input, const size_t output_size)
 bstr glib::custom_lzss_decompress(
     io::BaseByteStream &input_stream, const size_t output_size)
 {
-    const size_t dict_size = 0x1000;
-    size_t dict_pos = 0xFEE;
-    u8 dict[dict_size] {};
-
+    // the compressed size is not known up front, so the stream is moved
+    // past whatever the decoder ends up using
+    const auto start_pos = input_stream.pos();
+    const auto input = input_stream.read_to_eof();
     bstr output(output_size);
-    auto output_ptr = output.get<u8>();
-    auto output_end = output.end<const u8>();
-
-    u16 control = 0;
-    while (output_ptr < output_end)
-    {
-        control >>= 1;
-        if (!(control & 0x100))
-            control = input_stream.read<u8>() | 0xFF00;
-
-        if (control & 1)
-        {
-            auto byte = input_stream.read<u8>();
-            dict[dict_pos++] = *output_ptr++ = byte;
-            dict_pos %= dict_size;
-            continue;
-        }
-
-        u32 tmp1 = input_stream.read<u8>();
-        u32 tmp2 = input_stream.read<u8>();
-
-        u32 look_behind_pos = (((tmp2 & 0xF0) << 4) | tmp1) % dict_size;
-        u16 repetitions = (~tmp2 & 0xF) + 3;
-        while (repetitions-- && output_ptr < output_end)
-        {
-            dict[dict_pos++] = *output_ptr++ = dict[look_behind_pos++];
-            look_behind_pos %= dict_size;
-            dict_pos %= dict_size;
-        }
-    }
+    auto actual_size = output_size;
+    const auto input_size = algo::pack::LzssDecoder<CustomLzssFormat>().decode(
+        input.get<const u8>(), input.size(), output.get<u8>(), actual_size);
+    input_stream.seek(start_pos + input_size);
+    if (actual_size < output_size)
+        throw err::EofError();
     return output;
 }
@@ -87,10 +87,11 @@ res::Image JpegPgxImageDecoder::decode_impl(
         custom_lzss_decompress(pgx_stream, extra_size);
     }
 
-    const auto target = custom_lzss_decompress(
+    auto target = custom_lzss_decompress(
         pgx_stream.read_to_eof(), target_size);
 
-    res::Image image(width, height, target, res::PixelFormat::BGRA8888);
+    res::Image image(
+        width, height, std::move(target), res::PixelFormat::BGRA8888);
     if (!transparent)
         for (auto &c : image)
             c.a = 0xFF;
@@ -42,8 +42,9 @@ res::Image PgxImageDecoder::decode_impl(
 
     input_file.stream.seek(input_file.stream.size() - source_size);
     const auto source = input_file.stream.read(source_size);
-    const auto target = custom_lzss_decompress(source, target_size);
-    res::Image image(width, height, target, res::PixelFormat::BGRA8888);
+    auto target = custom_lzss_decompress(source, target_size);
+    res::Image image(
+        width, height, std::move(target), res::PixelFormat::BGRA8888);
     if (!transparent)
         for (auto &c : image)
             c.a = 0xFF;
@@ -16,8 +16,10 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "dec/gnu/gzip_archive_decoder.h"
+#include "algo/crypt/crc.h"
 #include "algo/pack/zlib.h"
 #include "algo/range.h"
+#include "err.h"
 
 using namespace au;
 using namespace au::dec::gnu;
@@ -121,11 +123,13 @@ std::unique_ptr<io::File> GzipArchiveDecoder::read_file_impl(
 {
     const auto entry = static_cast<const PlainArchiveEntry*>(&e);
     input_file.stream.seek(entry->offset);
-    return std::make_unique<io::File>(
-        entry->path,
-        algo::pack::zlib_inflate(
-            input_file.stream.read(entry->size),
-            algo::pack::ZlibKind::RawDeflate));
+    const auto data = algo::pack::zlib_inflate(
+        input_file.stream.read(entry->size),
+        algo::pack::ZlibKind::RawDeflate);
+    const auto expected_checksum = input_file.stream.read_le<u32>();
+    if (algo::crypt::crc32(data) != expected_checksum)
+        throw err::CorruptDataError("Checksum mismatch");
+    return std::make_unique<io::File>(entry->path, data);
 }
 
 static auto _ = dec::register_decoder<GzipArchiveDecoder>("gnu/gzip");
@@ -99,7 +99,7 @@ res::Image GfbImageDecoder::decode_impl(
     }
 
     image->flip_vertically();
-    return *image;
+    return std::move(*image);
 }
 
 static auto _ = dec::register_decoder<GfbImageDecoder>("gpk2/gfb");
@@ -56,7 +56,8 @@ res::Image GsImageDecoder::decode_impl(
 
     if (depth == 32)
     {
-        res::Image image(width, height, data, res::PixelFormat::BGRA8888);
+        res::Image image(
+            width, height, std::move(data), res::PixelFormat::BGRA8888);
         if (!use_transparency)
             for (auto &c : image)
                 c.a = 0xFF;
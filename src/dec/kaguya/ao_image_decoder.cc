@@ -36,11 +36,14 @@ res::Image AoImageDecoder::decode_impl(
     input_file.stream.skip(2);
     const auto x = input_file.stream.read_le<u32>();
     const auto y = input_file.stream.read_le<u32>();
-    const auto data = input_file.stream.read_to_eof();
-    const auto overlay = res::Image(
-        width, height, data, res::PixelFormat::BGRA8888).flip_vertically();
-    return res::Image(x + width, y + height).overlay(
+    auto data = input_file.stream.read_to_eof();
+    res::Image overlay(
+        width, height, std::move(data), res::PixelFormat::BGRA8888);
+    overlay.flip_vertically();
+    res::Image image(x + width, y + height);
+    image.overlay(
         overlay, x, y, res::Image::OverlayKind::OverwriteNonTransparent);
+    return image;
 }
 
 static auto _ = dec::register_decoder<AoImageDecoder>("kaguya/ao");
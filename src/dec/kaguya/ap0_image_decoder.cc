@@ -38,8 +38,9 @@ res::Image Ap0ImageDecoder::decode_impl(
     const auto width = input_file.stream.read_le<u32>();
     const auto height = input_file.stream.read_le<u32>();
     const auto data = input_file.stream.read_to_eof();
-    return res::Image(width, height, data, res::PixelFormat::Gray8)
-        .flip_vertically();
+    res::Image image(width, height, data, res::PixelFormat::Gray8);
+    image.flip_vertically();
+    return image;
 }
 
 static auto _ = dec::register_decoder<Ap0ImageDecoder>("kaguya/ap0");
@@ -39,9 +39,11 @@ res::Image Ap2ImageDecoder::decode_impl(
     const auto depth = input_file.stream.read_le<u32>();
     if (depth != 24 && depth != 32)
         throw err::UnsupportedBitDepthError(depth);
-    const auto data = input_file.stream.read_to_eof();
-    return res::Image(width, height, data, res::PixelFormat::BGRA8888)
-        .flip_vertically();
+    auto data = input_file.stream.read_to_eof();
+    res::Image image(
+        width, height, std::move(data), res::PixelFormat::BGRA8888);
+    image.flip_vertically();
+    return image;
 }
 
 static auto _ = dec::register_decoder<Ap2ImageDecoder>("kaguya/ap2");
@@ -40,8 +40,9 @@ res::Image Ap3ImageDecoder::decode_impl(
     if (depth != 24)
         throw err::UnsupportedBitDepthError(depth);
     const auto data = input_file.stream.read_to_eof();
-    return res::Image(width, height, data, res::PixelFormat::BGR888)
-        .flip_vertically();
+    res::Image image(width, height, data, res::PixelFormat::BGR888);
+    image.flip_vertically();
+    return image;
 }
 
 static auto _ = dec::register_decoder<Ap3ImageDecoder>("kaguya/ap3");
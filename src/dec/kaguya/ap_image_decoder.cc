@@ -38,9 +38,11 @@ res::Image ApImageDecoder::decode_impl(
     const auto width = input_file.stream.read_le<u32>();
     const auto height = input_file.stream.read_le<u32>();
     input_file.stream.skip(2);
-    const auto data = input_file.stream.read_to_eof();
-    return res::Image(width, height, data, res::PixelFormat::BGRA8888)
-        .flip_vertically();
+    auto data = input_file.stream.read_to_eof();
+    res::Image image(
+        width, height, std::move(data), res::PixelFormat::BGRA8888);
+    image.flip_vertically();
+    return image;
 }
 
 static auto _ = dec::register_decoder<ApImageDecoder>("kaguya/ap");
@@ -16,7 +16,10 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "dec/kirikiri/cxdec.h"
+#include <map>
+#include <mutex>
 #include "algo/range.h"
+#include "dec/derived_key_cache.h"
 #include "err.h"
 #include "io/file_byte_stream.h"
 #include "io/file_system.h"
@@ -36,6 +39,12 @@ namespace
         KeyDerivationError() : std::runtime_error("") { }
     };
 
+    struct TpmListing final
+    {
+        u64 last_write_time;
+        std::vector<io::path> paths;
+    };
+
     struct CxdecSettings final
     {
         bstr control_block;
@@ -456,18 +465,53 @@ static void decrypt_chunk(
         data_ptr[i] ^= xor2;
 }
 
-static bstr find_control_block(const io::path &path)
+static std::mutex tpm_listings_mutex;
+static std::map<std::string, TpmListing> tpm_listings;
+
+static std::vector<io::path> scan_tpm_files(const io::path &dir)
 {
-    const auto dir = path.parent();
+    std::vector<io::path> paths;
     for (const auto &path : io::recursive_directory_range(dir))
     {
         if (!io::is_regular_file(path))
             continue;
 
         const auto fn = path.str();
-        if (fn.find(".tpm") != fn.size() - 4)
-            continue;
+        if (fn.find(".tpm") == fn.size() - 4)
+            paths.push_back(path);
+    }
+    return paths;
+}
 
+// Walking the whole game directory is the slow part of finding the key, so
+// it is done once per directory rather than once per archive. It is redone if
+// the directory itself changes or a listed file goes away.
+static std::vector<io::path> find_tpm_files(const io::path &arc_path)
+{
+    const auto dir = io::absolute(arc_path.parent());
+    const auto last_write_time = io::last_write_time(dir);
+    std::lock_guard<std::mutex> lock(tpm_listings_mutex);
+    const auto it = tpm_listings.find(dir.str());
+    if (it != tpm_listings.end()
+        && it->second.last_write_time == last_write_time)
+    {
+        bool up_to_date = true;
+        for (const auto &path : it->second.paths)
+            up_to_date &= io::is_regular_file(path);
+        if (up_to_date)
+            return it->second.paths;
+    }
+
+    auto &listing = tpm_listings[dir.str()];
+    listing.last_write_time = last_write_time;
+    listing.paths = scan_tpm_files(dir);
+    return listing.paths;
+}
+
+static bstr find_control_block(const std::vector<io::path> &tpm_paths)
+{
+    for (const auto &path : tpm_paths)
+    {
         io::FileByteStream tmp_stream(path, io::FileMode::Read);
         const auto content = tmp_stream.read_to_eof();
         const auto pos = content.find(control_block_magic);
@@ -499,9 +543,15 @@ Xp3Plugin au::dec::kirikiri::create_cxdec_plugin(
         -> std::function<void(bstr &, u32)> // fixes crash in clang
     {
         CxdecSettings settings;
-        settings.control_block = control_block.empty()
-            ? find_control_block(arc_path)
-            : control_block;
+        settings.control_block = control_block;
+        if (settings.control_block.empty())
+        {
+            const auto tpm_paths = find_tpm_files(arc_path);
+            settings.control_block = dec::DerivedKeyCache::get(
+                "kirikiri/cxdec",
+                tpm_paths,
+                [&]() { return find_control_block(tpm_paths); });
+        }
         settings.key_derivation_order1 = key_derivation_order1;
         settings.key_derivation_order2 = key_derivation_order2;
         settings.key_derivation_order3 = key_derivation_order3;
@@ -16,25 +16,47 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "dec/kirikiri/tlg/lzss_decompressor.h"
-#include "algo/range.h"
+#include <cstring>
+#include "algo/pack/lzss_decoder.h"
 
 using namespace au;
 using namespace au::dec::kirikiri::tlg;
 
-struct LzssDecompressor::Priv final
+namespace
 {
-    Priv();
+    struct TlgLzssFormat final : algo::pack::BaseLzssFormat
+    {
+        static const size_t initial_dictionary_pos = 0;
+        static const bool literal_flag = false;
 
-    u8 dictionary[4096];
-    size_t offset;
-};
+        static inline bool read_match(
+            const u8 *&input_ptr,
+            const u8 *input_end,
+            size_t &offset,
+            size_t &size)
+        {
+            if (input_end - input_ptr < 2)
+                return false;
+            const auto x0 = input_ptr[0];
+            const auto x1 = input_ptr[1];
+            input_ptr += 2;
+            offset = x0 | ((x1 & 0xF) << 8);
+            size = 3 + ((x1 & 0xF0) >> 4);
+            if (size == 18)
+            {
+                if (input_ptr == input_end)
+                    return false;
+                size += *input_ptr++;
+            }
+            return true;
+        }
+    };
+}
 
-LzssDecompressor::Priv::Priv()
+struct LzssDecompressor::Priv final
 {
-    offset = 0;
-    for (const auto i : algo::range(4096))
-        dictionary[i] = 0;
-}
+    algo::pack::LzssDecoder<TlgLzssFormat> decoder;
+};
 
 LzssDecompressor::LzssDecompressor() : p(new Priv)
 {
@@ -46,72 +68,10 @@ LzssDecompressor::~LzssDecompressor()
 
 void LzssDecompressor::init_dictionary(u8 dictionary[4096])
 {
-    for (const auto i : algo::range(4096))
-        p->dictionary[i] = dictionary[i];
+    std::memcpy(p->decoder.dictionary(), dictionary, 4096);
 }
 
 bstr LzssDecompressor::decompress(const bstr &input, size_t output_size)
 {
-    bstr output(output_size);
-    u8 *output_ptr = output.get<u8>();
-    const u8 *input_ptr = input.get<u8>();
-    const u8 *input_end = input_ptr + input.size();
-    const u8 *output_end = output_ptr + output.size();
-
-    int flags = 0;
-    while (input_ptr < input_end)
-    {
-        flags >>= 1;
-        if ((flags & 0x100) != 0x100)
-        {
-            if (input_ptr >= input_end)
-                return output;
-            flags = *input_ptr++ | 0xFF00;
-        }
-
-        if ((flags & 1) == 1)
-        {
-            if (input_ptr >= input_end)
-                return output;
-            u8 x0 = *input_ptr++;
-            if (input_ptr >= input_end)
-                return output;
-            u8 x1 = *input_ptr++;
-            size_t position = x0 | ((x1 & 0xF) << 8);
-            size_t size = 3 + ((x1 & 0xF0) >> 4);
-            if (size == 18)
-            {
-                if (input_ptr >= input_end)
-                    return output;
-                size += *input_ptr++;
-            }
-
-            for (const auto j : algo::range(size))
-            {
-                u8 c = p->dictionary[position];
-                if (output_ptr >= output_end)
-                    return output;
-                *output_ptr++ = c;
-                p->dictionary[p->offset] = c;
-                p->offset++;
-                p->offset &= 0xFFF;
-                position++;
-                position &= 0xFFF;
-            }
-        }
-        else
-        {
-            if (input_ptr >= input_end)
-                return output;
-            u8 c = *input_ptr++;
-            if (output_ptr >= output_end)
-                return output;
-            *output_ptr++ = c;
-            p->dictionary[p->offset] = c;
-            p->offset++;
-            p->offset &= 0xFFF;
-        }
-    }
-
-    return output;
+    return p->decoder.decode(input, output_size);
 }
@@ -17,6 +17,7 @@
 
 #include "dec/kirikiri/tlg/tlg6_decoder.h"
 #include "algo/range.h"
+#include "algo/scratch.h"
 #include "dec/kirikiri/tlg/lzss_decompressor.h"
 #include "err.h"
 
@@ -476,9 +477,10 @@ static void read_image(
     FilterTypes filter_types(input_stream);
     filter_types.decompress(header);
 
-    bstr pixel_buf(4 * header.image_width * h_block_size);
-    auto zero_line = std::make_unique<res::Pixel[]>(header.image_width);
-    res::Pixel *prev_line = zero_line.get();
+    algo::ScratchBuffer pixel_buf(4 * header.image_width * h_block_size);
+    algo::ScratchBuffer zero_line(sizeof(res::Pixel) * header.image_width);
+    algo::ScratchBuffer bit_pool(0, false);
+    res::Pixel *prev_line = zero_line->get<res::Pixel>();
 
     u32 main_count = header.image_width / w_block_size;
     for (const auto y : algo::range(0, header.image_height, h_block_size))
@@ -496,18 +498,20 @@ static void read_image(
             bit_size &= 0x3FFFFFFF;
 
             int byte_size = (bit_size + 7) / 8;
-            bstr bit_pool = input_stream.read(byte_size);
+            bit_pool->resize(byte_size + 4);
+            input_stream.read(bit_pool->get<u8>(), byte_size);
 
             // Although decode_golomb_values accesses only valid bits, it uses
             // reinterpret_cast<u32*>() that might access bits out of bounds.
             // This is to make sure those calls don't cause access violation.
-            bit_pool.resize(byte_size + 4);
+            for (const auto i : algo::range(4))
+                bit_pool->get<u8>()[byte_size + i] = 0;
 
             if (method != 0)
                 throw err::NotSupportedError("Unsupported encoding method");
 
             decode_golomb_values(
-                pixel_buf.get<u8>() + c, pixel_count, bit_pool.get<u8>());
+                pixel_buf->get<u8>() + c, pixel_count, bit_pool->get<u8>());
         }
 
         u8 *ft = filter_types.data.get<u8>()
@@ -534,7 +538,7 @@ static void read_image(
                     main_count,
                     ft,
                     skip_bytes,
-                    pixel_buf.get<u32>() + start,
+                    pixel_buf->get<u32>() + start,
                     odd_skip,
                     dir,
                     header);
@@ -554,7 +558,7 @@ static void read_image(
                     header.x_block_count,
                     ft,
                     skip_bytes,
-                    pixel_buf.get<u32>() + start,
+                    pixel_buf->get<u32>() + start,
                     odd_skip,
                     dir,
                     header);
@@ -167,7 +167,7 @@ static void read_elif_entry(
 
 static std::unique_ptr<CustomArchiveEntry> read_file_entry(
     const Logger &logger,
-    io::BaseByteStream &input_stream,
+    io::MemoryByteStream &input_stream,
     const std::map<u32, std::string> &fn_map)
 {
     auto entry = std::make_unique<CustomArchiveEntry>();
@@ -175,23 +175,24 @@ static std::unique_ptr<CustomArchiveEntry> read_file_entry(
     {
         const auto chunk_magic = input_stream.read(4);
         const auto chunk_size = input_stream.read_le<u64>();
-        io::MemoryByteStream chunk_stream(input_stream.read(chunk_size));
+        const auto chunk_stream
+            = io::MemoryByteStream::slice(input_stream, chunk_size);
 
         if (chunk_magic == info_chunk_magic)
-            entry->info_chunk = read_info_chunk(chunk_stream);
+            entry->info_chunk = read_info_chunk(*chunk_stream);
         else if (chunk_magic == segm_chunk_magic)
-            entry->segm_chunks = read_segm_chunks(chunk_stream);
+            entry->segm_chunks = read_segm_chunks(*chunk_stream);
         else if (chunk_magic == adlr_chunk_magic)
-            entry->adlr_chunk = read_adlr_chunk(chunk_stream);
+            entry->adlr_chunk = read_adlr_chunk(*chunk_stream);
         else if (chunk_magic == time_chunk_magic)
-            entry->time_chunk = read_time_chunk(chunk_stream);
+            entry->time_chunk = read_time_chunk(*chunk_stream);
         else
         {
             logger.warn("Unknown chunk '%s'\n", chunk_magic.c_str());
             continue;
         }
 
-        if (chunk_stream.left())
+        if (chunk_stream->left())
         {
             logger.warn(
                 "'%s' chunk contains data beyond EOF\n", chunk_magic.c_str());
@@ -235,7 +236,7 @@ std::unique_ptr<dec::ArchiveMeta> Xp3ArchiveDecoder::read_meta_impl(
     auto table_data = input_file.stream.read(table_size_comp);
     if (table_is_compressed)
         table_data = algo::pack::zlib_inflate(table_data);
-    io::MemoryByteStream table_stream(table_data);
+    io::MemoryByteStream table_stream(std::move(table_data));
 
     auto meta = std::make_unique<CustomArchiveMeta>();
     meta->decrypt_func = plugin_manager.get()
@@ -246,15 +247,16 @@ std::unique_ptr<dec::ArchiveMeta> Xp3ArchiveDecoder::read_meta_impl(
     {
         const auto entry_magic = table_stream.read(4);
         const auto entry_size = table_stream.read_le<u64>();
-        io::MemoryByteStream entry_stream(table_stream.read(entry_size));
+        const auto entry_stream
+            = io::MemoryByteStream::slice(table_stream, entry_size);
 
         if (entry_magic == file_entry_magic)
             meta->entries.push_back(
-                read_file_entry(logger, entry_stream, fn_map));
+                read_file_entry(logger, *entry_stream, fn_map));
         else if (entry_magic == hnfn_entry_magic)
-            read_hnfn_entry(entry_stream, fn_map);
+            read_hnfn_entry(*entry_stream, fn_map);
         else if (entry_magic == elif_entry_magic)
-            read_elif_entry(entry_stream, fn_map);
+            read_elif_entry(*entry_stream, fn_map);
         else
             throw err::NotSupportedError("Unknown entry: " + entry_magic.str());
     }
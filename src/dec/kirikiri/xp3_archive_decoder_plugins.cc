@@ -16,6 +16,7 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "dec/kirikiri/xp3_archive_decoder.h"
+#include "algo/crypt/xor.h"
 #include "algo/ptr.h"
 #include "algo/range.h"
 #include "dec/kirikiri/cxdec.h"
@@ -52,16 +53,14 @@ Xp3ArchiveDecoder::Xp3ArchiveDecoder()
         "xor", "Basic XOR encryption",
         create_simple_plugin([](bstr &data, u32 key)
         {
-            for (const auto i : algo::range(data.size()))
-                data[i] ^= key;
+            algo::crypt::xor_byte(data, key);
         }));
 
     plugin_manager.add(
         "xor-p1-neg", "XOR variation",
         create_simple_plugin([](bstr &data, u32 key)
         {
-            for (const auto i : algo::range(0, data.size()))
-                data[i] ^= (key + 1) ^ 0xFF;
+            algo::crypt::xor_byte(data, (key + 1) ^ 0xFF);
         }));
 
     plugin_manager.add(
@@ -93,32 +92,30 @@ Xp3ArchiveDecoder::Xp3ArchiveDecoder()
         "moteyaba", "Imouto no Okage de Motesugite Yabai.",
         create_simple_plugin([](bstr &data, u32 key)
         {
-            for (const auto i : algo::range(data.size()))
-                data[i] ^= 0xCD ^ key;
+            algo::crypt::xor_byte(data, 0xCD ^ key);
         }));
 
     plugin_manager.add(
         "kamiyaba", "Kamidanomi Shisugite Ore no Mirai ga Yabai.",
         create_simple_plugin([](bstr &data, u32 key)
         {
-            for (const auto i : algo::range(data.size()))
-                data[i] ^= 0xCD;
+            algo::crypt::xor_byte(data, 0xCD);
         }));
 
     plugin_manager.add(
         "rebirth", "Re:birth colony ~Lost azurite~",
         create_simple_plugin([](bstr &data, u32 key)
         {
-            for (const auto i : algo::range(5, data.size()))
-                data[i] ^= (key >> 12);
+            if (data.size() > 5)
+                algo::crypt::xor_byte(
+                    data.get<u8>() + 5, data.size() - 5, key >> 12);
         }));
 
     plugin_manager.add(
         "fsn", "Fate/Stay Night",
         create_simple_plugin([](bstr &data, u32 key)
         {
-            for (const auto i : algo::range(data.size()))
-                data[i] ^= 0x36;
+            algo::crypt::xor_byte(data, 0x36);
             if (data.size() > 0x2EA29)
                 data[0x2EA29] ^= 3;
             if (data.size() > 0x13)
@@ -16,7 +16,7 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "dec/leaf/single_letter_group/g_audio_decoder.h"
-#include "algo/crypt/crc32.h"
+#include "algo/crypt/crc.h"
 #include "algo/range.h"
 #include "err.h"
 
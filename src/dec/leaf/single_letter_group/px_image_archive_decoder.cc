@@ -495,11 +495,14 @@ std::unique_ptr<io::File> PxImageArchiveDecoder::read_file_impl(
         {},            // palette
     };
 
-    const auto data = read_blocks(
+    auto data = read_blocks(
         context, input_file.stream, entry->block_offsets);
 
     res::Image image(
-        entry->width, entry->height, data, res::PixelFormat::BGRA8888);
+        entry->width,
+        entry->height,
+        std::move(data),
+        res::PixelFormat::BGRA8888);
     const auto encoder = enc::png::PngImageEncoder();
     return encoder.encode(logger, image, entry->path);
 }
@@ -61,7 +61,8 @@ res::Image WcgImageDecoder::decode_impl(
     for (const auto i : algo::range(0, output.size(), 4))
         output[i + 3] ^= 0xFF;
 
-    return res::Image(width, height, output, res::PixelFormat::BGRA8888);
+    return res::Image(
+        width, height, std::move(output), res::PixelFormat::BGRA8888);
 }
 
 static auto _ = dec::register_decoder<WcgImageDecoder>("liar-soft/wcg");
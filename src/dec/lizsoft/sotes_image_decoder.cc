@@ -73,7 +73,7 @@ res::Image SotesImageDecoder::decode_impl(
     }
 
     image->flip_vertically();
-    return *image;
+    return std::move(*image);
 }
 
 static auto _ = dec::register_decoder<SotesImageDecoder>("lizsoft/sotes");
@@ -16,6 +16,7 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "dec/majiro/rct_image_decoder.h"
+#include "algo/crypt/xor.h"
 #include "algo/range.h"
 #include "algo/str.h"
 #include "dec/majiro/rc8_image_decoder.h"
@@ -49,8 +50,7 @@ static bstr decrypt(const bstr &input, const bstr &key)
         derived_key.get<u32>()[i] = checksum ^ crc_table[(i + checksum) & 0xFF];
 
     bstr output(input);
-    for (const auto i : algo::range(output.size()))
-        output[i] ^= derived_key[i % derived_key.size()];
+    algo::crypt::xor_repeating(output, derived_key);
     return output;
 }
 
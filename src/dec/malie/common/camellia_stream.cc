@@ -17,104 +17,76 @@
 
 #include "dec/malie/common/camellia_stream.h"
 #include <cstring>
+#include "algo/endian.h"
 #include "algo/range.h"
-#include "io/memory_byte_stream.h"
 
 using namespace au;
+using namespace au::dec::malie;
 using namespace au::dec::malie::common;
 
-CamelliaStream::CamelliaStream(
-    io::BaseByteStream &parent_stream, const std::vector<u32> &key)
-        : CamelliaStream(parent_stream, key, 0, parent_stream.size())
-{
-}
+// decrypted data is cached in pages spanning many 16-byte cipher blocks
+static const size_t page_size = 0x1000;
 
-CamelliaStream::CamelliaStream(
-    io::BaseByteStream &parent_stream,
-    const std::vector<u32> &key,
+void common::decrypt_blocks(
+    const algo::crypt::Camellia *camellia,
     const uoff_t offset,
-    const uoff_t size) :
-        key(key),
-        parent_stream(parent_stream.clone()),
-        parent_stream_offset(offset),
-        parent_stream_size(size)
-{
-    if (key.size())
-        camellia = std::make_unique<algo::crypt::Camellia>(key);
-}
-
-CamelliaStream::~CamelliaStream()
-{
-}
-
-void CamelliaStream::seek_impl(const uoff_t offset)
-{
-    parent_stream->seek(parent_stream_offset + offset);
-}
-
-void CamelliaStream::read_impl(void *destination, const size_t size)
+    const u8 *input,
+    u8 *output,
+    const size_t size)
 {
     if (!camellia)
     {
-        const auto chunk = parent_stream->read(size);
-        std::memcpy(destination, chunk.get<u8>(), size);
+        if (input != output)
+            std::memcpy(output, input, size);
         return;
     }
 
-    const auto old_pos = parent_stream->pos();
-    const auto offset_pad = parent_stream->pos() & 0xF;
-    const auto offset_start = parent_stream->pos() & ~0xF;
-    const auto aligned_size = (offset_pad + size + 0xF) & ~0xF;
-    const auto block_count = (aligned_size + 0xF) / 0x10;
-    if (block_count == 0)
-        return;
-
-    parent_stream->seek(parent_stream_offset
-        + ((parent_stream->pos() - parent_stream_offset) - offset_pad));
-
-    io::MemoryByteStream output_stream;
-    output_stream.resize(block_count * 16);
-    output_stream.seek(0);
-    for (const auto i : algo::range(block_count))
+    for (const auto block_pos : algo::range(0, size & ~0xF, 0x10))
     {
         u32 input_block[4];
         u32 output_block[4];
+        std::memcpy(input_block, input + block_pos, 0x10);
         for (const auto j : algo::range(4))
-            input_block[j] = parent_stream->read_le<u32>();
+            input_block[j] = algo::from_little_endian(input_block[j]);
         camellia->decrypt_block_128(
-            offset_start + i * 0x10, input_block, output_block);
+            offset + block_pos, input_block, output_block);
         for (const auto j : algo::range(4))
-            output_stream.write_be<u32>(output_block[j]);
+            output_block[j] = algo::to_big_endian(output_block[j]);
+        std::memcpy(output + block_pos, output_block, 0x10);
     }
-    const auto chunk = output_stream.seek(offset_pad).read(size);
-    std::memcpy(destination, chunk.get<u8>(), size);
-    parent_stream->seek(old_pos + size);
 }
 
-void CamelliaStream::write_impl(const void *source, const size_t size)
+CamelliaStream::CamelliaStream(
+    io::BaseByteStream &parent_stream,
+    const std::shared_ptr<const algo::crypt::Camellia> camellia)
+        : CamelliaStream(parent_stream, camellia, 0, parent_stream.size())
 {
-    throw err::NotSupportedError("Not implemented");
 }
 
-uoff_t CamelliaStream::pos() const
+CamelliaStream::CamelliaStream(
+    io::BaseByteStream &parent_stream,
+    const std::shared_ptr<const algo::crypt::Camellia> camellia,
+    const uoff_t offset,
+    const uoff_t size) :
+        BaseBlockCipherStream(parent_stream, page_size, offset, size),
+        camellia(camellia)
 {
-    return parent_stream->pos() - parent_stream_offset;
 }
 
-uoff_t CamelliaStream::size() const
+CamelliaStream::~CamelliaStream()
 {
-    return parent_stream_size;
 }
 
-void CamelliaStream::resize_impl(const uoff_t new_size)
+void CamelliaStream::decrypt_blocks(
+    const uoff_t offset, u8 *data, const size_t size) const
 {
-    parent_stream->resize(new_size);
+    common::decrypt_blocks(camellia.get(), offset, data, data, size);
 }
 
 std::unique_ptr<io::BaseByteStream> CamelliaStream::clone() const
 {
     auto ret = std::make_unique<CamelliaStream>(
-        *parent_stream, key, parent_stream_offset, parent_stream_size);
+        get_parent_stream(), camellia, get_offset(), size());
     ret->seek(pos());
     return std::move(ret);
 }
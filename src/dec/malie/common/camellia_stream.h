@@ -18,43 +18,46 @@
 #pragma once
 
 #include "algo/crypt/camellia.h"
-#include "io/base_byte_stream.h"
+#include "io/base_block_cipher_stream.h"
 
 namespace au {
 namespace dec {
 namespace malie {
 namespace common {
 
+    // Decrypts whole 16-byte blocks located at given offset of the archive.
+    // Input and output may point to the same buffer. If camellia is null,
+    // the data is copied as-is.
+    void decrypt_blocks(
+        const algo::crypt::Camellia *camellia,
+        const uoff_t offset,
+        const u8 *input,
+        u8 *output,
+        const size_t size);
+
     // Rather than decrypting to bstr, the decryption is implemented as stream,
     // so that huge files occupy as little memory as possible
-    class CamelliaStream final : public io::BaseByteStream
+    class CamelliaStream final : public io::BaseBlockCipherStream
     {
     public:
         CamelliaStream(
-            io::BaseByteStream &parent_stream, const std::vector<u32> &key);
+            io::BaseByteStream &parent_stream,
+            const std::shared_ptr<const algo::crypt::Camellia> camellia);
         CamelliaStream(
             io::BaseByteStream &parent_stream,
-            const std::vector<u32> &key,
+            const std::shared_ptr<const algo::crypt::Camellia> camellia,
             const uoff_t offset,
             const uoff_t size);
         ~CamelliaStream();
 
-        uoff_t size() const override;
-        uoff_t pos() const override;
         std::unique_ptr<BaseByteStream> clone() const override;
 
     protected:
-        void read_impl(void *destination, const size_t size) override;
-        void write_impl(const void *source, const size_t size) override;
-        void seek_impl(const uoff_t offset) override;
-        void resize_impl(const uoff_t new_size) override;
+        void decrypt_blocks(
+            const uoff_t offset, u8 *data, const size_t size) const override;
 
     private:
-        const std::vector<u32> key;
-        std::unique_ptr<algo::crypt::Camellia> camellia;
-        std::unique_ptr<io::BaseByteStream> parent_stream;
-        const uoff_t parent_stream_offset;
-        const uoff_t parent_stream_size;
+        const std::shared_ptr<const algo::crypt::Camellia> camellia;
     };
 
 } } } }
@@ -17,7 +17,9 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
+#include "algo/crypt/camellia.h"
 #include "types.h"
 
 namespace au {
@@ -27,8 +29,23 @@ namespace common {
 
     struct LibPlugin final
     {
+        LibPlugin() : data_alignment(0)
+        {
+        }
+
+        // The key schedule is built once here and shared by all copies of
+        // the plugin, so that recognizing and extracting files doesn't have
+        // to rebuild it each time.
+        LibPlugin(const size_t data_alignment, const std::vector<u32> &key) :
+            data_alignment(data_alignment),
+            camellia(key.empty()
+                ? nullptr
+                : std::make_shared<const algo::crypt::Camellia>(key))
+        {
+        }
+
         size_t data_alignment;
-        std::vector<u32> key;
+        std::shared_ptr<const algo::crypt::Camellia> camellia;
     };
 
 } } } }
@@ -76,11 +76,18 @@ static void read_dir(
 
 bool LibpArchiveDecoder::is_recognized_impl(io::File &input_file) const
 {
+    // decrypting the first block is enough to see the magic
+    const auto block = input_file.stream.seek(0).read(0x10);
+    bstr maybe_magic(block.size());
     for (const auto &plugin : plugin_manager.get_all())
     {
-        common::CamelliaStream camellia_stream(input_file.stream, plugin.key);
-        const auto maybe_magic = camellia_stream.seek(0).read(4);
-        if (maybe_magic == magic)
+        common::decrypt_blocks(
+            plugin.camellia.get(),
+            0,
+            block.get<u8>(),
+            maybe_magic.get<u8>(),
+            block.size());
+        if (maybe_magic.substr(0, magic.size()) == magic)
             return true;
     }
     return false;
@@ -96,7 +103,8 @@ std::unique_ptr<dec::ArchiveMeta> LibpArchiveDecoder::read_meta_impl(
         ? plugin_manager.get("noop")
         : plugin_manager.get();
 
-    common::CamelliaStream camellia_stream(input_file.stream, meta->plugin.key);
+    common::CamelliaStream camellia_stream(
+        input_file.stream, meta->plugin.camellia);
     camellia_stream.seek(magic.size());
     const auto entry_count = camellia_stream.read_le<u32>();
     const auto offset_count = camellia_stream.read_le<u32>();
@@ -124,7 +132,7 @@ std::unique_ptr<io::File> LibpArchiveDecoder::read_file_impl(
         entry->path,
         std::make_unique<common::CamelliaStream>(
             input_file.stream,
-            meta->plugin.key,
+            meta->plugin.camellia,
             entry->offset,
             entry->size));
 }
@@ -291,7 +291,7 @@ static res::Image get_image_without_palette(
         for (auto &c : *image)
             c.a = 0xFF;
 
-    return *image;
+    return std::move(*image);
 }
 
 bool BmpImageDecoder::is_recognized_impl(io::File &input_file) const
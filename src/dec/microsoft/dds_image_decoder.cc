@@ -38,6 +38,26 @@ namespace
         Texture3D  = 4,
     };
 
+    enum DxgiFormat : u32
+    {
+        DXGI_FORMAT_BC1_TYPELESS = 70,
+        DXGI_FORMAT_BC1_UNORM = 71,
+        DXGI_FORMAT_BC1_UNORM_SRGB = 72,
+        DXGI_FORMAT_BC2_TYPELESS = 73,
+        DXGI_FORMAT_BC2_UNORM = 74,
+        DXGI_FORMAT_BC2_UNORM_SRGB = 75,
+        DXGI_FORMAT_BC3_TYPELESS = 76,
+        DXGI_FORMAT_BC3_UNORM = 77,
+        DXGI_FORMAT_BC3_UNORM_SRGB = 78,
+        DXGI_FORMAT_BC4_TYPELESS = 79,
+        DXGI_FORMAT_BC4_UNORM = 80,
+        DXGI_FORMAT_BC5_TYPELESS = 82,
+        DXGI_FORMAT_BC5_UNORM = 83,
+        DXGI_FORMAT_BC7_TYPELESS = 97,
+        DXGI_FORMAT_BC7_UNORM = 98,
+        DXGI_FORMAT_BC7_UNORM_SRGB = 99,
+    };
+
     enum DdsPixelFormatFlags
     {
         DDPF_ALPHAPIXELS = 0x1,
@@ -102,6 +122,10 @@ static const bstr magic_dxt3 = "DXT3"_b;
 static const bstr magic_dxt4 = "DXT4"_b;
 static const bstr magic_dxt5 = "DXT5"_b;
 static const bstr magic_dx10 = "DX10"_b;
+static const bstr magic_ati1 = "ATI1"_b;
+static const bstr magic_bc4u = "BC4U"_b;
+static const bstr magic_ati2 = "ATI2"_b;
+static const bstr magic_bc5u = "BC5U"_b;
 
 static void fill_pixel_format(
     io::BaseByteStream &input_stream, DdsPixelFormat &pixel_format)
@@ -148,6 +172,47 @@ static std::unique_ptr<DdsHeaderDx10> read_header_dx10(
     return header;
 }
 
+static std::unique_ptr<res::Image> decode_dxgi(
+    io::BaseByteStream &input_stream,
+    const u32 dxgi_format,
+    const size_t width,
+    const size_t height)
+{
+    switch (dxgi_format)
+    {
+        case DXGI_FORMAT_BC1_TYPELESS:
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:
+            return decode_dxt1(input_stream, width, height);
+
+        case DXGI_FORMAT_BC2_TYPELESS:
+        case DXGI_FORMAT_BC2_UNORM:
+        case DXGI_FORMAT_BC2_UNORM_SRGB:
+            return decode_dxt3(input_stream, width, height);
+
+        case DXGI_FORMAT_BC3_TYPELESS:
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:
+            return decode_dxt5(input_stream, width, height);
+
+        case DXGI_FORMAT_BC4_TYPELESS:
+        case DXGI_FORMAT_BC4_UNORM:
+            return decode_bc4(input_stream, width, height);
+
+        case DXGI_FORMAT_BC5_TYPELESS:
+        case DXGI_FORMAT_BC5_UNORM:
+            return decode_bc5(input_stream, width, height);
+
+        case DXGI_FORMAT_BC7_TYPELESS:
+        case DXGI_FORMAT_BC7_UNORM:
+        case DXGI_FORMAT_BC7_UNORM_SRGB:
+            return decode_bc7(input_stream, width, height);
+    }
+
+    throw err::NotSupportedError(algo::format(
+        "DXGI format %d is not supported", dxgi_format));
+}
+
 bool DdsImageDecoder::is_recognized_impl(io::File &input_file) const
 {
     return input_file.stream.read(magic.size()) == magic;
@@ -159,26 +224,36 @@ res::Image DdsImageDecoder::decode_impl(
     input_file.stream.skip(magic.size());
 
     auto header = read_header(input_file.stream);
+    std::unique_ptr<DdsHeaderDx10> header_dx10;
     if (header->pixel_format.four_cc == magic_dx10)
-        read_header_dx10(input_file.stream);
+        header_dx10 = read_header_dx10(input_file.stream);
 
     const auto width = header->width;
     const auto height = header->height;
+    const auto &four_cc = header->pixel_format.four_cc;
 
     std::unique_ptr<res::Image> image(nullptr);
-    if (header->pixel_format.flags & DDPF_FOURCC)
+    if (header_dx10)
+    {
+        image = decode_dxgi(
+            input_file.stream, header_dx10->dxgi_format, width, height);
+    }
+    else if (header->pixel_format.flags & DDPF_FOURCC)
     {
-        if (header->pixel_format.four_cc == magic_dxt1)
+        if (four_cc == magic_dxt1)
             image = decode_dxt1(input_file.stream, width, height);
-        else if (header->pixel_format.four_cc == magic_dxt3)
+        else if (four_cc == magic_dxt3)
             image = decode_dxt3(input_file.stream, width, height);
-        else if (header->pixel_format.four_cc == magic_dxt5)
+        else if (four_cc == magic_dxt5)
             image = decode_dxt5(input_file.stream, width, height);
+        else if (four_cc == magic_ati1 || four_cc == magic_bc4u)
+            image = decode_bc4(input_file.stream, width, height);
+        else if (four_cc == magic_ati2 || four_cc == magic_bc5u)
+            image = decode_bc5(input_file.stream, width, height);
         else
         {
             throw err::NotSupportedError(algo::format(
-                "%s textures are not supported",
-                header->pixel_format.four_cc.c_str()));
+                "%s textures are not supported", four_cc.c_str()));
         }
     }
     else if (header->pixel_format.flags & DDPF_RGB)
@@ -193,7 +268,7 @@ res::Image DdsImageDecoder::decode_impl(
     if (image == nullptr)
         throw err::NotSupportedError("Unsupported pixel format");
 
-    return *image;
+    return std::move(*image);
 }
 
 static auto _ = dec::register_decoder<DdsImageDecoder>("microsoft/dds");
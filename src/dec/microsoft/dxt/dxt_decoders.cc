@@ -16,24 +16,279 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "dec/microsoft/dxt/dxt_decoders.h"
+#include <utility>
+#include "algo/endian.h"
+#include "algo/parallel.h"
 #include "algo/range.h"
 
+#if defined(__SSE2__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define DXT_USE_SSE2
+    #include <emmintrin.h>
+#endif
+
 using namespace au;
 
+namespace
+{
+    using BlockDecoder = void (*)(
+        const u8 *input, res::Pixel *output, const size_t stride);
+
+    struct Bc7Mode final
+    {
+        size_t subset_count;
+        size_t partition_bits;
+        size_t rotation_bits;
+        size_t index_selection_bits;
+        size_t color_bits;
+        size_t alpha_bits;
+        size_t endpoint_pbits;
+        size_t shared_pbits;
+        size_t index_bits;
+        size_t secondary_index_bits;
+    };
+
+    class Bc7BitReader final
+    {
+    public:
+        Bc7BitReader(const u8 *input) : pos(0)
+        {
+            low = algo::from_little_endian(
+                reinterpret_cast<const u64&>(input[0]));
+            high = algo::from_little_endian(
+                reinterpret_cast<const u64&>(input[8]));
+        }
+
+        u32 get(const size_t bits)
+        {
+            if (!bits)
+                return 0;
+            u64 value = pos >= 64 ? high >> (pos - 64) : low >> pos;
+            if (pos < 64 && pos + bits > 64)
+                value |= high << (64 - pos);
+            pos += bits;
+            return value & ((1ull << bits) - 1);
+        }
+
+    private:
+        u64 low, high;
+        size_t pos;
+    };
+}
+
+static const Bc7Mode bc7_modes[8] =
+{
+    {3, 4, 0, 0, 4, 0, 1, 0, 3, 0},
+    {2, 6, 0, 0, 6, 0, 0, 1, 3, 0},
+    {3, 6, 0, 0, 5, 0, 0, 0, 2, 0},
+    {2, 6, 0, 0, 7, 0, 1, 0, 2, 0},
+    {1, 0, 2, 1, 5, 6, 0, 0, 2, 3},
+    {1, 0, 2, 0, 7, 8, 0, 0, 2, 2},
+    {1, 0, 0, 0, 7, 7, 1, 0, 4, 0},
+    {2, 6, 0, 0, 5, 5, 1, 0, 2, 0},
+};
+
+// bit N tells which subset pixel N belongs to
+static const u16 bc7_partitions2[64] =
+{
+    0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80,
+    0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+    0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE,
+    0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+    0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A,
+    0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+    0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C,
+    0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22,
+};
+
+static const u8 bc7_partitions3[64][16] =
+{
+    {0, 0, 1, 1, 0, 0, 1, 1, 0, 2, 2, 1, 2, 2, 2, 2},
+    {0, 0, 0, 1, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2, 2, 1},
+    {0, 0, 0, 0, 2, 0, 0, 1, 2, 2, 1, 1, 2, 2, 1, 1},
+    {0, 2, 2, 2, 0, 0, 2, 2, 0, 0, 1, 1, 0, 1, 1, 1},
+    {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2},
+    {0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 2, 2, 0, 0, 2, 2},
+    {0, 0, 2, 2, 0, 0, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1},
+    {0, 0, 1, 1, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1},
+    {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2},
+    {0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2},
+    {0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2},
+    {0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2},
+    {0, 1, 1, 2, 0, 1, 1, 2, 0, 1, 1, 2, 0, 1, 1, 2},
+    {0, 1, 2, 2, 0, 1, 2, 2, 0, 1, 2, 2, 0, 1, 2, 2},
+    {0, 0, 1, 1, 0, 1, 1, 2, 1, 1, 2, 2, 1, 2, 2, 2},
+    {0, 0, 1, 1, 2, 0, 0, 1, 2, 2, 0, 0, 2, 2, 2, 0},
+    {0, 0, 0, 1, 0, 0, 1, 1, 0, 1, 1, 2, 1, 1, 2, 2},
+    {0, 1, 1, 1, 0, 0, 1, 1, 2, 0, 0, 1, 2, 2, 0, 0},
+    {0, 0, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1, 2, 2},
+    {0, 0, 2, 2, 0, 0, 2, 2, 0, 0, 2, 2, 1, 1, 1, 1},
+    {0, 1, 1, 1, 0, 1, 1, 1, 0, 2, 2, 2, 0, 2, 2, 2},
+    {0, 0, 0, 1, 0, 0, 0, 1, 2, 2, 2, 1, 2, 2, 2, 1},
+    {0, 0, 0, 0, 0, 0, 1, 1, 0, 1, 2, 2, 0, 1, 2, 2},
+    {0, 0, 0, 0, 1, 1, 0, 0, 2, 2, 1, 0, 2, 2, 1, 0},
+    {0, 1, 2, 2, 0, 1, 2, 2, 0, 0, 1, 1, 0, 0, 0, 0},
+    {0, 0, 1, 2, 0, 0, 1, 2, 1, 1, 2, 2, 2, 2, 2, 2},
+    {0, 1, 1, 0, 1, 2, 2, 1, 1, 2, 2, 1, 0, 1, 1, 0},
+    {0, 0, 0, 0, 0, 1, 1, 0, 1, 2, 2, 1, 1, 2, 2, 1},
+    {0, 0, 2, 2, 1, 1, 0, 2, 1, 1, 0, 2, 0, 0, 2, 2},
+    {0, 1, 1, 0, 0, 1, 1, 0, 2, 0, 0, 2, 2, 2, 2, 2},
+    {0, 0, 1, 1, 0, 1, 2, 2, 0, 1, 2, 2, 0, 0, 1, 1},
+    {0, 0, 0, 0, 2, 0, 0, 0, 2, 2, 1, 1, 2, 2, 2, 1},
+    {0, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2, 2, 1, 2, 2, 2},
+    {0, 2, 2, 2, 0, 0, 2, 2, 0, 0, 1, 2, 0, 0, 1, 1},
+    {0, 0, 1, 1, 0, 0, 1, 2, 0, 0, 2, 2, 0, 2, 2, 2},
+    {0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2, 0},
+    {0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 0, 0, 0, 0},
+    {0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0},
+    {0, 1, 2, 0, 2, 0, 1, 2, 1, 2, 0, 1, 0, 1, 2, 0},
+    {0, 0, 1, 1, 2, 2, 0, 0, 1, 1, 2, 2, 0, 0, 1, 1},
+    {0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 0, 0, 0, 0, 1, 1},
+    {0, 1, 0, 1, 0, 1, 0, 1, 2, 2, 2, 2, 2, 2, 2, 2},
+    {0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 2, 1, 2, 1, 2, 1},
+    {0, 0, 2, 2, 1, 1, 2, 2, 0, 0, 2, 2, 1, 1, 2, 2},
+    {0, 0, 2, 2, 0, 0, 1, 1, 0, 0, 2, 2, 0, 0, 1, 1},
+    {0, 2, 2, 0, 1, 2, 2, 1, 0, 2, 2, 0, 1, 2, 2, 1},
+    {0, 1, 0, 1, 2, 2, 2, 2, 2, 2, 2, 2, 0, 1, 0, 1},
+    {0, 0, 0, 0, 2, 1, 2, 1, 2, 1, 2, 1, 2, 1, 2, 1},
+    {0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 2, 2, 2, 2},
+    {0, 2, 2, 2, 0, 1, 1, 1, 0, 2, 2, 2, 0, 1, 1, 1},
+    {0, 0, 0, 2, 1, 1, 1, 2, 0, 0, 0, 2, 1, 1, 1, 2},
+    {0, 0, 0, 0, 2, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1, 2},
+    {0, 2, 2, 2, 0, 1, 1, 1, 0, 1, 1, 1, 0, 2, 2, 2},
+    {0, 0, 0, 2, 1, 1, 1, 2, 1, 1, 1, 2, 0, 0, 0, 2},
+    {0, 1, 1, 0, 0, 1, 1, 0, 0, 1, 1, 0, 2, 2, 2, 2},
+    {0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2, 2, 1, 1, 2},
+    {0, 1, 1, 0, 0, 1, 1, 0, 2, 2, 2, 2, 2, 2, 2, 2},
+    {0, 0, 2, 2, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 2, 2},
+    {0, 0, 2, 2, 1, 1, 2, 2, 1, 1, 2, 2, 0, 0, 2, 2},
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2},
+    {0, 0, 0, 2, 0, 0, 0, 1, 0, 0, 0, 2, 0, 0, 0, 1},
+    {0, 2, 2, 2, 1, 2, 2, 2, 0, 2, 2, 2, 1, 2, 2, 2},
+    {0, 1, 0, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2},
+    {0, 1, 1, 1, 2, 0, 1, 1, 2, 2, 0, 1, 2, 2, 2, 0},
+};
+
+// pixels whose index is stored with one bit less, besides pixel 0
+static const u8 bc7_anchors2[64] =
+{
+    15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+    15, 2,  8,  2,  2,  8,  8,  15, 2,  8,  2,  2,  8,  8,  2,  2,
+    15, 15, 6,  8,  2,  8,  15, 15, 2,  8,  2,  2,  2,  15, 15, 6,
+    6,  2,  6,  8,  15, 15, 2,  2,  15, 15, 15, 15, 15, 2,  2,  15,
+};
+
+static const u8 bc7_anchors3[2][64] =
+{
+    {
+        3,  3,  15, 15, 8,  3,  15, 15, 8,  8,  6,  6,  6,  5,  3,  3,
+        3,  3,  8,  15, 3,  3,  6,  10, 5,  8,  8,  6,  8,  5,  15, 15,
+        8,  15, 3,  5,  6,  10, 8,  15, 15, 3,  15, 5,  15, 15, 15, 15,
+        3,  15, 5,  5,  5,  8,  5,  10, 5,  10, 8,  13, 15, 12, 3,  3,
+    },
+    {
+        15, 8,  8,  3,  15, 15, 3,  8,  15, 15, 15, 15, 15, 15, 15, 8,
+        15, 8,  15, 3,  15, 8,  15, 8,  3,  15, 6,  10, 15, 15, 10, 8,
+        15, 3,  15, 10, 10, 8,  9,  10, 6,  15, 8,  15, 3,  6,  6,  8,
+        15, 3,  15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 3,  15, 15, 8,
+    },
+};
+
+static const u8 bc7_weights2[4] = {0, 21, 43, 64};
+static const u8 bc7_weights3[8] = {0, 9, 18, 27, 37, 46, 55, 64};
+static const u8 bc7_weights4[16] =
+    {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
 static std::unique_ptr<res::Image> create_image(
     const size_t width, const size_t height)
 {
     return std::make_unique<res::Image>((width + 3) & ~3, (height + 3) & ~3);
 }
 
-static void decode_dxt1_block(
-    io::BaseByteStream &input_stream, res::Pixel output_colors[4][4])
+// Reads all the blocks at once and decodes each row of blocks straight into
+// the image, with the rows spread over idle worker threads.
+static std::unique_ptr<res::Image> decode_blocks(
+    io::BaseByteStream &input_stream,
+    const size_t width,
+    const size_t height,
+    const size_t block_size,
+    const BlockDecoder decode_block)
+{
+    auto image = create_image(width, height);
+    const auto stride = image->width();
+    const auto blocks_per_row = image->width() / 4;
+    const auto block_rows = image->height() / 4;
+    const auto input
+        = input_stream.read(blocks_per_row * block_rows * block_size);
+    algo::parallel_for(block_rows, [&](const size_t block_y)
+    {
+        auto input_ptr
+            = input.get<const u8>() + block_y * blocks_per_row * block_size;
+        auto output_ptr = &image->at(0, block_y * 4);
+        for (const auto block_x : algo::range(blocks_per_row))
+        {
+            decode_block(input_ptr, output_ptr, stride);
+            input_ptr += block_size;
+            output_ptr += 4;
+        }
+    });
+    return image;
+}
+
+static void decode_dxt3_alpha(const u8 *input, u8 output_alpha[16])
+{
+    for (const auto i : algo::range(8))
+    {
+        output_alpha[i * 2 + 0] = input[i] & 0xF0;
+        output_alpha[i * 2 + 1] = (input[i] & 0x0F) << 4;
+    }
+}
+
+static void decode_dxt5_alpha(const u8 *input, u8 output_alpha[16])
+{
+    u8 alpha[8];
+    alpha[0] = input[0];
+    alpha[1] = input[1];
+
+    // integer division truncates the same way as the usual floating point
+    // formula, since the numerators are exact
+    if (alpha[0] > alpha[1])
+    {
+        for (const auto i : algo::range(2, 8))
+            alpha[i] = ((8 - i) * alpha[0] + (i - 1) * alpha[1]) / 7;
+    }
+    else
+    {
+        for (const auto i : algo::range(2, 6))
+            alpha[i] = ((6 - i) * alpha[0] + (i - 1) * alpha[1]) / 5;
+        alpha[6] = 0;
+        alpha[7] = 255;
+    }
+
+    for (const auto i : algo::range(2))
+    {
+        u32 lookup = input[2 + i * 3];
+        lookup |= input[3 + i * 3] << 8;
+        lookup |= input[4 + i * 3] << 16;
+        for (const auto j : algo::range(8))
+        {
+            output_alpha[i * 8 + j] = alpha[lookup & 7];
+            lookup >>= 3;
+        }
+    }
+}
+
+// Decodes the color part shared by DXT1, DXT3 and DXT5 blocks. If alpha is
+// given, it replaces the alpha of the decoded colors.
+static inline void decode_color_block(
+    const u8 *input,
+    res::Pixel *output,
+    const size_t stride,
+    const u8 *alpha = nullptr)
 {
     res::Pixel colors[4];
-    const auto tmp = input_stream.read(4);
-    const auto *tmp_ptr = tmp.get<const u8>();
-    colors[0] = res::read_pixel<res::PixelFormat::BGR565>(tmp_ptr);
-    colors[1] = res::read_pixel<res::PixelFormat::BGR565>(tmp_ptr);
+    colors[0] = res::read_pixel<res::PixelFormat::BGR565>(input);
+    colors[1] = res::read_pixel<res::PixelFormat::BGR565>(input);
     const auto transparent
         = colors[0].b <= colors[1].b
         && colors[0].g <= colors[1].g
@@ -54,115 +309,288 @@ static void decode_dxt1_block(
         }
     }
 
-    auto lookup = input_stream.read_le<u32>();
+    const auto lookup = algo::from_little_endian(
+        reinterpret_cast<const u32&>(*input));
+
+#ifdef DXT_USE_SSE2
+    // each row of a block is four pixels, which is exactly one register:
+    // the 2-bit indices get spread over the lanes and select their colors
+    // through comparison masks
+    __m128i palette[4];
+    for (const auto i : algo::range(4))
+        palette[i] = _mm_set1_epi32(reinterpret_cast<const int&>(colors[i]));
+    const auto index_shifts = _mm_set_epi32(1, 4, 16, 64);
+    const auto index_mask = _mm_set1_epi32(3);
+    const auto color_mask = _mm_set1_epi32(0x00FFFFFF);
+    const auto zero = _mm_setzero_si128();
+    for (const auto y : algo::range(4))
+    {
+        auto indices = _mm_set1_epi32((lookup >> (y * 8)) & 0xFF);
+        indices = _mm_mullo_epi16(indices, index_shifts);
+        indices = _mm_and_si128(_mm_srli_epi32(indices, 6), index_mask);
+        auto row = _mm_and_si128(
+            _mm_cmpeq_epi32(indices, zero), palette[0]);
+        for (const auto i : algo::range(1, 4))
+        {
+            row = _mm_or_si128(row, _mm_and_si128(
+                _mm_cmpeq_epi32(indices, _mm_set1_epi32(i)), palette[i]));
+        }
+        if (alpha)
+        {
+            auto alpha_row = _mm_cvtsi32_si128(
+                reinterpret_cast<const int&>(alpha[y * 4]));
+            alpha_row = _mm_unpacklo_epi8(alpha_row, zero);
+            alpha_row = _mm_unpacklo_epi16(alpha_row, zero);
+            row = _mm_or_si128(
+                _mm_and_si128(row, color_mask),
+                _mm_slli_epi32(alpha_row, 24));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output), row);
+        output += stride;
+    }
+#else
     for (const auto y : algo::range(4))
-    for (const auto x : algo::range(4))
     {
-        const auto index = lookup & 3;
-        output_colors[y][x] = colors[index];
-        lookup >>= 2;
+        for (const auto x : algo::range(4))
+        {
+            output[x] = colors[(lookup >> ((y * 4 + x) * 2)) & 3];
+            if (alpha)
+                output[x].a = alpha[y * 4 + x];
+        }
+        output += stride;
     }
+#endif
 }
 
-static void decode_dxt5_block(
-    io::BaseByteStream &input_stream, u8 output_alpha[4][4])
+static void decode_dxt1_block(
+    const u8 *input, res::Pixel *output, const size_t stride)
 {
-    u8 alpha[8];
-    alpha[0] = input_stream.read<u8>();
-    alpha[1] = input_stream.read<u8>();
+    decode_color_block(input, output, stride);
+}
 
-    if (alpha[0] > alpha[1])
-    {
-        for (const auto i : algo::range(2, 8))
-            alpha[i] = ((8. - i) * alpha[0] + ((i - 1.) * alpha[1])) / 7.;
-    }
-    else
-    {
-        for (const auto i : algo::range(2, 6))
-            alpha[i] = ((6. - i) * alpha[0] + ((i - 1.) * alpha[1])) / 5.;
-        alpha[6] = 0;
-        alpha[7] = 255;
-    }
+static void decode_dxt3_block(
+    const u8 *input, res::Pixel *output, const size_t stride)
+{
+    u8 alpha[16];
+    decode_dxt3_alpha(input, alpha);
+    decode_color_block(input + 8, output, stride, alpha);
+}
 
-    for (const auto i : algo::range(2))
+static void decode_dxt5_block(
+    const u8 *input, res::Pixel *output, const size_t stride)
+{
+    u8 alpha[16];
+    decode_dxt5_alpha(input, alpha);
+    decode_color_block(input + 8, output, stride, alpha);
+}
+
+static void decode_bc4_block(
+    const u8 *input, res::Pixel *output, const size_t stride)
+{
+    u8 red[16];
+    decode_dxt5_alpha(input, red);
+    for (const auto y : algo::range(4))
     {
-        u32 lookup = input_stream.read<u8>();
-        lookup |= input_stream.read<u8>() << 8;
-        lookup |= input_stream.read<u8>() << 16;
-        for (const auto j : algo::range(8))
+        for (const auto x : algo::range(4))
         {
-            const auto index = lookup & 7;
-            const auto pos = i * 8 + j;
-            const auto x = pos % 4;
-            const auto y = pos / 4;
-            lookup >>= 3;
-            output_alpha[y][x] = alpha[index];
+            const auto value = red[y * 4 + x];
+            output[x] = {value, value, value, 0xFF};
         }
+        output += stride;
     }
 }
 
-std::unique_ptr<res::Image> dec::microsoft::dxt::decode_dxt1(
-    io::BaseByteStream &input_stream, size_t width, size_t height)
+static void decode_bc5_block(
+    const u8 *input, res::Pixel *output, const size_t stride)
 {
-    auto image = create_image(width, height);
-    for (const auto block_y : algo::range(0, height, 4))
-    for (const auto block_x : algo::range(0, width, 4))
+    u8 red[16], green[16];
+    decode_dxt5_alpha(input, red);
+    decode_dxt5_alpha(input + 8, green);
+    for (const auto y : algo::range(4))
     {
-        res::Pixel colors[4][4];
-        decode_dxt1_block(input_stream, colors);
-        for (const auto y : algo::range(4))
         for (const auto x : algo::range(4))
-            image->at(block_x + x, block_y + y) = colors[y][x];
+            output[x] = {0, green[y * 4 + x], red[y * 4 + x], 0xFF};
+        output += stride;
     }
-    return image;
 }
 
-std::unique_ptr<res::Image> dec::microsoft::dxt::decode_dxt3(
-    io::BaseByteStream &input_stream, size_t width, size_t height)
+static u8 expand_bc7_endpoint(const u8 value, const size_t bits)
 {
-    auto image = create_image(width, height);
-    for (const auto block_y : algo::range(0, height, 4))
-    for (const auto block_x : algo::range(0, width, 4))
+    const u8 shifted = value << (8 - bits);
+    return shifted | (shifted >> bits);
+}
+
+static u8 interpolate_bc7(
+    const u8 a, const u8 b, const size_t index, const size_t index_bits)
+{
+    const auto weight
+        = index_bits == 2 ? bc7_weights2[index]
+        : index_bits == 3 ? bc7_weights3[index]
+        : bc7_weights4[index];
+    return (a * (64 - weight) + b * weight + 32) >> 6;
+}
+
+static void decode_bc7_block(
+    const u8 *input, res::Pixel *output, const size_t stride)
+{
+    Bc7BitReader reader(input);
+    size_t mode_number = 0;
+    while (mode_number < 8 && !reader.get(1))
+        mode_number++;
+    if (mode_number == 8)
     {
-        u8 alpha[4][4];
+        // reserved mode, decodes to transparent black
         for (const auto y : algo::range(4))
-        for (const auto x : algo::range(0, 4, 2))
+        for (const auto x : algo::range(4))
+            output[y * stride + x] = {0, 0, 0, 0};
+        return;
+    }
+
+    const auto &mode = bc7_modes[mode_number];
+    const auto partition = reader.get(mode.partition_bits);
+    const auto rotation = reader.get(mode.rotation_bits);
+    const auto index_selection = reader.get(mode.index_selection_bits);
+    const auto endpoint_count = mode.subset_count * 2;
+
+    // RGBA, in the order they are stored in
+    u8 endpoints[6][4];
+    for (const auto channel : algo::range(3))
+    for (const auto i : algo::range(endpoint_count))
+        endpoints[i][channel] = reader.get(mode.color_bits);
+    for (const auto i : algo::range(endpoint_count))
+        endpoints[i][3] = reader.get(mode.alpha_bits);
+
+    auto color_bits = mode.color_bits;
+    auto alpha_bits = mode.alpha_bits;
+    if (mode.endpoint_pbits || mode.shared_pbits)
+    {
+        u8 pbits[6];
+        if (mode.endpoint_pbits)
+        {
+            for (const auto i : algo::range(endpoint_count))
+                pbits[i] = reader.get(1);
+        }
+        else
         {
-            const auto b = input_stream.read<u8>();
-            alpha[y][x + 0] = b & 0xF0;
-            alpha[y][x + 1] = (b & 0x0F) << 4;
+            for (const auto i : algo::range(mode.subset_count))
+                pbits[i * 2] = pbits[i * 2 + 1] = reader.get(1);
         }
+        for (const auto i : algo::range(endpoint_count))
+        for (const auto channel : algo::range(4))
+            endpoints[i][channel] = (endpoints[i][channel] << 1) | pbits[i];
+        color_bits++;
+        if (alpha_bits)
+            alpha_bits++;
+    }
 
-        res::Pixel colors[4][4];
-        decode_dxt1_block(input_stream, colors);
-        for (const auto y : algo::range(4))
-        for (const auto x : algo::range(4))
+    for (const auto i : algo::range(endpoint_count))
+    {
+        for (const auto channel : algo::range(3))
         {
-            colors[y][x].a = alpha[y][x];
-            image->at(block_x + x, block_y + y) = colors[y][x];
+            endpoints[i][channel]
+                = expand_bc7_endpoint(endpoints[i][channel], color_bits);
         }
+        endpoints[i][3] = alpha_bits
+            ? expand_bc7_endpoint(endpoints[i][3], alpha_bits)
+            : 0xFF;
     }
-    return image;
-}
 
-std::unique_ptr<res::Image> dec::microsoft::dxt::decode_dxt5(
-    io::BaseByteStream &input_stream, size_t width, size_t height)
-{
-    auto image = create_image(width, height);
-    for (const auto block_y : algo::range(0, height, 4))
-    for (const auto block_x : algo::range(0, width, 4))
+    u8 subsets[16];
+    for (const auto i : algo::range(16))
     {
-        u8 alpha[4][4];
-        decode_dxt5_block(input_stream, alpha);
+        subsets[i]
+            = mode.subset_count == 1 ? 0
+            : mode.subset_count == 2 ? (bc7_partitions2[partition] >> i) & 1
+            : bc7_partitions3[partition][i];
+    }
 
-        res::Pixel colors[4][4];
-        decode_dxt1_block(input_stream, colors);
-        for (const auto y : algo::range(4))
-        for (const auto x : algo::range(4))
+    const auto is_anchor = [&](const size_t i)
+    {
+        return !i
+            || (mode.subset_count == 2 && i == bc7_anchors2[partition])
+            || (mode.subset_count == 3
+                && (i == bc7_anchors3[0][partition]
+                    || i == bc7_anchors3[1][partition]));
+    };
+
+    u8 indices[16], secondary_indices[16];
+    for (const auto i : algo::range(16))
+        indices[i] = reader.get(mode.index_bits - is_anchor(i));
+    if (mode.secondary_index_bits)
+    {
+        for (const auto i : algo::range(16))
+            secondary_indices[i] = reader.get(mode.secondary_index_bits - !i);
+    }
+
+    for (const auto i : algo::range(16))
+    {
+        const auto &endpoint0 = endpoints[subsets[i] * 2];
+        const auto &endpoint1 = endpoints[subsets[i] * 2 + 1];
+        auto color_index = indices[i];
+        auto color_index_bits = mode.index_bits;
+        auto alpha_index = indices[i];
+        auto alpha_index_bits = mode.index_bits;
+        if (mode.secondary_index_bits)
+        {
+            alpha_index = secondary_indices[i];
+            alpha_index_bits = mode.secondary_index_bits;
+            if (index_selection)
+            {
+                std::swap(color_index, alpha_index);
+                std::swap(color_index_bits, alpha_index_bits);
+            }
+        }
+
+        u8 rgba[4];
+        for (const auto channel : algo::range(3))
         {
-            colors[y][x].a = alpha[y][x];
-            image->at(block_x + x, block_y + y) = colors[y][x];
+            rgba[channel] = interpolate_bc7(
+                endpoint0[channel],
+                endpoint1[channel],
+                color_index,
+                color_index_bits);
         }
+        rgba[3] = interpolate_bc7(
+            endpoint0[3], endpoint1[3], alpha_index, alpha_index_bits);
+        if (rotation)
+            std::swap(rgba[3], rgba[rotation - 1]);
+
+        output[(i / 4) * stride + i % 4] = {rgba[2], rgba[1], rgba[0], rgba[3]};
     }
-    return image;
+}
+
+std::unique_ptr<res::Image> dec::microsoft::dxt::decode_dxt1(
+    io::BaseByteStream &input_stream, size_t width, size_t height)
+{
+    return decode_blocks(input_stream, width, height, 8, decode_dxt1_block);
+}
+
+std::unique_ptr<res::Image> dec::microsoft::dxt::decode_dxt3(
+    io::BaseByteStream &input_stream, size_t width, size_t height)
+{
+    return decode_blocks(input_stream, width, height, 16, decode_dxt3_block);
+}
+
+std::unique_ptr<res::Image> dec::microsoft::dxt::decode_dxt5(
+    io::BaseByteStream &input_stream, size_t width, size_t height)
+{
+    return decode_blocks(input_stream, width, height, 16, decode_dxt5_block);
+}
+
+std::unique_ptr<res::Image> dec::microsoft::dxt::decode_bc4(
+    io::BaseByteStream &input_stream, size_t width, size_t height)
+{
+    return decode_blocks(input_stream, width, height, 8, decode_bc4_block);
+}
+
+std::unique_ptr<res::Image> dec::microsoft::dxt::decode_bc5(
+    io::BaseByteStream &input_stream, size_t width, size_t height)
+{
+    return decode_blocks(input_stream, width, height, 16, decode_bc5_block);
+}
+
+std::unique_ptr<res::Image> dec::microsoft::dxt::decode_bc7(
+    io::BaseByteStream &input_stream, size_t width, size_t height)
+{
+    return decode_blocks(input_stream, width, height, 16, decode_bc7_block);
 }
@@ -40,4 +40,19 @@ namespace dxt {
         const size_t width,
         const size_t height);
 
+    std::unique_ptr<res::Image> decode_bc4(
+        io::BaseByteStream &input_stream,
+        const size_t width,
+        const size_t height);
+
+    std::unique_ptr<res::Image> decode_bc5(
+        io::BaseByteStream &input_stream,
+        const size_t width,
+        const size_t height);
+
+    std::unique_ptr<res::Image> decode_bc7(
+        io::BaseByteStream &input_stream,
+        const size_t width,
+        const size_t height);
+
 } } } }
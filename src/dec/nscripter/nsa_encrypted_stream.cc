@@ -17,37 +17,64 @@
 
 #include "dec/nscripter/nsa_encrypted_stream.h"
 #include <array>
-#include <cstring>
-#include "algo/binary.h"
 #include "algo/crypt/hmac.h"
 #include "algo/crypt/md5.h"
 #include "algo/crypt/sha1.h"
 #include "algo/range.h"
-#include "err.h"
 
 using namespace au;
 using namespace au::dec::nscripter;
 
 static const auto block_size = 1024;
 
-static void transform_block(const bstr &key, size_t block_num, bstr &block)
+namespace
 {
-    bstr bn(8);
+    struct BlockHashers final
+    {
+        BlockHashers() : hmac(algo::crypt::HmacKind::Sha512)
+        {
+        }
+
+        algo::crypt::Md5 md5;
+        algo::crypt::Sha1 sha1;
+        algo::crypt::Hmac hmac;
+    };
+}
+
+static void transform_block(
+    BlockHashers &hashers,
+    const bstr &key,
+    size_t block_num,
+    u8 *block,
+    const size_t size)
+{
+    u8 bn[8] = {0};
 
     {
         size_t i = 0;
-        while (i < bn.size() && block_num)
+        while (i < sizeof(bn) && block_num)
         {
             bn[i++] = block_num & 0xFF;
             block_num >>= 8;
         }
     }
 
-    const auto md5_hash  = algo::crypt::md5(bn);
-    const auto sha1_hash = algo::crypt::sha1(bn);
-    const auto hmac_key  = algo::unxor(md5_hash, sha1_hash).substr(0, 16);
-    const auto hmac_hash = algo::crypt::hmac(
-        key, hmac_key, algo::crypt::HmacKind::Sha512);
+    u8 md5_hash[algo::crypt::Md5::digest_size];
+    u8 sha1_hash[algo::crypt::Sha1::digest_size];
+    hashers.md5.update(bn, sizeof(bn));
+    hashers.md5.finalize(md5_hash);
+    hashers.sha1.update(bn, sizeof(bn));
+    hashers.sha1.finalize(sha1_hash);
+
+    u8 hmac_key[16];
+    for (const auto i : algo::range(sizeof(hmac_key)))
+        hmac_key[i] = md5_hash[i] ^ sha1_hash[i];
+
+    u8 hmac_hash[64];
+    const auto hmac_size = hashers.hmac.digest_size();
+    hashers.hmac.init(hmac_key, sizeof(hmac_key));
+    hashers.hmac.update(key.get<const u8>(), key.size());
+    hashers.hmac.finalize(hmac_hash);
 
     std::array<u8, 256> box;
     for (const auto i : algo::range(256))
@@ -56,7 +83,7 @@ static void transform_block(const bstr &key, size_t block_num, bstr &block)
     u8 index = 0;
     for (const auto i : algo::range(256))
     {
-        index = box[i] + hmac_hash[i % hmac_hash.size()] + index;
+        index = box[i] + hmac_hash[i % hmac_size] + index;
         std::swap(box[i], box[index]);
     }
 
@@ -68,7 +95,7 @@ static void transform_block(const bstr &key, size_t block_num, bstr &block)
         std::swap(box[i0], box[i1]);
     }
 
-    for (const auto i : algo::range(block.size()))
+    for (const auto i : algo::range(size))
     {
         i0++;
         i1 += box[i0];
@@ -78,8 +105,10 @@ static void transform_block(const bstr &key, size_t block_num, bstr &block)
 }
 
 NsaEncryptedStream::NsaEncryptedStream(
-    io::BaseByteStream &parent_stream, const bstr &key)
-    : parent_stream(parent_stream.clone()), key(key)
+    io::BaseByteStream &parent_stream, const bstr &key) :
+        BaseBlockCipherStream(
+            parent_stream, block_size, 0, parent_stream.size()),
+        key(key)
 {
 }
 
@@ -87,63 +116,26 @@ NsaEncryptedStream::~NsaEncryptedStream()
 {
 }
 
-void NsaEncryptedStream::seek_impl(const uoff_t offset)
-{
-    parent_stream->seek(offset);
-}
-
-void NsaEncryptedStream::read_impl(void *destination, const size_t size)
+void NsaEncryptedStream::decrypt_blocks(
+    const uoff_t offset, u8 *data, const size_t size) const
 {
     if (key.empty())
-    {
-        const auto chunk = parent_stream->read(size);
-        std::memcpy(destination, chunk.get<u8>(), size);
         return;
-    }
-
-    const auto orig_pos = parent_stream->pos();
-    const auto padded_pos = orig_pos & ~(block_size - 1);
-    const auto offset_pad = orig_pos % block_size;
-    parent_stream->seek(padded_pos);
-
-    bstr full_buffer;
-    while (full_buffer.size() < size + offset_pad)
+    BlockHashers hashers;
+    for (const auto i : algo::range(0, size, block_size))
     {
-        const auto block_num = parent_stream->pos() / block_size;
-        auto block = parent_stream->read(
-            std::min<uoff_t>(parent_stream->left(), block_size));
-        transform_block(key, block_num, block);
-        full_buffer += block;
+        transform_block(
+            hashers,
+            key,
+            (offset + i) / block_size,
+            data + i,
+            std::min<size_t>(size - i, block_size));
     }
-    if (full_buffer.size() < size)
-        throw err::BadDataSizeError();
-    std::memcpy(destination, full_buffer.get<const u8>() + offset_pad, size);
-    parent_stream->seek(orig_pos + size);
-}
-
-void NsaEncryptedStream::write_impl(const void *source, const size_t size)
-{
-    throw err::NotSupportedError("Not implemented");
-}
-
-uoff_t NsaEncryptedStream::pos() const
-{
-    return parent_stream->pos();
-}
-
-uoff_t NsaEncryptedStream::size() const
-{
-    return parent_stream->size();
-}
-
-void NsaEncryptedStream::resize_impl(const uoff_t new_size)
-{
-    parent_stream->resize(new_size);
 }
 
 std::unique_ptr<io::BaseByteStream> NsaEncryptedStream::clone() const
 {
-    auto ret = std::make_unique<NsaEncryptedStream>(*parent_stream, key);
+    auto ret = std::make_unique<NsaEncryptedStream>(get_parent_stream(), key);
     ret->seek(pos());
     return std::move(ret);
 }
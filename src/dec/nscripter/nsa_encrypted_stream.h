@@ -17,30 +17,25 @@
 
 #pragma once
 
-#include "io/base_byte_stream.h"
+#include "io/base_block_cipher_stream.h"
 
 namespace au {
 namespace dec {
 namespace nscripter {
 
-    class NsaEncryptedStream final : public io::BaseByteStream
+    class NsaEncryptedStream final : public io::BaseBlockCipherStream
     {
     public:
         NsaEncryptedStream(io::BaseByteStream &parent_stream, const bstr &key);
         ~NsaEncryptedStream();
 
-        uoff_t size() const override;
-        uoff_t pos() const override;
         std::unique_ptr<BaseByteStream> clone() const override;
 
     protected:
-        void read_impl(void *destination, const size_t size) override;
-        void write_impl(const void *source, const size_t size) override;
-        void seek_impl(const uoff_t offset) override;
-        void resize_impl(const uoff_t new_size) override;
+        void decrypt_blocks(
+            const uoff_t offset, u8 *data, const size_t size) const override;
 
     private:
-        std::unique_ptr<io::BaseByteStream> parent_stream;
         const bstr key;
     };
 
@@ -219,8 +219,9 @@ static res::Image read_image(
 
     if (compression_type == CompressionType::Sgd)
     {
-        const auto data = decompress_sgd(input, size_orig);
-        return res::Image(width, height, data, res::PixelFormat::BGRA8888);
+        auto data = decompress_sgd(input, size_orig);
+        return res::Image(
+            width, height, std::move(data), res::PixelFormat::BGRA8888);
     }
 
     if (compression_type == CompressionType::Png)
@@ -16,6 +16,7 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "dec/pajamas/gamedat_archive_decoder.h"
+#include "algo/crypt/xor.h"
 #include "algo/range.h"
 #include "err.h"
 
@@ -77,14 +78,7 @@ std::unique_ptr<io::File> GamedatArchiveDecoder::read_file_impl(
     auto data = input_file.stream.seek(entry->offset).read(entry->size);
 
     if (data.substr(0, 5) == "\x95\x6B\x3C\x9D\x63"_b)
-    {
-        u8 key = 0xC5;
-        for (auto &c : data)
-        {
-            c ^= key;
-            key += 0x5C;
-        }
-    }
+        algo::crypt::xor_rolling(data.get<u8>(), data.size(), 0xC5, 0x5C);
 
     return std::make_unique<io::File>(entry->path, data);
 }
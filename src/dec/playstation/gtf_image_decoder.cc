@@ -132,13 +132,16 @@ res::Image GtfImageDecoder::decode_impl(
 
     const auto format = static_cast<CellGcmTextureType>(spec.flags & 0x9F);
     if (format == CellGcmTextureType::CompressedDxt1)
-        return *decode_dxt1(input_file.stream, spec.width, spec.height);
+        return std::move(
+            *decode_dxt1(input_file.stream, spec.width, spec.height));
 
     if (format == CellGcmTextureType::CompressedDxt23)
-        return *decode_dxt3(input_file.stream, spec.width, spec.height);
+        return std::move(
+            *decode_dxt3(input_file.stream, spec.width, spec.height));
 
     if (format == CellGcmTextureType::CompressedDxt45)
-        return *decode_dxt5(input_file.stream, spec.width, spec.height);
+        return std::move(
+            *decode_dxt5(input_file.stream, spec.width, spec.height));
 
     throw err::NotSupportedError("Only DXT-packed textures are supported");
 }
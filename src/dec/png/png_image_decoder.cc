@@ -18,6 +18,7 @@
 #include "dec/png/png_image_decoder.h"
 #include <cstring>
 #include <png.h>
+#include <vector>
 #include "algo/range.h"
 #include "err.h"
 
@@ -26,12 +27,50 @@ using namespace au::dec::png;
 
 static const bstr magic = "\x89PNG"_b;
 
+namespace
+{
+    struct MemoryReader final
+    {
+        const u8 *data;
+        size_t size;
+        size_t pos;
+    };
+}
+
 static void read_handler(png_structp png_ptr, png_bytep output, png_size_t size)
 {
-    auto input_stream
-        = reinterpret_cast<io::BaseByteStream*>(png_get_io_ptr(png_ptr));
-    const auto input = input_stream->read(size);
-    std::memcpy(output, input.get<u8>(), size);
+    auto reader = reinterpret_cast<MemoryReader*>(png_get_io_ptr(png_ptr));
+    if (reader->pos + size > reader->size)
+        throw err::EofError();
+    std::memcpy(output, reader->data + reader->pos, size);
+    reader->pos += size;
+}
+
+// walks the chunks up to IEND so that only the bytes of this PNG get buffered,
+// not whatever follows it in the stream
+static uoff_t measure_png(io::BaseByteStream &input_stream)
+{
+    const auto start_pos = input_stream.pos();
+    auto end_pos = input_stream.size();
+    if (input_stream.left() >= 8)
+    {
+        input_stream.skip(8);
+        while (input_stream.left() >= 12)
+        {
+            const auto chunk_size = input_stream.read_be<u32>();
+            const auto chunk_name = input_stream.read(4);
+            if (static_cast<uoff_t>(chunk_size) + 4 > input_stream.left())
+                break;
+            input_stream.skip(chunk_size + 4);
+            if (chunk_name == "IEND"_b)
+            {
+                end_pos = input_stream.pos();
+                break;
+            }
+        }
+    }
+    input_stream.seek(start_pos);
+    return end_pos - start_pos;
 }
 
 static int custom_chunk_handler(png_structp png_ptr, png_unknown_chunkp chunk)
@@ -70,17 +109,23 @@ static res::Image decode(
             logger.warn("libpng warning: %s\n", warning_msg);
         });
 
+    // libpng gets served from a single buffer rather than through stream
+    // reads, and writes the rows straight into the image as BGRA
+    const auto start_pos = file.stream.pos();
+    const auto input = file.stream.read(measure_png(file.stream));
+    MemoryReader reader {input.get<const u8>(), input.size(), 0};
+
     png_set_read_user_chunk_fn(png_ptr, &handler, custom_chunk_handler);
-    png_set_read_fn(png_ptr, &file.stream, &read_handler);
-    png_read_png(
-        png_ptr,
-        info_ptr,
-        PNG_TRANSFORM_GRAY_TO_RGB
-            | PNG_TRANSFORM_STRIP_16
-            | PNG_TRANSFORM_PACKING
-            | PNG_TRANSFORM_BGR
-            | PNG_TRANSFORM_EXPAND,
-        nullptr);
+    png_set_read_fn(png_ptr, &reader, &read_handler);
+    png_read_info(png_ptr, info_ptr);
+    png_set_expand(png_ptr);
+    png_set_strip_16(png_ptr);
+    png_set_packing(png_ptr);
+    png_set_gray_to_rgb(png_ptr);
+    png_set_bgr(png_ptr);
+    png_set_filler(png_ptr, 0xFF, PNG_FILLER_AFTER);
+    png_set_interlace_handling(png_ptr);
+    png_read_update_info(png_ptr, info_ptr);
 
     int color_type;
     int bits_per_channel;
@@ -92,26 +137,19 @@ static res::Image decode(
         nullptr, nullptr, nullptr);
     if (bits_per_channel != 8)
         throw err::UnsupportedBitDepthError(bits_per_channel);
-
-    png_bytepp row_pointers = png_get_rows(png_ptr, info_ptr);
-
-    res::PixelFormat format;
-    if (color_type == PNG_COLOR_TYPE_RGB)
-        format = res::PixelFormat::BGR888;
-    else if (color_type == PNG_COLOR_TYPE_RGBA)
-        format = res::PixelFormat::BGRA8888;
-    else if (color_type == PNG_COLOR_TYPE_GRAY)
-        format = res::PixelFormat::Gray8;
-    else
+    if (png_get_rowbytes(png_ptr, info_ptr) != width * 4)
         throw err::NotSupportedError("Bad pixel format");
 
-    bstr data;
-    data.reserve(width * height * pixel_format_to_bpp(format));
+    res::Image image(width, height);
+    std::vector<png_bytep> row_pointers(height);
     for (const auto y : algo::range(height))
-        data += bstr(row_pointers[y], width * pixel_format_to_bpp(format));
+        row_pointers[y] = reinterpret_cast<png_bytep>(&image.at(0, y));
+    png_read_image(png_ptr, row_pointers.data());
+    png_read_end(png_ptr, info_ptr);
     png_destroy_read_struct(&png_ptr, &info_ptr, nullptr);
 
-    return res::Image(width, height, data, format);
+    file.stream.seek(start_pos + reader.pos);
+    return image;
 }
 
 bool PngImageDecoder::is_recognized_impl(io::File &input_file) const
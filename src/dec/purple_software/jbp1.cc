@@ -17,6 +17,7 @@
 
 #include "dec/purple_software/jbp1.h"
 #include <array>
+#include "algo/pack/huffman_table.h"
 #include "algo/range.h"
 #include "err.h"
 #include "io/memory_byte_stream.h"
@@ -53,39 +54,25 @@ namespace
         size_t root;
         size_t input_size;
     };
-
-    class CustomBitStream final : public io::BaseBitStream
-    {
-    public:
-        CustomBitStream(const bstr &str);
-        u32 read(const size_t bits) override;
-    };
 }
 
 Tree::Tree() : base(), neighbour(), other()
 {
 }
 
-CustomBitStream::CustomBitStream(const bstr &input) : io::BaseBitStream(input)
-{
-}
-
-u32 CustomBitStream::read(const size_t bits)
+// bits are stored starting from the least significant one of each byte
+static bstr reverse_bit_order(const bstr &input)
 {
-    u32 ret = 0;
-    for (const auto i : algo::range(bits))
+    bstr output(input.size());
+    for (const auto i : algo::range(input.size()))
     {
-        if (!bits_available)
-        {
-            buffer = input_stream->read<u8>();
-            bits_available = 8;
-        }
-        ret <<= 1;
-        ret |= (buffer & 1);
-        buffer >>= 1;
-        bits_available--;
+        u8 c = input[i];
+        c = ((c & 0xF0) >> 4) | ((c & 0x0F) << 4);
+        c = ((c & 0xCC) >> 2) | ((c & 0x33) << 2);
+        c = ((c & 0xAA) >> 1) | ((c & 0x55) << 1);
+        output[i] = c;
     }
-    return ret;
+    return output;
 }
 
 static Tree make_tree(const bstr &input, std::array<u32, 0x80> &freq)
@@ -149,12 +136,15 @@ static Tree make_tree(const bstr &input, std::array<u32, 0x80> &freq)
     return ret;
 }
 
-static int read_from_tree(const Tree &tree, io::BaseBitStream &bit_stream)
+static algo::pack::HuffmanTable make_table(const Tree &tree)
 {
-    size_t ret = tree.root;
-    while (ret >= tree.input_size)
-        ret = tree.neighbour.at((bit_stream.read(1) << 9) + ret);
-    return ret;
+    return algo::pack::HuffmanTable::from_tree(
+        tree.root,
+        [&](const u32 node) { return node < tree.input_size; },
+        [&](const u32 node, const u32 bit)
+        {
+            return tree.neighbour.at((bit << 9) + node);
+        });
 }
 
 static void dct(
@@ -355,21 +345,21 @@ static void ycc2rgb(u8 *dc, u8 *ac, short *iy, short *cbcr, const size_t stride)
 static bstr decode_blocks(
     const BasicInfo &info,
     const bstr &tree_input,
-    io::BaseBitStream &bit_stream_1,
-    io::BaseBitStream &bit_stream_2,
+    io::MsbBitStream &bit_stream_1,
+    io::MsbBitStream &bit_stream_2,
     std::array<u32, 0x80> &freq_dc,
     std::array<u32, 0x80> &freq_ac,
     const std::array<s16, 64> &quant_y,
     const std::array<s16, 64> &quant_c)
 {
-    const auto tree_dc = make_tree(tree_input, freq_dc);
-    const auto tree_ac = make_tree(tree_input, freq_ac);
+    const auto table_dc = make_table(make_tree(tree_input, freq_dc));
+    const auto table_ac = make_table(make_tree(tree_input, freq_ac));
 
     std::vector<u32> tmp(info.x_block_count * info.y_block_count * 3 * 2);
 
     for (const auto i : algo::range(tmp.size()))
     {
-        const auto bit_count = read_from_tree(tree_dc, bit_stream_1);
+        const auto bit_count = table_dc.decode(bit_stream_1);
         u32 x = bit_stream_1.read(bit_count);
         if (x < (1u << (bit_count - 1)))
             x = x - (1 << bit_count) + 1;
@@ -408,8 +398,7 @@ static bstr decode_blocks(
 
                 for (int i = 0; i < 63;)
                 {
-                    const auto bit_count
-                        = read_from_tree(tree_ac, bit_stream_2);
+                    const auto bit_count = table_ac.decode(bit_stream_2);
 
                     if (bit_count == 15)
                         break;
@@ -545,8 +534,10 @@ bstr dec::purple_software::jbp1_decompress(const bstr &input)
             quant_c[i] =  input_stream.read<u8>();
     }
 
-    CustomBitStream bit_stream_1(input_stream.read(info.bit_pool_1_size));
-    CustomBitStream bit_stream_2(input_stream.read(info.bit_pool_2_size));
+    io::MsbBitStream bit_stream_1(
+        reverse_bit_order(input_stream.read(info.bit_pool_1_size)));
+    io::MsbBitStream bit_stream_2(
+        reverse_bit_order(input_stream.read(info.bit_pool_2_size)));
     const auto block_output = decode_blocks(
         info,
         tree_input,
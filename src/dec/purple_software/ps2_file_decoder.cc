@@ -16,9 +16,9 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "dec/purple_software/ps2_file_decoder.h"
-#include <array>
 #include "algo/binary.h"
-#include "algo/ptr.h"
+#include "algo/crypt/xor.h"
+#include "algo/pack/lzss_decoder.h"
 #include "algo/range.h"
 
 using namespace au;
@@ -28,52 +28,41 @@ static const bstr magic = "PS2A"_b;
 
 static void decrypt(bstr &data, const u32 key, const size_t shift)
 {
-    for (const auto i : algo::range(data.size()))
-        data[i] = algo::rotr<u8>((data[i] - 0x7C) ^ key, shift);
+    u8 table[0x100];
+    for (const auto i : algo::range(0x100))
+        table[i] = algo::rotr<u8>((i - 0x7C) ^ key, shift);
+    algo::crypt::transform_bytes(data.get<u8>(), data.size(), table);
 }
 
-static bstr custom_lzss_decompress(const bstr &input, const size_t size_orig)
+namespace
 {
-    std::array<u8, 0x800> dict = {0};
-    auto dict_ptr = algo::make_cyclic_ptr(dict.data(), dict.size()) + 0x7DF;
-    bstr output(size_orig);
-    auto output_ptr = algo::make_ptr(output);
-    auto input_ptr = algo::make_ptr(input);
-    u16 control = 1;
-    while (output_ptr.left())
+    struct CustomLzssFormat final : algo::pack::BaseLzssFormat
     {
-        if (control == 1)
-        {
-            if (!input_ptr.left()) break;
-            control = *input_ptr++ | 0x100;
-        }
-        if (control & 1)
-        {
-            if (!input_ptr.left()) break;
-            const auto b = *input_ptr++;
-            *output_ptr++ = b;
-            *dict_ptr++ = b;
-        }
-        else
+        static const size_t dictionary_size = 0x800;
+        static const size_t initial_dictionary_pos = 0x7DF;
+
+        static inline bool read_match(
+            const u8 *&input_ptr,
+            const u8 *input_end,
+            size_t &offset,
+            size_t &size)
         {
-            if (input_ptr.left() < 2) break;
-            const auto lo = *input_ptr++;
-            const auto hi = *input_ptr++;
-            const auto look_behind_pos = lo | (hi & 0xE0) << 3;
-            auto repetitions = (hi & 0x1F) + 2;
-            auto source_ptr
-                = algo::make_cyclic_ptr(dict.data(), dict.size())
-                + look_behind_pos;
-            while (repetitions-- && output_ptr.left())
-            {
-                const auto b = *source_ptr++;
-                *output_ptr++ = b;
-                *dict_ptr++ = b;
-            }
+            if (input_end - input_ptr < 2)
+                return false;
+            const auto lo = input_ptr[0];
+            const auto hi = input_ptr[1];
+            input_ptr += 2;
+            offset = lo | ((hi & 0xE0) << 3);
+            size = (hi & 0x1F) + 2;
+            return true;
         }
-        control >>= 1;
-    }
-    return output;
+    };
+}
+
+static bstr custom_lzss_decompress(const bstr &input, const size_t size_orig)
+{
+    return algo::pack::LzssDecoder<CustomLzssFormat>().decode(
+        input, size_orig);
 }
 
 bool Ps2FileDecoder::is_recognized_impl(io::File &input_file) const
@@ -17,6 +17,7 @@
 
 #include "dec/qlie/pack_archive_decoder.h"
 #include "algo/binary.h"
+#include "algo/crypt/xor.h"
 #include "algo/locale.h"
 #include "algo/ptr.h"
 #include "algo/range.h"
@@ -78,18 +79,15 @@ static void decrypt_file_name(bstr &file_name, const u32 key)
 
 static void decrypt_file_data_basic(bstr &data, const u32 seed)
 {
-    u64 *current = data.get<u64>();
-    const u64 *end = current + data.size() / 8;
-    u64 key = 0xA73C5F9DA73C5F9D;
     u64 mutator = (seed + data.size()) ^ 0xFEC9753E;
     mutator = (mutator << 32) | mutator;
-
-    while (current < end)
-    {
-        key = algo::padd(key, 0xCE24F523CE24F523);
-        key ^= mutator;
-        mutator = *current++ ^= key;
-    }
+    algo::crypt::xor_packed_add_chained(
+        data.get<u8>(),
+        data.size(),
+        0xA73C5F9DA73C5F9D,
+        0xCE24F523CE24F523,
+        mutator,
+        algo::crypt::PackedLanes::U32);
 }
 
 static void decrypt_file_data_with_external_keys(
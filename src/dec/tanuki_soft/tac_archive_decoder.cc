@@ -53,11 +53,10 @@ namespace
 static const bstr magic_100 = "TArc1.00\x00\x00\x00\x00"_b;
 static const bstr magic_110 = "TArc1.10\x00\x00\x00\x00"_b;
 
-static bstr decrypt(const bstr &input, size_t size, const bstr &key)
+static void decrypt(
+    const algo::crypt::Blowfish &bf, bstr &data, const size_t size)
 {
-    algo::crypt::Blowfish bf(key);
-    const auto left = (size / bf.block_size()) * bf.block_size();
-    return bf.decrypt(input.substr(0, left)) + input.substr(left);
+    bf.decrypt_in_place(data.get<u8>(), std::min(size, data.size()));
 }
 
 static Version read_version(io::BaseByteStream &input_stream)
@@ -89,7 +88,8 @@ std::unique_ptr<dec::ArchiveMeta> TacArchiveDecoder::read_meta_impl(
     const auto file_data_start = input_file.stream.pos() + table_size;
 
     auto table_data = input_file.stream.read(table_size);
-    table_data = decrypt(table_data, table_size, "TLibArchiveData"_b);
+    decrypt(
+        algo::crypt::Blowfish("TLibArchiveData"_b), table_data, table_size);
     table_data = algo::pack::zlib_inflate(table_data);
     io::MemoryByteStream table_stream(table_data);
 
@@ -146,19 +146,19 @@ std::unique_ptr<io::File> TacArchiveDecoder::read_file_impl(
 
     if (!entry->compressed)
     {
-        const auto key = algo::format("%llu_tlib_secure_", entry->hash);
+        const algo::crypt::Blowfish bf(
+            algo::format("%llu_tlib_secure_", entry->hash));
         auto bytes_to_decrypt = std::min<size_t>(10240, data.size());
 
         {
-            const auto header = decrypt(
-                data.substr(0, algo::crypt::Blowfish::block_size()),
-                algo::crypt::Blowfish::block_size(),
-                key).substr(0, 4);
+            auto header = data.substr(0, algo::crypt::Blowfish::block_size());
+            decrypt(bf, header, header.size());
+            header = header.substr(0, 4);
             if (header == "RIFF"_b || header == "TArc"_b)
                 bytes_to_decrypt = data.size();
         }
 
-        data = decrypt(data, bytes_to_decrypt, key);
+        decrypt(bf, data, bytes_to_decrypt);
     }
 
     auto output_file = std::make_unique<io::File>(entry->path, data);
@@ -130,7 +130,10 @@ std::unique_ptr<io::File> Pak1ImageArchiveDecoder::read_file_impl(
     if (entry->depth == 32)
     {
         image = std::make_unique<res::Image>(
-            entry->width, entry->height, output, res::PixelFormat::BGRA8888);
+            entry->width,
+            entry->height,
+            std::move(output),
+            res::PixelFormat::BGRA8888);
     }
     else if (entry->depth == 24)
     {
@@ -76,7 +76,8 @@ static res::Image get_image(
     else if (channels == 3)
         return res::Image(width, height, data, res::PixelFormat::BGR888);
     else if (channels == 4)
-        return res::Image(width, height, data, res::PixelFormat::BGRA8888);
+        return res::Image(
+            width, height, std::move(data), res::PixelFormat::BGRA8888);
     else
         throw err::UnsupportedChannelCountError(channels);
 }
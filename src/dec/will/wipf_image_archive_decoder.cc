@@ -16,6 +16,7 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "dec/will/wipf_image_archive_decoder.h"
+#include "algo/pack/lzss_decoder.h"
 #include "algo/range.h"
 #include "enc/png/png_image_encoder.h"
 #include "err.h"
@@ -38,50 +39,38 @@ namespace
     };
 }
 
-// Modified LZSS routine
-// - repetition count and look behind pos differs
-// - non-standard initial dictionary pos
-// - non-standard minimal match size
-static bstr custom_lzss_decompress(const bstr &input, size_t output_size)
+namespace
 {
-    io::MemoryByteStream input_stream(input);
-    const size_t dict_size = 0x1000;
-    size_t dict_pos = 1;
-    u8 dict[dict_size] {};
-    bstr output(output_size);
-    auto output_ptr = output.get<u8>();
-    auto output_end = output.end<const u8>();
-    u16 control = 0;
-    while (output_ptr < output_end && input_stream.left())
+    // Modified LZSS routine
+    // - repetition count and look behind pos differs
+    // - non-standard initial dictionary pos
+    // - non-standard minimal match size
+    struct CustomLzssFormat final : algo::pack::BaseLzssFormat
     {
-        control >>= 1;
-        if (!(control & 0x100))
-            control = input_stream.read<u8>() | 0xFF00;
-        if (control & 1)
-        {
-            if (!input_stream.left())
-                break;
-            auto byte = input_stream.read<u8>();
-            dict[dict_pos++] = *output_ptr++ = byte;
-            dict_pos %= dict_size;
-            continue;
-        }
-        if (!input_stream.left())
-            break;
-        u8 di = input_stream.read<u8>();
-        if (!input_stream.left())
-            break;
-        u8 tmp = input_stream.read<u8>();
-        u32 look_behind_pos = (((di << 8) | tmp) >> 4);
-        u16 repetitions = (tmp & 0xF) + 2;
-        while (repetitions-- && output_ptr < output_end)
+        static const size_t initial_dictionary_pos = 1;
+
+        static inline bool read_match(
+            const u8 *&input_ptr,
+            const u8 *input_end,
+            size_t &offset,
+            size_t &size)
         {
-            dict[dict_pos++] = *output_ptr++ = dict[look_behind_pos++];
-            look_behind_pos %= dict_size;
-            dict_pos %= dict_size;
+            if (input_end - input_ptr < 2)
+                return false;
+            const auto hi = input_ptr[0];
+            const auto lo = input_ptr[1];
+            input_ptr += 2;
+            offset = ((hi << 8) | lo) >> 4;
+            size = (lo & 0xF) + 2;
+            return true;
         }
-    }
-    return output;
+    };
+}
+
+static bstr custom_lzss_decompress(const bstr &input, size_t output_size)
+{
+    return algo::pack::LzssDecoder<CustomLzssFormat>().decode(
+        input, output_size);
 }
 
 static std::unique_ptr<res::Image> read_image(
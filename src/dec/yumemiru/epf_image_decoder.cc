@@ -39,9 +39,10 @@ res::Image EpfImageDecoder::decode_impl(
         throw err::CorruptDataError("Expected '1'");
     const auto size_orig = input_file.stream.read_le<u32>();
     const auto size_comp = input_file.stream.read_le<u32>();
-    const auto data = algo::pack::lzss_decompress(
+    auto data = algo::pack::lzss_decompress(
         input_file.stream.read(size_comp), size_orig);
-    return res::Image(width, height, data, res::PixelFormat::BGRA8888);
+    return res::Image(
+        width, height, std::move(data), res::PixelFormat::BGRA8888);
 }
 
 static auto _ = dec::register_decoder<EpfImageDecoder>("yumemiru/epf");
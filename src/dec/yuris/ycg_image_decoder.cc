@@ -59,7 +59,8 @@ res::Image YcgImageDecoder::decode_impl(
     if (depth != 32)
         throw err::UnsupportedBitDepthError(depth);
 
-    return res::Image(width, height, data, res::PixelFormat::BGRA8888);
+    return res::Image(
+        width, height, std::move(data), res::PixelFormat::BGRA8888);
 }
 
 static auto _ = dec::register_decoder<YcgImageDecoder>("yuris/ycg");
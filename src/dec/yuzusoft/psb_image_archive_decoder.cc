@@ -256,6 +256,22 @@ io::BaseByteStream &NamedDirectory::get(const std::string &name)
     throw err::CorruptDataError("Missing entry '" + name + "'");
 }
 
+PsbImageArchiveDecoder::PsbImageArchiveDecoder() : crop_layers(false)
+{
+    add_arg_parser_decorator(
+        [](ArgParser &arg_parser)
+        {
+            arg_parser.register_flag({"--psb-crop-layers"})
+                ->set_description(
+                    "Extracts layers as cropped regions instead of "
+                    "compositing them onto the base image");
+        },
+        [&](const ArgParser &arg_parser)
+        {
+            crop_layers = arg_parser.has_flag("psb-crop-layers");
+        });
+}
+
 algo::NamingStrategy PsbImageArchiveDecoder::naming_strategy() const
 {
     return algo::NamingStrategy::Sibling;
@@ -368,6 +384,11 @@ std::unique_ptr<dec::ArchiveMeta> PsbImageArchiveDecoder::read_meta_impl(
                     basic_info.offset_strings_data));
         }
 
+        // cropped layers are emitted as they are, so the base is not needed
+        if (crop_layers)
+            return meta;
+
+        // the base is decoded once and shared by every layer entry
         auto base_image = read_image(logger, *chosen_entry, input_file.stream);
         for (const auto &entry : meta->entries)
         {
@@ -393,7 +414,8 @@ std::unique_ptr<io::File> PsbImageArchiveDecoder::read_file_impl(
 
     if (entry->base_image)
     {
-        auto base_image = std::make_unique<res::Image>(*entry->base_image);
+        auto base_image = std::make_unique<res::Image>(
+            entry->base_image->clone());
         base_image->overlay(
             *image,
             entry->x,
@@ -26,6 +26,9 @@ namespace yuzusoft {
 
     class PsbImageArchiveDecoder final : public BaseArchiveDecoder
     {
+    public:
+        PsbImageArchiveDecoder();
+
     protected:
         bool is_recognized_impl(io::File &input_file) const override;
 
@@ -40,6 +43,9 @@ namespace yuzusoft {
             const ArchiveEntry &e) const override;
 
         algo::NamingStrategy naming_strategy() const override;
+
+    private:
+        bool crop_layers;
     };
 
 } } }
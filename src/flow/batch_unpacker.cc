@@ -0,0 +1,321 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "flow/batch_unpacker.h"
+#include <cctype>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include "arg_parser.h"
+#include "err.h"
+#include "flow/file_saver_callback.h"
+#include "io/file_system.h"
+#include "virtual_file_system.h"
+
+using namespace au;
+using namespace au::flow;
+
+namespace
+{
+    struct InputFile final
+    {
+        io::path path;
+        uoff_t size;
+    };
+
+    // Everything the unpacker refers to while the job runs.
+    struct JobState final
+    {
+        std::unique_ptr<IFileSaver> file_saver;
+        std::unique_ptr<ParallelUnpackerContext> unpacker_context;
+        std::chrono::steady_clock::time_point start_time;
+        size_t input_file_count;
+        uoff_t input_size;
+    };
+}
+
+static std::vector<std::string> split_arguments(const std::string &line)
+{
+    std::vector<std::string> arguments;
+    std::string current;
+    auto in_argument = false;
+    char quote = 0;
+    for (auto it = line.begin(); it != line.end(); ++it)
+    {
+        // single quotes take everything literally
+        if (quote == '\'' && *it != '\'')
+        {
+            current += *it;
+            continue;
+        }
+
+        if (*it == '\\')
+        {
+            if (++it == line.end())
+                throw err::UsageError("Unfinished escape sequence: " + line);
+            current += *it;
+            in_argument = true;
+        }
+        else if (*it == '\'' || *it == '"')
+        {
+            if (!quote)
+                quote = *it;
+            else if (quote == *it)
+                quote = 0;
+            else
+                current += *it;
+            in_argument = true;
+        }
+        else if (!quote && std::isspace(static_cast<u8>(*it)))
+        {
+            if (in_argument)
+                arguments.push_back(current);
+            current.clear();
+            in_argument = false;
+        }
+        else
+        {
+            current += *it;
+            in_argument = true;
+        }
+    }
+
+    if (quote)
+        throw err::UsageError("Unterminated quote: " + line);
+    if (in_argument)
+        arguments.push_back(current);
+    return arguments;
+}
+
+static std::vector<InputFile> collect_input_files(
+    const std::vector<io::path> &input_paths)
+{
+    std::vector<InputFile> input_files;
+    std::set<io::FileIdentity> known_files;
+    const auto add = [&](const io::path &path)
+    {
+        // files that cannot be inspected are left for the task to report
+        if (!io::is_regular_file(path))
+        {
+            input_files.push_back({path, 0});
+            return;
+        }
+        // skip hardlinks and paths that were passed more than once
+        if (known_files.insert(io::file_identity(path)).second)
+            input_files.push_back({path, io::file_size(path)});
+    };
+
+    for (const auto &input_path : input_paths)
+    {
+        if (!io::is_directory(input_path))
+        {
+            add(input_path);
+            continue;
+        }
+        for (const auto &path : io::recursive_directory_range(input_path))
+            if (!io::is_directory(path))
+                add(path);
+    }
+    return input_files;
+}
+
+BatchJob flow::parse_batch_job(const std::string &line)
+{
+    BatchJob job;
+    job.arguments = split_arguments(line);
+
+    ArgParser arg_parser;
+    arg_parser.register_switch({"-o", "--out"});
+    arg_parser.register_switch({"-d", "--dec"});
+    arg_parser.register_flag({"-r", "--rename"});
+    arg_parser.register_flag({"--no-recurse"});
+    arg_parser.parse(job.arguments);
+
+    job.output_dir = arg_parser.has_switch("--out")
+        ? arg_parser.get_switch("--out")
+        : "./";
+    if (arg_parser.has_switch("--dec"))
+        job.decoder = arg_parser.get_switch("--dec");
+    job.overwrite = !arg_parser.has_flag("--rename");
+    job.enable_nested_decoding = !arg_parser.has_flag("--no-recurse");
+
+    for (const auto &stray : arg_parser.get_stray())
+        job.input_paths.push_back(stray);
+    if (job.input_paths.empty())
+        throw err::UsageError("No input paths given: " + line);
+    return job;
+}
+
+BatchUnpackerContext::BatchUnpackerContext(
+    const Logger &logger,
+    const dec::Registry &registry,
+    const std::map<std::string, NestedImagePolicy> &nested_image_policies,
+    const uoff_t readahead_size,
+    const uoff_t memory_budget,
+    const std::vector<std::string> &default_arguments) :
+        logger(logger),
+        registry(registry),
+        nested_image_policies(nested_image_policies),
+        readahead_size(readahead_size),
+        memory_budget(memory_budget),
+        default_arguments(default_arguments)
+{
+}
+
+struct BatchUnpacker::Priv final
+{
+    Priv(const BatchUnpackerContext &context);
+
+    const BatchUnpackerContext &context;
+
+    // the unpacker's own context goes unused, as every job has its own
+    FileSaverCallback unused_file_saver;
+    ParallelUnpackerContext unpacker_context;
+    ParallelUnpacker unpacker;
+
+    std::mutex mutex;
+    std::condition_variable budget_freed;
+    uoff_t used_budget;
+};
+
+BatchUnpacker::Priv::Priv(const BatchUnpackerContext &context) :
+    context(context),
+    unpacker_context(
+        context.logger,
+        unused_file_saver,
+        context.registry,
+        false,
+        {},
+        {},
+        context.nested_image_policies,
+        context.readahead_size),
+    unpacker(unpacker_context),
+    used_budget(0)
+{
+}
+
+BatchUnpacker::BatchUnpacker(const BatchUnpackerContext &context)
+    : p(new Priv(context))
+{
+}
+
+BatchUnpacker::~BatchUnpacker()
+{
+}
+
+void BatchUnpacker::add_job(
+    const BatchJob &job,
+    std::unique_ptr<IFileSaver> file_saver,
+    const BatchJobCallback on_finish)
+{
+    std::set<std::string> decoders_to_check;
+    if (job.decoder.empty())
+    {
+        const auto names = p->context.registry.get_decoder_names();
+        decoders_to_check.insert(names.begin(), names.end());
+    }
+    else if (p->context.registry.has_decoder(job.decoder))
+        decoders_to_check.insert(job.decoder);
+    else
+        throw err::UsageError("Unknown decoder: " + job.decoder);
+
+    const auto input_files = collect_input_files(job.input_paths);
+    const auto state = std::make_shared<JobState>();
+    state->input_file_count = input_files.size();
+    state->input_size = 0;
+    for (const auto &input_file : input_files)
+        state->input_size += input_file.size;
+
+    {
+        std::unique_lock<std::mutex> lock(p->mutex);
+        p->budget_freed.wait(lock, [&]()
+        {
+            return !p->context.memory_budget
+                || !p->used_budget
+                || p->used_budget + state->input_size
+                    <= p->context.memory_budget;
+        });
+        p->used_budget += state->input_size;
+    }
+
+    auto arguments = p->context.default_arguments;
+    arguments.insert(
+        arguments.end(), job.arguments.begin(), job.arguments.end());
+
+    state->file_saver = std::move(file_saver);
+    state->unpacker_context = std::make_unique<ParallelUnpackerContext>(
+        p->context.logger,
+        *state->file_saver,
+        p->context.registry,
+        job.enable_nested_decoding,
+        arguments,
+        decoders_to_check,
+        p->context.nested_image_policies,
+        p->context.readahead_size);
+    state->start_time = std::chrono::steady_clock::now();
+
+    // the callback holds on to the state for as long as the unpacker
+    // keeps the job around
+    auto &parallel_job = p->unpacker.start_job(
+        *state->unpacker_context,
+        [this, state, on_finish](const ParallelJobResult &parallel_result)
+        {
+            BatchJobResult result;
+            result.input_file_count = state->input_file_count;
+            result.input_size = state->input_size;
+            result.success_count = parallel_result.success_count;
+            result.error_count = parallel_result.error_count;
+            result.saved_file_count = parallel_result.saved_file_count;
+            result.duration
+                = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - state->start_time);
+            if (on_finish)
+                on_finish(result);
+
+            // the job counts against the budget until it's reported
+            {
+                std::unique_lock<std::mutex> lock(p->mutex);
+                p->used_budget -= state->input_size;
+            }
+            p->budget_freed.notify_all();
+        });
+
+    for (const auto &input_file : input_files)
+    {
+        const auto input_path = input_file.path;
+        const auto base_name = io::path(input_path)
+            .change_stem(input_path.stem() + "~").name();
+        p->unpacker.add_input_file(
+            parallel_job,
+            base_name,
+            [input_path]()
+            {
+                VirtualFileSystem::register_directory(
+                    io::absolute(input_path).parent());
+                return std::make_shared<io::File>(
+                    io::absolute(input_path), io::FileMode::Read);
+            },
+            input_file.size);
+    }
+    p->unpacker.finish_job(parallel_job);
+}
+
+bool BatchUnpacker::run(
+    const size_t thread_count, const std::function<void()> producer)
+{
+    return p->unpacker.run(thread_count, producer);
+}
@@ -0,0 +1,114 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "dec/registry.h"
+#include "flow/ifile_saver.h"
+#include "flow/parallel_unpacker.h"
+#include "logger.h"
+
+namespace au {
+namespace flow {
+
+    // A single unit of work of a batch, written the same way as a regular
+    // command line: [options] [dec_options] input_path [input_path...],
+    // with --out, --dec, --rename and --no-recurse being understood.
+    struct BatchJob final
+    {
+        std::vector<std::string> arguments;
+        std::vector<io::path> input_paths;
+        io::path output_dir;
+        std::string decoder;
+        bool overwrite;
+        bool enable_nested_decoding;
+    };
+
+    // Splits given line into arguments like a shell would, honoring quotes
+    // and backslashes, and reads the job from them.
+    BatchJob parse_batch_job(const std::string &line);
+
+    struct BatchJobResult final
+    {
+        size_t input_file_count;
+        uoff_t input_size;
+        size_t success_count;
+        size_t error_count;
+        size_t saved_file_count;
+        std::chrono::milliseconds duration;
+    };
+
+    using BatchJobCallback = std::function<void(const BatchJobResult &)>;
+
+    struct BatchUnpackerContext final
+    {
+        BatchUnpackerContext(
+            const Logger &logger,
+            const dec::Registry &registry,
+            const std::map<std::string, NestedImagePolicy>
+                &nested_image_policies,
+            const uoff_t readahead_size,
+            const uoff_t memory_budget,
+            const std::vector<std::string> &default_arguments);
+
+        const Logger &logger;
+        const dec::Registry &registry;
+        const std::map<std::string, NestedImagePolicy> nested_image_policies;
+        const uoff_t readahead_size;
+
+        // caps the total size of input files of the jobs that run at once;
+        // 0 means no limit. Bigger jobs still run, just on their own.
+        const uoff_t memory_budget;
+
+        // passed to the decoders ahead of each job's own arguments, which
+        // take precedence
+        const std::vector<std::string> default_arguments;
+    };
+
+    // Runs any number of jobs with settings of their own on one pool of
+    // workers, so that one job's tail overlaps with the next job's start.
+    class BatchUnpacker final
+    {
+    public:
+        BatchUnpacker(const BatchUnpackerContext &context);
+        ~BatchUnpacker();
+
+        // Waits until the job fits within the memory budget, then queues
+        // it. Must be called while run() is producing: from the producer
+        // or from threads it waits for, as it's the workers that free the
+        // budget. on_finish is called from a worker thread.
+        void add_job(
+            const BatchJob &job,
+            std::unique_ptr<IFileSaver> file_saver,
+            const BatchJobCallback on_finish);
+
+        // Returns once the producer returns and every job it added is done.
+        bool run(
+            const size_t thread_count, const std::function<void()> producer);
+
+    private:
+        struct Priv;
+        std::unique_ptr<Priv> p;
+    };
+
+} }
@@ -17,14 +17,24 @@
 
 #include "flow/cli_facade.h"
 #include <algorithm>
+#include <atomic>
+#include <boost/algorithm/string/trim.hpp>
+#include <cstdio>
 #include <map>
+#include <set>
+#include "algo/format.h"
 #include "algo/range.h"
 #include "algo/str.h"
 #include "arg_parser.h"
+#include "dec/base_image_decoder.h"
+#include "dec/derived_key_cache.h"
 #include "dec/idecoder.h"
 #include "dec/registry.h"
+#include "err.h"
+#include "flow/batch_unpacker.h"
 #include "flow/file_saver_hdd.h"
 #include "flow/parallel_unpacker.h"
+#include "flow/unpack_daemon.h"
 #include "io/file_system.h"
 #include "version.h"
 #include "virtual_file_system.h"
@@ -38,6 +48,9 @@ namespace
     {
         std::string decoder;
         io::path output_dir;
+        io::path key_cache_path;
+        io::path batch_path;
+        io::path daemon_socket_path;
         std::vector<io::path> input_paths;
         bool overwrite;
         bool enable_nested_decoding;
@@ -47,6 +60,9 @@ namespace
         bool should_list_decoders;
         int verbosity = 3;
         unsigned int thread_count;
+        uoff_t readahead_size;
+        uoff_t memory_budget;
+        std::map<std::string, NestedImagePolicy> nested_image_policies;
     };
 }
 
@@ -61,6 +77,9 @@ private:
     void print_decoder_list() const;
     void print_cli_help() const;
     void parse_cli_options();
+    bool run_unpacker() const;
+    bool run_batch() const;
+    bool run_daemon() const;
 
     Logger &logger;
     const std::vector<std::string> arguments;
@@ -70,6 +89,36 @@ private:
     Options options;
 };
 
+static void add_input_file(
+    ParallelUnpacker &unpacker,
+    std::set<io::FileIdentity> &known_files,
+    const io::path &input_path)
+{
+    const auto base_name
+        = io::path(input_path).change_stem(input_path.stem() + "~").name();
+    const auto file_factory = [input_path]()
+    {
+        VirtualFileSystem::register_directory(
+            io::absolute(input_path).parent());
+        return std::make_shared<io::File>(
+            io::absolute(input_path), io::FileMode::Read);
+    };
+
+    // files that cannot be inspected are left for the task to report
+    if (!io::is_regular_file(input_path))
+    {
+        unpacker.add_input_file(base_name, file_factory);
+        return;
+    }
+
+    // skip hardlinks and paths that were passed more than once
+    if (!known_files.insert(io::file_identity(input_path)).second)
+        return;
+
+    unpacker.add_input_file(
+        base_name, file_factory, io::file_size(input_path));
+}
+
 CliFacade::Priv::Priv(Logger &logger, const std::vector<std::string> &arguments)
     : logger(logger), arguments(arguments), registry(dec::Registry::instance())
 {
@@ -113,6 +162,8 @@ R"(  __ _ _   _
  \__,_|\__,_|  the visual novel extractor
 
 Usage: arc_unpacker [options] [dec_options] input_path [input_path...]
+       arc_unpacker [options] --batch=FILE
+       arc_unpacker [options] --daemon=SOCKET
 
 [options] can be:
 
@@ -199,12 +250,65 @@ void CliFacade::Priv::register_cli_options()
     arg_parser.register_flag({"--no-color", "--no-colors"})
         ->set_description("Disables colors in console output.");
 
+    arg_parser.register_flag({"--log-json"})
+        ->set_description(
+            "Logs every line as a JSON object with \"type\", \"prefix\" "
+            "and \"message\" fields, for consumption by other programs.");
+
     arg_parser.register_flag({"--no-recurse"})
         ->set_description("Disables automatic decoding of nested files.");
 
     arg_parser.register_flag({"--no-vfs"})
         ->set_description("Disables virtual file system lookups.");
 
+    arg_parser.register_switch({"--nested-images"})
+        ->set_value_name("DECODER:POLICY,...")
+        ->set_description(
+            "Sets what happens to nested images recognized by given "
+            "DECODER. POLICY can be \"keep\" (saves the original file) "
+            "or \"convert\" (decodes the image and saves it as PNG). "
+            "By default, png/png is kept and other images are converted.");
+
+    arg_parser.register_switch({"--readahead"})
+        ->set_value_name("MIB")
+        ->set_description(
+            "Prefetches archive contents up to MIB mebibytes ahead of the "
+            "files being extracted. Helps with slow disks and network "
+            "shares. Disabled by default.");
+
+    arg_parser.register_switch({"--batch"})
+        ->set_value_name("FILE")
+        ->set_description(
+            "Reads jobs from FILE (standard input if FILE is \"-\"), one "
+            "per line, each written like a regular command line. Input "
+            "paths, --out, --dec, --rename and --no-recurse can only be "
+            "given per job; decoder-specific options given outside the jobs "
+            "are defaults that jobs can override, and other options apply "
+            "to all of them. The jobs share the same worker threads, and a "
+            "result line is printed for each job as it finishes.");
+
+    arg_parser.register_switch({"--memory-budget"})
+        ->set_value_name("MIB")
+        ->set_description(
+            "Holds off further batch jobs while the input files of the jobs "
+            "already running take more than MIB mebibytes in total. "
+            "Unlimited by default.");
+
+    arg_parser.register_switch({"--daemon"})
+        ->set_value_name("SOCKET")
+        ->set_description(
+            "Stays resident and takes jobs from local clients through a Unix "
+            "domain socket at SOCKET, each sent as \"job \" followed by a "
+            "line like in --batch, with absolute input paths and --out. "
+            "Saved files and job results are sent back as they happen. A "
+            "\"stop\" line shuts the daemon down.");
+
+    arg_parser.register_switch({"--key-cache"})
+        ->set_value_name("FILE")
+        ->set_description(
+            "Keeps keys derived from game files (such as executables) in "
+            "FILE, so that subsequent runs don't need to derive them again.");
+
     arg_parser.register_flag({"--version"})
         ->set_description("Shows arc_unpacker version.");
 }
@@ -225,6 +329,9 @@ void CliFacade::Priv::parse_cli_options()
     if (arg_parser.has_flag("--no-color") || arg_parser.has_flag("--no-colors"))
         logger.disable_colors();
 
+    if (arg_parser.has_flag("--log-json"))
+        logger.enable_json();
+
     if (arg_parser.has_switch("-v"))
         options.verbosity = algo::from_string<int>(arg_parser.get_switch("-v"));
     if (arg_parser.has_switch("--verbosity"))
@@ -244,6 +351,32 @@ void CliFacade::Priv::parse_cli_options()
     else
         options.thread_count = 0;
 
+    options.readahead_size = 0;
+    if (arg_parser.has_switch("--readahead"))
+    {
+        const auto value = arg_parser.get_switch("--readahead");
+        const auto size_in_mib = algo::from_string<int>(value);
+        if (size_in_mib < 0)
+            throw err::UsageError("Invalid readahead size: " + value);
+        options.readahead_size = static_cast<uoff_t>(size_in_mib) * 1024 * 1024;
+    }
+
+    options.memory_budget = 0;
+    if (arg_parser.has_switch("--memory-budget"))
+    {
+        const auto value = arg_parser.get_switch("--memory-budget");
+        const auto size_in_mib = algo::from_string<int>(value);
+        if (size_in_mib < 0)
+            throw err::UsageError("Invalid memory budget: " + value);
+        options.memory_budget = static_cast<uoff_t>(size_in_mib) * 1024 * 1024;
+    }
+
+    if (arg_parser.has_switch("--batch"))
+        options.batch_path = arg_parser.get_switch("--batch");
+
+    if (arg_parser.has_switch("--daemon"))
+        options.daemon_socket_path = arg_parser.get_switch("--daemon");
+
     if (arg_parser.has_flag("--no-vfs"))
         VirtualFileSystem::disable();
 
@@ -254,26 +387,213 @@ void CliFacade::Priv::parse_cli_options()
     else
         options.output_dir = "./";
 
+    options.nested_image_policies["png/png"] = NestedImagePolicy::Keep;
+    if (arg_parser.has_switch("--nested-images"))
+    {
+        const auto value = arg_parser.get_switch("--nested-images");
+        for (const auto &item : algo::split(value, ',', false))
+        {
+            const auto parts = algo::split(item, ':', false);
+            if (parts.size() != 2
+                || !registry.has_decoder(parts[0])
+                || (parts[1] != "keep" && parts[1] != "convert"))
+            {
+                throw err::UsageError("Invalid nested image policy: " + item);
+            }
+            const auto decoder = registry.create_decoder(parts[0]);
+            if (!dynamic_cast<const dec::BaseImageDecoder*>(decoder.get()))
+            {
+                throw err::UsageError(
+                    "Nested image policies apply only to image decoders: "
+                    + item);
+            }
+            options.nested_image_policies[parts[0]] = parts[1] == "keep"
+                ? NestedImagePolicy::Keep
+                : NestedImagePolicy::Convert;
+        }
+    }
+
+    if (arg_parser.has_switch("--key-cache"))
+        options.key_cache_path = arg_parser.get_switch("--key-cache");
+
     if (arg_parser.has_switch("-d"))
         options.decoder = arg_parser.get_switch("-d");
     if (arg_parser.has_switch("--dec"))
         options.decoder = arg_parser.get_switch("--dec");
 
     for (const auto &stray : arg_parser.get_stray())
+        options.input_paths.push_back(stray);
+
+    // these come from each job instead
+    if (!options.batch_path.str().empty()
+        || !options.daemon_socket_path.str().empty())
     {
-        if (io::is_directory(stray))
+        if (!options.input_paths.empty())
         {
-            for (const auto &path : io::recursive_directory_range(stray))
-                if (!io::is_directory(path))
-                    options.input_paths.push_back(path);
+            throw err::UsageError(
+                "Input paths cannot be combined with --batch or --daemon: "
+                + options.input_paths[0].str());
         }
-        else
+        for (const auto &name : {"--out", "--dec"})
         {
-            options.input_paths.push_back(stray);
+            if (arg_parser.has_switch(name))
+            {
+                throw err::UsageError(
+                    std::string(name)
+                    + " cannot be combined with --batch or --daemon");
+            }
+        }
+        for (const auto &name : {"--rename", "--no-recurse"})
+        {
+            if (arg_parser.has_flag(name))
+            {
+                throw err::UsageError(
+                    std::string(name)
+                    + " cannot be combined with --batch or --daemon");
+            }
         }
     }
 }
 
+bool CliFacade::Priv::run_unpacker() const
+{
+    const auto name_list = registry.get_decoder_names();
+    const auto available_decoders = options.decoder.empty()
+        ? std::set<std::string>(name_list.begin(), name_list.end())
+        : std::set<std::string>{options.decoder};
+
+    FileSaverHdd file_saver(options.output_dir, options.overwrite);
+    ParallelUnpackerContext context(
+        logger,
+        file_saver,
+        registry,
+        options.enable_nested_decoding,
+        arguments,
+        available_decoders,
+        options.nested_image_policies,
+        options.readahead_size);
+
+    ParallelUnpacker unpacker(context);
+
+    // directories are walked while the workers already process the files
+    // found so far
+    const auto input_producer = [&]()
+    {
+        std::set<io::FileIdentity> known_files;
+        for (const auto &input_path : options.input_paths)
+        {
+            if (!io::is_directory(input_path))
+            {
+                add_input_file(unpacker, known_files, input_path);
+                continue;
+            }
+            for (const auto &path : io::recursive_directory_range(input_path))
+                if (!io::is_directory(path))
+                    add_input_file(unpacker, known_files, path);
+        }
+    };
+
+    return unpacker.run(options.thread_count, input_producer);
+}
+
+bool CliFacade::Priv::run_batch() const
+{
+    const BatchUnpackerContext context(
+        logger,
+        registry,
+        options.nested_image_policies,
+        options.readahead_size,
+        options.memory_budget,
+        arguments);
+    BatchUnpacker batch_unpacker(context);
+
+    std::unique_ptr<io::FileByteStream> batch_stream;
+    if (options.batch_path.str() != "-")
+    {
+        batch_stream = std::make_unique<io::FileByteStream>(
+            options.batch_path, io::FileMode::Read);
+    }
+    const auto read_line = [&](std::string &line)
+    {
+        if (!batch_stream)
+        {
+            line.clear();
+            int c;
+            while ((c = std::fgetc(stdin)) != EOF && c != '\n')
+                line += static_cast<char>(c);
+            return c != EOF || !line.empty();
+        }
+        if (!batch_stream->left())
+            return false;
+        line = batch_stream->read_line().str();
+        return true;
+    };
+
+    // jobs are read as they come, so that the batch can be streamed in
+    std::atomic<bool> all_jobs_accepted(true);
+    const auto job_producer = [&]()
+    {
+        std::string line;
+        size_t line_number = 0;
+        size_t job_number = 0;
+        while (read_line(line))
+        {
+            line_number++;
+            boost::algorithm::trim(line);
+            if (line.empty() || line[0] == '#')
+                continue;
+
+            Logger job_logger(logger);
+            job_logger.set_prefix(algo::format(
+                "[job %d, line %d] ", ++job_number, line_number));
+            try
+            {
+                const auto job = parse_batch_job(line);
+                batch_unpacker.add_job(
+                    job,
+                    std::make_unique<FileSaverHdd>(
+                        job.output_dir, job.overwrite),
+                    [job_logger](const BatchJobResult &result)
+                    {
+                        job_logger.log(
+                            Logger::MessageType::Summary,
+                            "finished in %.02fs: %d input files, "
+                            "%d saved files, %d problems\n",
+                            result.duration.count() / 1000.0,
+                            result.input_file_count,
+                            result.saved_file_count,
+                            result.error_count);
+                    });
+            }
+            catch (const std::exception &e)
+            {
+                job_logger.err("rejected (%s)\n", e.what());
+                all_jobs_accepted = false;
+            }
+        }
+    };
+
+    const auto result = batch_unpacker.run(options.thread_count, job_producer);
+    return result && all_jobs_accepted;
+}
+
+bool CliFacade::Priv::run_daemon() const
+{
+    const BatchUnpackerContext context(
+        logger,
+        registry,
+        options.nested_image_policies,
+        options.readahead_size,
+        options.memory_budget,
+        arguments);
+    UnpackDaemon daemon(context, options.daemon_socket_path);
+    logger.log(
+        Logger::MessageType::Summary,
+        "Listening on %s\n",
+        options.daemon_socket_path.c_str());
+    return daemon.run(options.thread_count);
+}
+
 int CliFacade::Priv::run() const
 {
     if (options.should_show_help)
@@ -294,41 +614,46 @@ int CliFacade::Priv::run() const
         return 0;
     }
 
-    if (options.input_paths.size() < 1)
+    if (options.input_paths.size() < 1
+        && options.batch_path.str().empty()
+        && options.daemon_socket_path.str().empty())
     {
         logger.err("Error: required more arguments.\n\n");
         print_cli_help();
         return 1;
     }
 
-    const auto name_list = registry.get_decoder_names();
-    const auto available_decoders = options.decoder.empty()
-        ? std::set<std::string>(name_list.begin(), name_list.end())
-        : std::set<std::string>{options.decoder};
+    if (!options.key_cache_path.str().empty())
+    {
+        if (!dec::DerivedKeyCache::load(options.key_cache_path))
+        {
+            logger.warn(
+                "Ignoring unreadable key cache: %s\n",
+                options.key_cache_path.c_str());
+        }
+    }
 
-    FileSaverHdd file_saver(options.output_dir, options.overwrite);
-    ParallelUnpackerContext context(
-        logger,
-        file_saver,
-        registry,
-        options.enable_nested_decoding,
-        arguments,
-        available_decoders);
+    bool result;
+    if (!options.daemon_socket_path.str().empty())
+        result = run_daemon();
+    else if (!options.batch_path.str().empty())
+        result = run_batch();
+    else
+        result = run_unpacker();
 
-    ParallelUnpacker unpacker(context);
-    for (const auto &input_path : options.input_paths)
+    if (!options.key_cache_path.str().empty())
     {
-        unpacker.add_input_file(
-            io::path(input_path).change_stem(input_path.stem() + "~").name(),
-            [&]()
-            {
-                VirtualFileSystem::register_directory(
-                    io::absolute(input_path).parent());
-                return std::make_shared<io::File>(
-                    io::absolute(input_path), io::FileMode::Read);
-            });
+        try
+        {
+            dec::DerivedKeyCache::save(options.key_cache_path);
+        }
+        catch (const std::exception &e)
+        {
+            logger.warn("Could not save key cache: %s\n", e.what());
+        }
     }
-    return unpacker.run(options.thread_count) ? 0 : 1;
+
+    return result ? 0 : 1;
 }
 
 CliFacade::CliFacade(Logger &logger, const std::vector<std::string> &arguments)
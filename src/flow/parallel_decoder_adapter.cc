@@ -16,7 +16,10 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "flow/parallel_decoder_adapter.h"
+#include <algorithm>
+#include <limits>
 #include "algo/naming_strategies.h"
+#include "algo/range.h"
 #include "enc/microsoft/wav_audio_encoder.h"
 #include "enc/png/png_image_encoder.h"
 #include "flow/vfs_bridge.h"
@@ -24,6 +27,40 @@
 using namespace au;
 using namespace au::flow;
 
+namespace
+{
+    struct EntryExtent final
+    {
+        uoff_t offset;
+        uoff_t size;
+    };
+}
+
+static EntryExtent get_extent(const dec::ArchiveEntry &entry)
+{
+    if (const auto plain_entry
+        = dynamic_cast<const dec::PlainArchiveEntry*>(&entry))
+    {
+        return {plain_entry->offset, plain_entry->size};
+    }
+    if (const auto compressed_entry
+        = dynamic_cast<const dec::CompressedArchiveEntry*>(&entry))
+    {
+        return {compressed_entry->offset, compressed_entry->size_comp};
+    }
+    // entries with no known location go last, in table order
+    return {std::numeric_limits<uoff_t>::max(), 0};
+}
+
+static void prefetch(
+    io::File &input_file, const uoff_t offset, const uoff_t size)
+{
+    // nested archives live in memory and need no prefetching
+    const auto stream = dynamic_cast<io::FileByteStream*>(&input_file.stream);
+    if (stream && size)
+        stream->prefetch(offset, size);
+}
+
 ParallelDecoderAdapter::ParallelDecoderAdapter(
     const std::shared_ptr<const BaseParallelUnpackingTask> parent_task,
     const std::shared_ptr<io::File> input_file)
@@ -50,19 +87,76 @@ void ParallelDecoderAdapter::visit(const dec::BaseArchiveDecoder &decoder)
         input_file,
         parent_task->base_name);
 
-    for (const auto &entry : meta->entries)
+    // reading the entries in the order they are stored in spares the disk
+    // from seeking back and forth between them
+    std::vector<size_t> order(meta->entries.size());
+    std::vector<EntryExtent> extents;
+    for (const auto i : algo::range(meta->entries.size()))
+    {
+        order[i] = i;
+        extents.push_back(get_extent(*meta->entries[i]));
+    }
+    std::stable_sort(
+        order.begin(),
+        order.end(),
+        [&](const size_t a, const size_t b)
+        {
+            return extents[a].offset < extents[b].offset;
+        });
+
+    // the entries are split into windows spanning readahead_size bytes;
+    // starting to decode one window prefetches the next one
+    const auto readahead_size
+        = parent_task->task_context.unpacker_context.readahead_size;
+    std::vector<EntryExtent> windows;
+    std::vector<size_t> window_starts;
+    if (readahead_size)
+    {
+        for (const auto i : algo::range(order.size()))
+        {
+            const auto &extent = extents[order[i]];
+            if (extent.offset == std::numeric_limits<uoff_t>::max())
+                break;
+            if (windows.empty()
+                || extent.offset + extent.size
+                    > windows.back().offset + readahead_size)
+            {
+                windows.push_back({extent.offset, 0});
+                window_starts.push_back(i);
+            }
+            windows.back().size = std::max(
+                windows.back().size,
+                extent.offset + extent.size - windows.back().offset);
+        }
+        if (!windows.empty())
+            prefetch(*input_file, windows[0].offset, windows[0].size);
+    }
+
+    std::vector<PendingOutputFile> output_files;
+    size_t window_index = 0;
+    for (const auto i : algo::range(order.size()))
     {
-        parent_task->save_file(
-            input_file,
-            [meta, &entry, &decoder, vfs_bridge]
+        const auto &entry = meta->entries[order[i]];
+        EntryExtent next_window = {0, 0};
+        if (window_index < windows.size()
+            && window_starts[window_index] == static_cast<size_t>(i))
+        {
+            window_index++;
+            if (window_index < windows.size())
+                next_window = windows[window_index];
+        }
+
+        output_files.push_back({
+            [meta, &entry, &decoder, vfs_bridge, next_window]
             (io::File &input_file_copy, const Logger &logger)
             {
+                prefetch(input_file_copy, next_window.offset, next_window.size);
                 return decoder.read_file(
                     logger, input_file_copy, *meta, *entry);
             },
-            decoder,
-            entry->path.str());
+            entry->path.str()});
     }
+    parent_task->save_files(input_file, output_files, decoder);
 }
 
 void ParallelDecoderAdapter::visit(const dec::BaseFileDecoder &decoder)
@@ -19,7 +19,9 @@
 #include <chrono>
 #include <set>
 #include <stack>
+#include <thread>
 #include "algo/format.h"
+#include "dec/base_image_decoder.h"
 #include "dec/idecoder.h"
 #include "err.h"
 #include "flow/parallel_decoder_adapter.h"
@@ -27,6 +29,7 @@
 using namespace au;
 using namespace au::flow;
 
+static const bstr png_magic = "\x89PNG"_b;
 static const auto max_depth = 10;
 static int task_count = 0;
 static std::mutex mutex;
@@ -43,7 +46,8 @@ namespace
             const std::set<std::string> &decoders_to_check,
             const InputFileFactory file_factory);
 
-        bool work() const override;
+    protected:
+        bool work_impl() const override;
 
         const InputFileFactory file_factory;
     };
@@ -61,7 +65,8 @@ namespace
             const std::shared_ptr<const dec::IDecoder> origin_decoder,
             const std::string &target_name);
 
-        bool work() const override;
+    protected:
+        bool work_impl() const override;
 
         const std::shared_ptr<io::File> input_file;
         const DecoderFileFactory file_factory;
@@ -78,14 +83,12 @@ static bool save(
         const auto full_path
             = task.task_context.unpacker_context.file_saver.save(file);
         task.logger.success("saved to %s\n", full_path.c_str());
-        task.logger.flush();
         return true;
     }
     catch (const err::IoError &e)
     {
         task.logger.err(
             "error saving (%s)\n", e.what() ? e.what() : "unknown error");
-        task.logger.flush();
         return false;
     }
 }
@@ -118,7 +121,8 @@ static std::shared_ptr<dec::IDecoder> guess_decoder(
     const BaseParallelUnpackingTask &task,
     const std::set<std::string> &decoders_to_check,
     io::File &file,
-    const TaskSourceType source_type)
+    const TaskSourceType source_type,
+    std::string &decoder_name)
 {
     task.logger.info(
         "guessing decoder among %d decoders...\n", decoders_to_check.size());
@@ -134,8 +138,8 @@ static std::shared_ptr<dec::IDecoder> guess_decoder(
 
     if (matching_decoders.size() == 1)
     {
-        task.logger.success(
-            "recognized as %s.\n", matching_decoders.begin()->first.c_str());
+        decoder_name = matching_decoders.begin()->first;
+        task.logger.success("recognized as %s.\n", decoder_name.c_str());
         return matching_decoders.begin()->second;
     }
 
@@ -172,24 +176,65 @@ ParallelUnpackerContext::ParallelUnpackerContext(
     const dec::Registry &registry,
     const bool enable_nested_decoding,
     const std::vector<std::string> &arguments,
-    const std::set<std::string> &decoders_to_check) :
+    const std::set<std::string> &decoders_to_check,
+    const std::map<std::string, NestedImagePolicy> &nested_image_policies,
+    const uoff_t readahead_size) :
         logger(logger),
         file_saver(file_saver),
         registry(registry),
         enable_nested_decoding(enable_nested_decoding),
         arguments(arguments),
-        decoders_to_check(decoders_to_check)
+        decoders_to_check(decoders_to_check),
+        nested_image_policies(nested_image_policies),
+        readahead_size(readahead_size)
 {
 }
 
 ParallelTaskContext::ParallelTaskContext(
     ParallelUnpacker &unpacker,
     const ParallelUnpackerContext &unpacker_context,
-    TaskScheduler &task_scheduler) :
+    TaskScheduler &task_scheduler,
+    const ParallelJobCallback on_finish) :
         unpacker(unpacker),
         unpacker_context(unpacker_context),
-        task_scheduler(task_scheduler)
+        task_scheduler(task_scheduler),
+        on_finish(on_finish),
+        pending_count(0),
+        success_count(0),
+        error_count(0),
+        finished(false),
+        saved_file_count(0)
+{
+}
+
+void ParallelTaskContext::hold()
+{
+    pending_count++;
+}
+
+void ParallelTaskContext::release()
 {
+    if (--pending_count)
+        return;
+    saved_file_count = unpacker_context.file_saver.get_saved_file_count();
+    if (on_finish)
+    {
+        ParallelJobResult result;
+        result.success_count = success_count;
+        result.error_count = error_count;
+        result.saved_file_count = saved_file_count;
+        on_finish(result);
+    }
+    finished = true;
+}
+
+void ParallelTaskContext::finish_task(const bool success)
+{
+    if (success)
+        success_count++;
+    else
+        error_count++;
+    release();
 }
 
 BaseParallelUnpackingTask::BaseParallelUnpackingTask(
@@ -210,6 +255,14 @@ BaseParallelUnpackingTask::BaseParallelUnpackingTask(
     mutex.unlock();
     logger.set_prefix(
         algo::format("[task %d] %s: ", task_id, base_name.c_str()));
+    task_context.hold();
+}
+
+bool BaseParallelUnpackingTask::work() const
+{
+    const auto success = work_impl();
+    task_context.finish_task(success);
+    return success;
 }
 
 size_t BaseParallelUnpackingTask::get_depth() const
@@ -244,6 +297,30 @@ void BaseParallelUnpackingTask::save_file(
             target_name));
 }
 
+void BaseParallelUnpackingTask::save_files(
+    const std::shared_ptr<io::File> input_file,
+    const std::vector<PendingOutputFile> &output_files,
+    const dec::BaseDecoder &origin_decoder) const
+{
+    std::vector<std::shared_ptr<ITask>> tasks;
+    tasks.reserve(output_files.size());
+    for (const auto &output_file : output_files)
+    {
+        tasks.push_back(std::make_shared<ProcessOutputFileTask>(
+            task_context,
+            source_type,
+            base_name,
+            shared_from_this(),
+            source_type == TaskSourceType::InitialUserInput
+                ? std::set<std::string>() : decoders_to_check,
+            input_file,
+            output_file.file_factory,
+            origin_decoder.shared_from_this(),
+            output_file.name));
+    }
+    task_context.task_scheduler.push_front_sequence(tasks);
+}
+
 DecodeInputFileTask::DecodeInputFileTask(
     ParallelTaskContext &task_context,
     const TaskSourceType source_type,
@@ -261,7 +338,7 @@ DecodeInputFileTask::DecodeInputFileTask(
 {
 }
 
-bool DecodeInputFileTask::work() const
+bool DecodeInputFileTask::work_impl() const
 {
     std::shared_ptr<io::File> input_file;
     try
@@ -283,8 +360,9 @@ bool DecodeInputFileTask::work() const
     {
         logger.info("initial recognition...\n");
 
+        std::string decoder_name;
         const auto decoder = guess_decoder(
-            *this, decoders_to_check, *input_file, source_type);
+            *this, decoders_to_check, *input_file, source_type, decoder_name);
 
         if (!decoder)
         {
@@ -293,6 +371,26 @@ bool DecodeInputFileTask::work() const
                 : false;
         }
 
+        // nested images already in a standard format are not worth decoding
+        const auto &policies
+            = task_context.unpacker_context.nested_image_policies;
+        const auto policy_it = policies.find(decoder_name);
+        if (source_type == TaskSourceType::NestedDecoding
+            && policy_it != policies.end()
+            && policy_it->second == NestedImagePolicy::Keep
+            && dynamic_cast<const dec::BaseImageDecoder*>(decoder.get()))
+        {
+            logger.info("keeping original file.\n");
+            input_file->stream.seek(0);
+            if (input_file->stream.left() >= png_magic.size()
+                && input_file->stream.read(png_magic.size()) == png_magic)
+            {
+                input_file->path.change_extension("png");
+            }
+            input_file->stream.seek(0);
+            return save(*this, input_file);
+        }
+
         ArgParser decoder_arg_parser;
         const auto decorators = decoder->get_arg_parser_decorators();
         for (const auto &decorator : decorators)
@@ -337,7 +435,7 @@ ProcessOutputFileTask::ProcessOutputFileTask(
 {
 }
 
-bool ProcessOutputFileTask::work() const
+bool ProcessOutputFileTask::work_impl() const
 {
     logger.info(
         target_name.empty()
@@ -429,6 +527,10 @@ struct ParallelUnpacker::Priv final
     const ParallelUnpackerContext &unpacker_context;
     TaskScheduler task_scheduler;
     ParallelTaskContext task_context;
+
+    std::mutex jobs_mutex;
+    std::vector<std::unique_ptr<ParallelTaskContext>> jobs;
+    size_t finished_job_saved_file_count = 0;
 };
 
 ParallelUnpacker::Priv::Priv(
@@ -462,16 +564,108 @@ void ParallelUnpacker::add_input_file(
             file_factory));
 }
 
-bool ParallelUnpacker::run(const size_t thread_count)
+void ParallelUnpacker::add_input_file(
+    const io::path &base_name,
+    const InputFileFactory file_factory,
+    const uoff_t size)
 {
+    p->task_scheduler.push_weighted(
+        std::make_shared<DecodeInputFileTask>(
+            p->task_context,
+            TaskSourceType::InitialUserInput,
+            base_name,
+            nullptr,
+            p->unpacker_context.decoders_to_check,
+            file_factory),
+        size);
+}
+
+ParallelTaskContext &ParallelUnpacker::start_job(
+    const ParallelUnpackerContext &job_context,
+    const ParallelJobCallback on_finish)
+{
+    auto job = std::make_unique<ParallelTaskContext>(
+        *this, job_context, p->task_scheduler, on_finish);
+    // held until finish_job(), so that the job can't finish while its
+    // input files are still being added
+    job->hold();
+    std::unique_lock<std::mutex> lock(p->jobs_mutex);
+
+    // long-running unpackers may go through any number of jobs
+    for (auto it = p->jobs.begin(); it != p->jobs.end(); )
+    {
+        if (!(*it)->finished)
+        {
+            ++it;
+            continue;
+        }
+        p->finished_job_saved_file_count += (*it)->saved_file_count;
+        it = p->jobs.erase(it);
+    }
+
+    p->jobs.push_back(std::move(job));
+    return *p->jobs.back();
+}
+
+void ParallelUnpacker::add_input_file(
+    ParallelTaskContext &job,
+    const io::path &base_name,
+    const InputFileFactory file_factory,
+    const uoff_t size)
+{
+    p->task_scheduler.push_weighted(
+        std::make_shared<DecodeInputFileTask>(
+            job,
+            TaskSourceType::InitialUserInput,
+            base_name,
+            nullptr,
+            job.unpacker_context.decoders_to_check,
+            file_factory),
+        size);
+}
+
+void ParallelUnpacker::finish_job(ParallelTaskContext &job)
+{
+    job.release();
+}
+
+bool ParallelUnpacker::run(
+    const size_t thread_count, const std::function<void()> input_producer)
+{
+    Logger logger(p->unpacker_context.logger);
+
     const auto begin = std::chrono::steady_clock::now();
+    std::unique_ptr<std::thread> producer_thread;
+    bool producer_failed = false;
+    if (input_producer)
+    {
+        p->task_scheduler.start_producing();
+        producer_thread = std::make_unique<std::thread>([&]()
+        {
+            try
+            {
+                input_producer();
+            }
+            catch (const std::exception &e)
+            {
+                logger.err("error collecting input files (%s)\n", e.what());
+                producer_failed = true;
+            }
+            catch (...)
+            {
+                logger.err("error collecting input files\n");
+                producer_failed = true;
+            }
+            p->task_scheduler.finish_producing();
+        });
+    }
     const auto results = p->task_scheduler.run(thread_count);
+    if (producer_thread)
+        producer_thread->join();
     const auto end = std::chrono::steady_clock::now();
     const auto diff
         = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin);
 
-    Logger logger(p->unpacker_context.logger);
-
     logger.log(
         Logger::MessageType::Summary,
         "Executed %d tasks in %.02fs (",
@@ -490,10 +684,22 @@ bool ParallelUnpacker::run(const size_t thread_count)
         logger.log(Logger::MessageType::Summary, ", ");
     }
 
+    auto saved_file_count
+        = p->unpacker_context.file_saver.get_saved_file_count();
+    {
+        std::unique_lock<std::mutex> lock(p->jobs_mutex);
+        saved_file_count += p->finished_job_saved_file_count;
+        for (const auto &job : p->jobs)
+        {
+            saved_file_count += job->finished
+                ? job->saved_file_count
+                : job->unpacker_context.file_saver.get_saved_file_count();
+        }
+    }
     logger.log(
         Logger::MessageType::Summary,
         "%d saved files)\n",
-        p->unpacker_context.file_saver.get_saved_file_count());
+        saved_file_count);
 
-    return results.error_count == 0;
+    return results.error_count == 0 && !producer_failed;
 }
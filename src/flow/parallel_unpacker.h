@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <set>
@@ -35,6 +36,14 @@ namespace flow {
         NestedDecoding,
     };
 
+    // What happens to nested files recognized by given image decoder.
+    // Policies set for other kinds of decoders are ignored.
+    enum class NestedImagePolicy : u8
+    {
+        Keep, // save the original bytes as-is
+        Convert, // decode the image and re-encode it as PNG
+    };
+
     class ParallelUnpacker;
 
     using InputFileFactory = std::function<std::shared_ptr<io::File>()>;
@@ -49,7 +58,10 @@ namespace flow {
             const dec::Registry &registry,
             const bool enable_nested_decoding,
             const std::vector<std::string> &arguments,
-            const std::set<std::string> &decoders_to_check);
+            const std::set<std::string> &decoders_to_check,
+            const std::map<std::string, NestedImagePolicy>
+                &nested_image_policies,
+            const uoff_t readahead_size);
 
         const Logger &logger;
         const IFileSaver &file_saver;
@@ -57,18 +69,59 @@ namespace flow {
         const bool enable_nested_decoding;
         const std::vector<std::string> arguments;
         const std::set<std::string> decoders_to_check;
+
+        // decoders missing from the map use NestedImagePolicy::Convert
+        const std::map<std::string, NestedImagePolicy> nested_image_policies;
+
+        // how far ahead of the entries being decoded archive contents get
+        // prefetched; 0 disables prefetching
+        const uoff_t readahead_size;
     };
 
+    struct ParallelJobResult final
+    {
+        size_t success_count;
+        size_t error_count;
+        size_t saved_file_count;
+    };
+
+    using ParallelJobCallback = std::function<void(const ParallelJobResult &)>;
+
+    // Shared by all tasks stemming from the same input files. Besides the
+    // default one, each job started with ParallelUnpacker::start_job() gets
+    // its own.
     struct ParallelTaskContext final
     {
         ParallelTaskContext(
             ParallelUnpacker &unpacker,
             const ParallelUnpackerContext &unpacker_context,
-            TaskScheduler &task_scheduler);
+            TaskScheduler &task_scheduler,
+            const ParallelJobCallback on_finish = nullptr);
+
+        // on_finish fires once every hold() is matched by a release().
+        void hold();
+        void release();
+        void finish_task(const bool success);
 
         ParallelUnpacker &unpacker;
         const ParallelUnpackerContext &unpacker_context;
         TaskScheduler &task_scheduler;
+        const ParallelJobCallback on_finish;
+
+        std::atomic<size_t> pending_count;
+        std::atomic<size_t> success_count;
+        std::atomic<size_t> error_count;
+
+        // set once on_finish has returned; from then on unpacker_context
+        // is no longer used and may be gone
+        std::atomic<bool> finished;
+        size_t saved_file_count;
+    };
+
+    struct PendingOutputFile final
+    {
+        DecoderFileFactory file_factory;
+        std::string name;
     };
 
     struct BaseParallelUnpackingTask :
@@ -84,6 +137,7 @@ namespace flow {
 
         virtual ~BaseParallelUnpackingTask() {}
 
+        bool work() const override;
         size_t get_depth() const;
 
         void save_file(
@@ -92,12 +146,22 @@ namespace flow {
             const dec::BaseDecoder &origin_decoder,
             const std::string &custom_name = "") const;
 
+        // Like save_file(), but the files are decoded in given order, with
+        // each worker taking a few consecutive ones at a time.
+        void save_files(
+            const std::shared_ptr<io::File> input_file,
+            const std::vector<PendingOutputFile> &output_files,
+            const dec::BaseDecoder &origin_decoder) const;
+
         Logger logger;
         ParallelTaskContext &task_context;
         const TaskSourceType source_type;
         const io::path base_name;
         const std::shared_ptr<const BaseParallelUnpackingTask> parent_task;
         const std::set<std::string> decoders_to_check;
+
+    protected:
+        virtual bool work_impl() const = 0;
     };
 
     class ParallelUnpacker final
@@ -107,7 +171,34 @@ namespace flow {
         ~ParallelUnpacker();
 
         void add_input_file(const io::path &base_name, const InputFileFactory);
-        bool run(const size_t thread_count = 0);
+
+        // Files with known size are processed largest first, so that a single
+        // big file doesn't extend the tail of the run.
+        void add_input_file(
+            const io::path &base_name,
+            const InputFileFactory,
+            const uoff_t size);
+
+        // Jobs have settings of their own but share the workers with
+        // everything else added to the unpacker. The context must outlive
+        // the unpacker. on_finish is called from a worker thread once all
+        // of the job's tasks, nested ones included, are done, but not
+        // before the job is closed with finish_job().
+        ParallelTaskContext &start_job(
+            const ParallelUnpackerContext &job_context,
+            const ParallelJobCallback on_finish);
+        void add_input_file(
+            ParallelTaskContext &job,
+            const io::path &base_name,
+            const InputFileFactory,
+            const uoff_t size);
+        void finish_job(ParallelTaskContext &job);
+
+        // The producer runs in a separate thread alongside the workers and may
+        // keep adding input files while the earlier ones are being processed.
+        bool run(
+            const size_t thread_count = 0,
+            const std::function<void()> input_producer = nullptr);
 
     private:
         struct Priv;
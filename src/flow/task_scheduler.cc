@@ -16,21 +16,84 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "flow/task_scheduler.h"
+#include <algorithm>
 #include <chrono>
 #include <deque>
+#include <functional>
+#include <map>
 #include <thread>
 #include <vector>
+#include "algo/parallel.h"
 #include "algo/range.h"
+#include "algo/scratch.h"
 
 using namespace au;
 using namespace au::flow;
 
+static const size_t max_run_size = 16;
+
+namespace
+{
+    struct Sequence final
+    {
+        Sequence(const std::vector<std::shared_ptr<ITask>> &tasks);
+
+        std::vector<std::shared_ptr<ITask>> tasks;
+        size_t next_index;
+    };
+}
+
+Sequence::Sequence(const std::vector<std::shared_ptr<ITask>> &tasks) :
+    tasks(tasks),
+    next_index(0)
+{
+}
+
 struct TaskScheduler::Priv final
 {
-    std::deque<std::shared_ptr<ITask>> tasks;
+    std::vector<std::shared_ptr<ITask>> pop_tasks();
+    bool empty() const;
+
+    // single tasks are sequences of one
+    std::deque<std::shared_ptr<Sequence>> sequences;
+    std::multimap<uoff_t, std::shared_ptr<ITask>, std::greater<uoff_t>>
+        weighted_tasks;
     std::vector<std::unique_ptr<std::thread>> threads;
+    size_t producer_count = 0;
+    size_t thread_count = 1;
 };
 
+std::vector<std::shared_ptr<ITask>> TaskScheduler::Priv::pop_tasks()
+{
+    std::vector<std::shared_ptr<ITask>> claimed_tasks;
+    if (!sequences.empty())
+    {
+        // guided self-scheduling: take a share of what is left, so the
+        // runs get shorter towards the end and no worker is left holding
+        // a long one while the others idle
+        auto &sequence = *sequences.front();
+        const auto left = sequence.tasks.size() - sequence.next_index;
+        const auto run_size = std::max<size_t>(
+            1, std::min(max_run_size, left / (2 * thread_count)));
+        const auto begin = sequence.tasks.begin() + sequence.next_index;
+        claimed_tasks.assign(begin, begin + run_size);
+        sequence.next_index += run_size;
+        if (sequence.next_index == sequence.tasks.size())
+            sequences.pop_front();
+    }
+    else if (!weighted_tasks.empty())
+    {
+        claimed_tasks.push_back(weighted_tasks.begin()->second);
+        weighted_tasks.erase(weighted_tasks.begin());
+    }
+    return claimed_tasks;
+}
+
+bool TaskScheduler::Priv::empty() const
+{
+    return sequences.empty() && weighted_tasks.empty();
+}
+
 TaskScheduler::TaskScheduler() : p(new Priv())
 {
 }
@@ -42,13 +105,43 @@ TaskScheduler::~TaskScheduler()
 void TaskScheduler::push_front(std::shared_ptr<ITask> task)
 {
     std::unique_lock<std::mutex> lock(mutex);
-    p->tasks.push_front(task);
+    p->sequences.push_front(std::make_shared<Sequence>(
+        std::vector<std::shared_ptr<ITask>>{task}));
 }
 
 void TaskScheduler::push_back(std::shared_ptr<ITask> task)
 {
     std::unique_lock<std::mutex> lock(mutex);
-    p->tasks.push_back(task);
+    p->sequences.push_back(std::make_shared<Sequence>(
+        std::vector<std::shared_ptr<ITask>>{task}));
+}
+
+void TaskScheduler::push_front_sequence(
+    const std::vector<std::shared_ptr<ITask>> &tasks)
+{
+    if (tasks.empty())
+        return;
+    std::unique_lock<std::mutex> lock(mutex);
+    p->sequences.push_front(std::make_shared<Sequence>(tasks));
+}
+
+void TaskScheduler::push_weighted(
+    std::shared_ptr<ITask> task, const uoff_t weight)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    p->weighted_tasks.emplace(weight, task);
+}
+
+void TaskScheduler::start_producing()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    p->producer_count++;
+}
+
+void TaskScheduler::finish_producing()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    p->producer_count--;
 }
 
 TaskSchedulerResult TaskScheduler::run(size_t number_of_threads)
@@ -57,11 +150,12 @@ TaskSchedulerResult TaskScheduler::run(size_t number_of_threads)
         number_of_threads = std::thread::hardware_concurrency();
     if (!number_of_threads)
         number_of_threads = 1;
+    p->thread_count = number_of_threads;
 
     TaskSchedulerResult result;
     result.success_count = 0;
     result.error_count = 0;
-    bool still_running = true;
+    size_t busy_count = 0;
 
     for (const auto i : algo::range(number_of_threads))
     {
@@ -69,32 +163,40 @@ TaskSchedulerResult TaskScheduler::run(size_t number_of_threads)
         {
             while (true)
             {
-                std::shared_ptr<ITask> task;
+                std::vector<std::shared_ptr<ITask>> claimed_tasks;
 
                 {
                     std::unique_lock<std::mutex> lock(mutex);
-                    if (p->tasks.empty())
+                    if (p->empty())
                     {
-                        if (still_running && number_of_threads > 1)
+                        // running tasks and producers may still add more;
+                        // until they do, help the running tasks instead
+                        if (busy_count || p->producer_count)
                         {
                             lock.unlock();
-                            std::this_thread::sleep_for(
+                            algo::help_parallel_for(
                                 std::chrono::milliseconds(10));
                             continue;
                         }
                         break;
                     }
-                    task = p->tasks.front();
-                    p->tasks.pop_front();
+                    claimed_tasks = p->pop_tasks();
+                    busy_count++;
                 }
 
-                const auto local_success = task->work();
-
+                for (const auto &task : claimed_tasks)
                 {
+                    const auto local_success = task->work();
+                    algo::trim_scratch();
+
                     std::unique_lock<std::mutex> lock(mutex);
                     result.success_count += local_success;
                     result.error_count += !local_success;
-                    still_running = !p->tasks.empty();
+                }
+
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    busy_count--;
                 }
             }
         }));
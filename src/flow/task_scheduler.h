@@ -19,6 +19,8 @@
 
 #include <memory>
 #include <mutex>
+#include <vector>
+#include "types.h"
 
 namespace au {
 namespace flow {
@@ -44,6 +46,24 @@ namespace flow {
         TaskSchedulerResult run(const size_t number_of_threads = 0);
         void push_front(std::shared_ptr<ITask> task);
         void push_back(std::shared_ptr<ITask> task);
+
+        // Queues tasks meant to run in given order, such as reads of
+        // consecutive parts of a single file, ahead of the other tasks.
+        // Workers claim them in runs that shrink as the sequence drains, so
+        // each worker reads a contiguous stretch while the tail still gets
+        // spread across all of them.
+        void push_front_sequence(
+            const std::vector<std::shared_ptr<ITask>> &tasks);
+
+        // Queues a task that runs once the regular queue drains, heaviest
+        // first (longest processing time first scheduling).
+        void push_weighted(std::shared_ptr<ITask> task, const uoff_t weight);
+
+        // While there are active producers, idle workers keep waiting for
+        // new tasks instead of exiting.
+        void start_producing();
+        void finish_producing();
+
         void join();
         std::mutex mutex;
     private:
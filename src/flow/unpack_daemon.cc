@@ -0,0 +1,695 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "flow/unpack_daemon.h"
+#include <atomic>
+#include <boost/algorithm/string/trim.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "algo/format.h"
+#include "err.h"
+#include "flow/file_saver_hdd.h"
+
+#ifndef _WIN32
+    #include <cerrno>
+    #include <poll.h>
+    #include <sys/socket.h>
+    #include <sys/stat.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+#endif
+
+using namespace au;
+using namespace au::flow;
+
+#ifdef _WIN32
+
+    struct UnpackDaemon::Priv final
+    {
+    };
+
+    struct UnpackDaemonClient::Priv final
+    {
+    };
+
+    UnpackDaemon::UnpackDaemon(
+        const BatchUnpackerContext &context, const io::path &socket_path)
+    {
+        throw err::NotSupportedError(
+            "Daemon mode needs Unix domain sockets");
+    }
+
+    bool UnpackDaemon::run(const size_t thread_count)
+    {
+        return false;
+    }
+
+    UnpackDaemonClient::UnpackDaemonClient(const io::path &socket_path)
+    {
+        throw err::NotSupportedError(
+            "Daemon mode needs Unix domain sockets");
+    }
+
+    void UnpackDaemonClient::send(const std::string &request)
+    {
+    }
+
+    void UnpackDaemonClient::finish_sending()
+    {
+    }
+
+    bool UnpackDaemonClient::receive(std::string &response)
+    {
+        return false;
+    }
+
+#else
+
+// how often the daemon checks whether it was told to stop
+static const int poll_interval = 100;
+
+// how far behind on its responses a client may fall before it gets
+// disconnected, in bytes
+static const size_t max_queued_size = 1 << 20;
+
+// how long a stopping daemon waits for clients to take their responses, in
+// milliseconds
+static const int stop_timeout = 2000;
+
+#ifdef MSG_NOSIGNAL
+    // clients that went away must not kill the daemon with SIGPIPE
+    static const int send_flags = MSG_NOSIGNAL;
+#else
+    static const int send_flags = 0;
+#endif
+
+namespace
+{
+    class LineSocket final
+    {
+    public:
+        LineSocket(const int fd);
+        ~LineSocket();
+
+        // Only ever called by a single thread.
+        bool read_line(std::string &line);
+
+        // Only ever called by a single thread. Gives up once should_stop
+        // returns true; it is checked while the peer isn't taking data.
+        bool write_line(
+            const std::string &line, const std::function<bool()> &should_stop);
+        bool write_line(const std::string &line);
+
+        // These can be called from any thread.
+        void shutdown_read();
+        void shutdown_write();
+        void close();
+
+    private:
+        int fd;
+        std::string buffer;
+        std::mutex mutex;
+    };
+
+    // Responses are never written by the threads that produce them: they
+    // get queued and a writer thread owned by the connection sends them,
+    // so a client that doesn't read can't hold up the workers.
+    class Connection final
+    {
+    public:
+        Connection(const int fd, const std::atomic<bool> &stopping);
+
+        // These can be called from any thread.
+        void send(const std::string &line);
+        void start_job();
+        void finish_job();
+        void finish_reading();
+
+        // Sends the queued responses until the client is done sending, all
+        // its jobs have finished and their responses are out, or the
+        // client falls too far behind.
+        void write_lines();
+
+        LineSocket socket;
+
+    private:
+        void drop();
+
+        const std::atomic<bool> &stopping;
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::deque<std::string> queued_lines;
+        size_t queued_size;
+        size_t running_job_count;
+        bool reading_finished;
+        bool dropped;
+    };
+
+    // Reports every saved file back to the client.
+    class ReportingFileSaver final : public IFileSaver
+    {
+    public:
+        ReportingFileSaver(
+            const std::shared_ptr<Connection> connection,
+            const size_t job_number,
+            const BatchJob &job);
+
+        io::path save(std::shared_ptr<io::File> file) const override;
+        size_t get_saved_file_count() const override;
+
+    private:
+        const std::shared_ptr<Connection> connection;
+        const size_t job_number;
+        const FileSaverHdd file_saver;
+    };
+}
+
+LineSocket::LineSocket(const int fd) : fd(fd)
+{
+}
+
+LineSocket::~LineSocket()
+{
+    close();
+}
+
+bool LineSocket::read_line(std::string &line)
+{
+    while (true)
+    {
+        const auto pos = buffer.find('\n');
+        if (pos != std::string::npos)
+        {
+            line = buffer.substr(0, pos);
+            buffer.erase(0, pos + 1);
+            return true;
+        }
+
+        char chunk[4096];
+        const auto ret = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0)
+        {
+            // an unterminated last line still counts
+            if (buffer.empty())
+                return false;
+            line = buffer;
+            buffer.clear();
+            return true;
+        }
+        buffer.append(chunk, ret);
+    }
+}
+
+bool LineSocket::write_line(
+    const std::string &line, const std::function<bool()> &should_stop)
+{
+    const auto data = line + "\n";
+    size_t written = 0;
+    while (written < data.size())
+    {
+        pollfd poll_fd;
+        poll_fd.fd = fd;
+        poll_fd.events = POLLOUT;
+        const auto ready = ::poll(&poll_fd, 1, poll_interval);
+        if (ready < 0 && errno != EINTR)
+            return false;
+        if (ready <= 0)
+        {
+            if (should_stop())
+                return false;
+            continue;
+        }
+
+        const auto ret = ::send(
+            fd,
+            data.data() + written,
+            data.size() - written,
+            send_flags | MSG_DONTWAIT);
+        if (ret < 0
+            && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            continue;
+        }
+        if (ret <= 0)
+            return false;
+        written += ret;
+    }
+    return true;
+}
+
+bool LineSocket::write_line(const std::string &line)
+{
+    return write_line(line, []() { return false; });
+}
+
+void LineSocket::shutdown_read()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fd != -1)
+        ::shutdown(fd, SHUT_RD);
+}
+
+void LineSocket::shutdown_write()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fd != -1)
+        ::shutdown(fd, SHUT_WR);
+}
+
+void LineSocket::close()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fd != -1)
+        ::close(fd);
+    fd = -1;
+}
+
+Connection::Connection(const int fd, const std::atomic<bool> &stopping) :
+        socket(fd),
+        stopping(stopping),
+        queued_size(0),
+        running_job_count(0),
+        reading_finished(false),
+        dropped(false)
+{
+}
+
+void Connection::send(const std::string &line)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (dropped)
+            return;
+        queued_size += line.size();
+        queued_lines.push_back(line);
+        if (queued_size > max_queued_size)
+            drop();
+    }
+    changed.notify_all();
+}
+
+void Connection::start_job()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    running_job_count++;
+}
+
+void Connection::finish_job()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running_job_count--;
+    }
+    changed.notify_all();
+}
+
+void Connection::finish_reading()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        reading_finished = true;
+    }
+    changed.notify_all();
+}
+
+void Connection::write_lines()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        changed.wait(lock, [&]()
+        {
+            return dropped
+                || !queued_lines.empty()
+                || (reading_finished && !running_job_count);
+        });
+        if (dropped || queued_lines.empty())
+            break;
+
+        const auto line = queued_lines.front();
+        queued_lines.pop_front();
+        queued_size -= line.size();
+        lock.unlock();
+
+        // once the daemon stops, the client gets a little while to take
+        // what is left before it is given up on
+        bool stop_noticed = false;
+        std::chrono::steady_clock::time_point stop_time;
+        const auto sent = socket.write_line(line, [&]()
+        {
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                if (dropped)
+                    return true;
+            }
+            if (!stopping)
+                return false;
+            const auto now = std::chrono::steady_clock::now();
+            if (!stop_noticed)
+            {
+                stop_noticed = true;
+                stop_time = now;
+            }
+            return now - stop_time > std::chrono::milliseconds(stop_timeout);
+        });
+
+        lock.lock();
+        if (!sent)
+            drop();
+    }
+    lock.unlock();
+
+    // a dropped client gets no more responses, so its further requests
+    // aren't worth reading
+    socket.shutdown_read();
+}
+
+// Needs the mutex to be held.
+void Connection::drop()
+{
+    dropped = true;
+    queued_lines.clear();
+    queued_size = 0;
+}
+
+ReportingFileSaver::ReportingFileSaver(
+    const std::shared_ptr<Connection> connection,
+    const size_t job_number,
+    const BatchJob &job) :
+        connection(connection),
+        job_number(job_number),
+        file_saver(job.output_dir, job.overwrite)
+{
+}
+
+io::path ReportingFileSaver::save(std::shared_ptr<io::File> file) const
+{
+    const auto path = file_saver.save(file);
+    connection->send(algo::format("%d saved %s", job_number, path.c_str()));
+    return path;
+}
+
+size_t ReportingFileSaver::get_saved_file_count() const
+{
+    return file_saver.get_saved_file_count();
+}
+
+static std::string to_single_line(std::string text)
+{
+    for (auto &c : text)
+        if (c == '\n' || c == '\r')
+            c = ' ';
+    return text;
+}
+
+static sockaddr_un make_address(const io::path &socket_path)
+{
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socket_path.str().size() >= sizeof(address.sun_path))
+        throw err::IoError("Socket path is too long: " + socket_path.str());
+    std::memcpy(
+        address.sun_path, socket_path.c_str(), socket_path.str().size());
+    return address;
+}
+
+// Returns -1 if nobody listens on given path.
+static int connect_socket(const io::path &socket_path)
+{
+    const auto address = make_address(socket_path);
+    const auto fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1)
+        throw err::IoError("Could not create socket");
+    const auto ret = ::connect(
+        fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+    if (ret != 0)
+    {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int listen_socket(const io::path &socket_path)
+{
+    const auto other_fd = connect_socket(socket_path);
+    if (other_fd != -1)
+    {
+        ::close(other_fd);
+        throw err::IoError(
+            "Another daemon is listening on " + socket_path.str());
+    }
+
+    // a socket nobody answers on is a leftover of a daemon that crashed
+    struct stat info;
+    if (::lstat(socket_path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode))
+        ::unlink(socket_path.c_str());
+
+    const auto address = make_address(socket_path);
+    const auto fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1)
+        throw err::IoError("Could not create socket");
+    // jobs write wherever the daemon's user can, so only that user gets to
+    // connect; nobody can before listen() anyway
+    if (::bind(
+            fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address))
+        || ::chmod(socket_path.c_str(), S_IRUSR | S_IWUSR)
+        || ::listen(fd, SOMAXCONN))
+    {
+        ::close(fd);
+        throw err::IoError("Could not listen on " + socket_path.str());
+    }
+    return fd;
+}
+
+// The daemon's working directory means nothing to its clients, so jobs must
+// not depend on it.
+static void check_paths(const BatchJob &job)
+{
+    if (!job.output_dir.is_absolute())
+    {
+        throw err::UsageError(
+            "Output directory must be absolute: " + job.output_dir.str());
+    }
+    for (const auto &input_path : job.input_paths)
+    {
+        if (!input_path.is_absolute())
+        {
+            throw err::UsageError(
+                "Input path must be absolute: " + input_path.str());
+        }
+    }
+}
+
+struct UnpackDaemon::Priv final
+{
+    Priv(const BatchUnpackerContext &context, const io::path &socket_path);
+    ~Priv();
+
+    void accept_clients();
+    void serve_client(const std::shared_ptr<Connection> connection);
+
+    const io::path socket_path;
+    const int listen_fd;
+    BatchUnpacker batch_unpacker;
+    std::atomic<bool> stopping;
+
+    std::mutex clients_mutex;
+    std::condition_variable client_gone;
+    std::vector<std::weak_ptr<Connection>> connections;
+    size_t client_count;
+};
+
+UnpackDaemon::Priv::Priv(
+    const BatchUnpackerContext &context, const io::path &socket_path) :
+        socket_path(socket_path),
+        listen_fd(listen_socket(socket_path)),
+        batch_unpacker(context),
+        stopping(false),
+        client_count(0)
+{
+}
+
+UnpackDaemon::Priv::~Priv()
+{
+    ::close(listen_fd);
+    ::unlink(socket_path.c_str());
+}
+
+void UnpackDaemon::Priv::accept_clients()
+{
+    while (!stopping)
+    {
+        pollfd poll_fd;
+        poll_fd.fd = listen_fd;
+        poll_fd.events = POLLIN;
+        if (::poll(&poll_fd, 1, poll_interval) <= 0)
+            continue;
+        const auto client_fd = ::accept(listen_fd, nullptr, nullptr);
+        if (client_fd == -1)
+            continue;
+
+        const auto connection
+            = std::make_shared<Connection>(client_fd, stopping);
+        {
+            std::lock_guard<std::mutex> lock(clients_mutex);
+            for (auto it = connections.begin(); it != connections.end(); )
+                it = it->expired() ? connections.erase(it) : it + 1;
+            connections.push_back(connection);
+            client_count++;
+        }
+        std::thread([this, connection]()
+        {
+            serve_client(connection);
+            std::lock_guard<std::mutex> lock(clients_mutex);
+            client_count--;
+            client_gone.notify_all();
+        }).detach();
+    }
+
+    // idle clients would otherwise keep the daemon around forever; the
+    // jobs they already sent still run to completion
+    std::unique_lock<std::mutex> lock(clients_mutex);
+    for (const auto &connection : connections)
+        if (const auto live_connection = connection.lock())
+            live_connection->socket.shutdown_read();
+    client_gone.wait(lock, [&]() { return !client_count; });
+}
+
+void UnpackDaemon::Priv::serve_client(
+    const std::shared_ptr<Connection> connection)
+{
+    std::thread writer_thread([connection]() { connection->write_lines(); });
+
+    std::string request;
+    size_t job_number = 0;
+    while (connection->socket.read_line(request))
+    {
+        boost::algorithm::trim(request);
+        if (request.empty())
+            continue;
+        if (request == "stop")
+        {
+            stopping = true;
+            continue;
+        }
+
+        const auto number = ++job_number;
+        if (request.compare(0, 4, "job ") != 0)
+        {
+            connection->send(
+                algo::format("%d rejected Unknown request", number));
+            continue;
+        }
+
+        connection->start_job();
+        try
+        {
+            const auto job = parse_batch_job(request.substr(4));
+            check_paths(job);
+            batch_unpacker.add_job(
+                job,
+                std::make_unique<ReportingFileSaver>(connection, number, job),
+                [connection, number](const BatchJobResult &result)
+                {
+                    connection->send(algo::format(
+                        "%d finished %d %d %d",
+                        number,
+                        result.saved_file_count,
+                        result.error_count,
+                        static_cast<int>(result.duration.count())));
+                    connection->finish_job();
+                });
+        }
+        catch (const std::exception &e)
+        {
+            connection->send(algo::format(
+                "%d rejected %s", number, to_single_line(e.what()).c_str()));
+            connection->finish_job();
+        }
+    }
+
+    connection->finish_reading();
+    writer_thread.join();
+    connection->socket.close();
+}
+
+UnpackDaemon::UnpackDaemon(
+    const BatchUnpackerContext &context, const io::path &socket_path)
+        : p(new Priv(context, socket_path))
+{
+}
+
+bool UnpackDaemon::run(const size_t thread_count)
+{
+    return p->batch_unpacker.run(
+        thread_count, [&]() { p->accept_clients(); });
+}
+
+struct UnpackDaemonClient::Priv final
+{
+    Priv(const int fd);
+
+    LineSocket socket;
+};
+
+UnpackDaemonClient::Priv::Priv(const int fd) : socket(fd)
+{
+}
+
+UnpackDaemonClient::UnpackDaemonClient(const io::path &socket_path)
+{
+    const auto fd = connect_socket(socket_path);
+    if (fd == -1)
+        throw err::IoError("Could not connect to " + socket_path.str());
+    p.reset(new Priv(fd));
+}
+
+void UnpackDaemonClient::send(const std::string &request)
+{
+    if (!p->socket.write_line(request))
+        throw err::IoError("Could not send request");
+}
+
+void UnpackDaemonClient::finish_sending()
+{
+    p->socket.shutdown_write();
+}
+
+bool UnpackDaemonClient::receive(std::string &response)
+{
+    return p->socket.read_line(response);
+}
+
+#endif
+
+UnpackDaemon::~UnpackDaemon()
+{
+}
+
+UnpackDaemonClient::~UnpackDaemonClient()
+{
+}
@@ -0,0 +1,82 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include "flow/batch_unpacker.h"
+
+namespace au {
+namespace flow {
+
+    // Keeps arc_unpacker resident, taking jobs from local clients over a
+    // Unix domain socket, so that the decoder registry, derived keys and
+    // page cache stay warm between them. All jobs share one pool of
+    // workers and one memory budget, as in batch mode. Only the daemon's
+    // own user may connect.
+    //
+    // The protocol is line based. Clients send "job ARGUMENTS", with the
+    // arguments written like a batch line, or "stop" to have the daemon
+    // exit once the running jobs finish. Input paths and --out must be
+    // absolute. The daemon answers with lines that start with the job's
+    // number within the connection:
+    //
+    //     N saved PATH                      for every file, as it's saved
+    //     N finished SAVED PROBLEMS MS      once the job is done
+    //     N rejected REASON                 for malformed jobs
+    //
+    // A connection is closed once the client is done sending and all of
+    // its jobs have finished. Clients that don't keep up with reading their
+    // responses get disconnected instead of holding up the workers.
+    class UnpackDaemon final
+    {
+    public:
+        // Clients can connect as soon as this returns.
+        UnpackDaemon(
+            const BatchUnpackerContext &context, const io::path &socket_path);
+        ~UnpackDaemon();
+
+        // Serves clients until one of them sends "stop".
+        bool run(const size_t thread_count);
+
+    private:
+        struct Priv;
+        std::unique_ptr<Priv> p;
+    };
+
+    // Bare-bones client of the above.
+    class UnpackDaemonClient final
+    {
+    public:
+        UnpackDaemonClient(const io::path &socket_path);
+        ~UnpackDaemonClient();
+
+        void send(const std::string &request);
+
+        // Tells the daemon that no more requests follow.
+        void finish_sending();
+
+        // Returns false once the daemon closes the connection.
+        bool receive(std::string &response);
+
+    private:
+        struct Priv;
+        std::unique_ptr<Priv> p;
+    };
+
+} }
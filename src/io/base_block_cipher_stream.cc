@@ -0,0 +1,246 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "io/base_block_cipher_stream.h"
+#include <cstring>
+#include <list>
+#include <unordered_map>
+#include "err.h"
+
+using namespace au;
+using namespace au::io;
+
+static const size_t cache_size = 256 * 1024;
+static const size_t max_readahead_size = 64 * 1024;
+
+namespace
+{
+    struct CachedBlock final
+    {
+        uoff_t offset;
+        bstr data;
+    };
+}
+
+struct BaseBlockCipherStream::Priv final
+{
+    Priv(
+        const BaseBlockCipherStream &stream,
+        BaseByteStream &parent_stream,
+        const size_t block_size,
+        const uoff_t offset,
+        const uoff_t size);
+
+    bool is_cached(const uoff_t block_offset) const;
+    const CachedBlock &get_block(const uoff_t block_offset);
+    void cache_block(const uoff_t block_offset, const u8 *data, size_t size);
+
+    const BaseBlockCipherStream &stream;
+    std::unique_ptr<BaseByteStream> parent_stream;
+    const size_t block_size;
+    const size_t max_cached_blocks;
+    const size_t max_readahead_blocks;
+    const uoff_t offset;
+    const uoff_t size;
+    uoff_t pos;
+
+    // most recently used blocks come first
+    std::list<CachedBlock> blocks;
+    std::unordered_map<uoff_t, std::list<CachedBlock>::iterator> block_map;
+    uoff_t next_sequential_offset;
+    size_t readahead_blocks;
+};
+
+BaseBlockCipherStream::Priv::Priv(
+    const BaseBlockCipherStream &stream,
+    BaseByteStream &parent_stream,
+    const size_t block_size,
+    const uoff_t offset,
+    const uoff_t size) :
+        stream(stream),
+        parent_stream(parent_stream.clone()),
+        block_size(block_size),
+        max_cached_blocks(std::max<size_t>(cache_size / block_size, 1)),
+        max_readahead_blocks(
+            std::max<size_t>(max_readahead_size / block_size, 1)),
+        offset(offset),
+        size(size),
+        pos(0),
+        next_sequential_offset(offset),
+        readahead_blocks(1)
+{
+}
+
+bool BaseBlockCipherStream::Priv::is_cached(const uoff_t block_offset) const
+{
+    return block_map.find(block_offset) != block_map.end();
+}
+
+void BaseBlockCipherStream::Priv::cache_block(
+    const uoff_t block_offset, const u8 *data, const size_t size)
+{
+    if (blocks.size() < max_cached_blocks)
+        blocks.emplace_front();
+    else
+    {
+        // recycle the least recently used block along with its buffer
+        blocks.splice(blocks.begin(), blocks, std::prev(blocks.end()));
+        block_map.erase(blocks.front().offset);
+    }
+    auto &block = blocks.front();
+    block.offset = block_offset;
+    block.data.resize(size);
+    std::memcpy(block.data.get<u8>(), data, size);
+    block_map[block_offset] = blocks.begin();
+}
+
+const CachedBlock &BaseBlockCipherStream::Priv::get_block(
+    const uoff_t block_offset)
+{
+    const auto it = block_map.find(block_offset);
+    if (it != block_map.end())
+    {
+        blocks.splice(blocks.begin(), blocks, it->second);
+        return blocks.front();
+    }
+
+    readahead_blocks = block_offset == next_sequential_offset
+        ? std::min(readahead_blocks * 2, max_readahead_blocks)
+        : 1;
+
+    const auto window_end = offset + size;
+    const auto end = std::min<uoff_t>(
+        parent_stream->size(),
+        std::min<uoff_t>(
+            block_offset + readahead_blocks * block_size,
+            window_end + block_size - 1 - (window_end - 1) % block_size));
+    if (end <= block_offset)
+        throw err::EofError();
+
+    auto chunk = parent_stream->seek(block_offset).read(end - block_offset);
+    stream.decrypt_blocks(block_offset, chunk.get<u8>(), chunk.size());
+
+    // insert backwards so that the requested block ends up in front
+    auto chunk_offset = (chunk.size() - 1) / block_size * block_size;
+    while (true)
+    {
+        cache_block(
+            block_offset + chunk_offset,
+            chunk.get<const u8>() + chunk_offset,
+            std::min<size_t>(block_size, chunk.size() - chunk_offset));
+        if (!chunk_offset)
+            break;
+        chunk_offset -= block_size;
+    }
+    next_sequential_offset = end;
+    return blocks.front();
+}
+
+BaseBlockCipherStream::BaseBlockCipherStream(
+    BaseByteStream &parent_stream,
+    const size_t block_size,
+    const uoff_t offset,
+    const uoff_t size)
+    : p(new Priv(*this, parent_stream, block_size, offset, size))
+{
+}
+
+BaseBlockCipherStream::~BaseBlockCipherStream()
+{
+}
+
+BaseByteStream &BaseBlockCipherStream::get_parent_stream() const
+{
+    return *p->parent_stream;
+}
+
+uoff_t BaseBlockCipherStream::get_offset() const
+{
+    return p->offset;
+}
+
+void BaseBlockCipherStream::seek_impl(const uoff_t offset)
+{
+    if (offset > p->size)
+        throw err::EofError();
+    p->pos = offset;
+}
+
+void BaseBlockCipherStream::read_impl(void *destination, const size_t size)
+{
+    if (p->pos + size > p->size)
+        throw err::EofError();
+
+    auto destination_ptr = static_cast<u8*>(destination);
+    auto position = p->offset + p->pos;
+    auto left = size;
+    while (left)
+    {
+        const auto block_offset = position - position % p->block_size;
+        const auto block_pos = position - block_offset;
+
+        // bulk reads of whole blocks are decrypted straight into the
+        // destination buffer rather than evicting the whole cache
+        if (!block_pos && left >= p->block_size && !p->is_cached(position))
+        {
+            const auto chunk_size = left - left % p->block_size;
+            const auto chunk = p->parent_stream->seek(position).read(
+                chunk_size);
+            std::memcpy(destination_ptr, chunk.get<const u8>(), chunk_size);
+            decrypt_blocks(position, destination_ptr, chunk_size);
+            p->next_sequential_offset = position + chunk_size;
+            destination_ptr += chunk_size;
+            position += chunk_size;
+            left -= chunk_size;
+            continue;
+        }
+
+        const auto &block = p->get_block(block_offset);
+        if (block_pos >= block.data.size())
+            throw err::EofError();
+        const auto chunk_size
+            = std::min<size_t>(left, block.data.size() - block_pos);
+        std::memcpy(
+            destination_ptr,
+            block.data.get<const u8>() + block_pos,
+            chunk_size);
+        destination_ptr += chunk_size;
+        position += chunk_size;
+        left -= chunk_size;
+    }
+    p->pos += size;
+}
+
+void BaseBlockCipherStream::write_impl(const void *source, const size_t size)
+{
+    throw err::NotSupportedError("Not implemented");
+}
+
+uoff_t BaseBlockCipherStream::pos() const
+{
+    return p->pos;
+}
+
+uoff_t BaseBlockCipherStream::size() const
+{
+    return p->size;
+}
+
+void BaseBlockCipherStream::resize_impl(const uoff_t new_size)
+{
+    throw err::NotSupportedError("Not implemented");
+}
@@ -0,0 +1,65 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <memory>
+#include "io/base_byte_stream.h"
+
+namespace au {
+namespace io {
+
+    // Read-only view of a parent stream encrypted in fixed-size blocks.
+    // Recently decrypted blocks are cached, and sequential misses read ahead
+    // progressively more blocks, so that small reads don't decrypt the same
+    // block over and over. Blocks are aligned to the start of the parent
+    // stream, not to the window exposed by this stream.
+    class BaseBlockCipherStream : public BaseByteStream
+    {
+    public:
+        virtual ~BaseBlockCipherStream() = 0;
+
+        uoff_t size() const override;
+        uoff_t pos() const override;
+
+    protected:
+        BaseBlockCipherStream(
+            BaseByteStream &parent_stream,
+            const size_t block_size,
+            const uoff_t offset,
+            const uoff_t size);
+
+        // Decrypts consecutive blocks in place. offset is the position of
+        // the first block within the parent stream; size is a multiple of
+        // the block size unless the data ends at the parent stream's EOF.
+        virtual void decrypt_blocks(
+            const uoff_t offset, u8 *data, const size_t size) const = 0;
+
+        BaseByteStream &get_parent_stream() const;
+        uoff_t get_offset() const;
+
+        void read_impl(void *destination, const size_t size) override;
+        void write_impl(const void *source, const size_t size) override;
+        void seek_impl(const uoff_t offset) override;
+        void resize_impl(const uoff_t new_size) override;
+
+    private:
+        struct Priv;
+        std::unique_ptr<Priv> p;
+    };
+
+} }
@@ -72,13 +72,25 @@ BaseByteStream &BaseByteStream::write(io::BaseByteStream &other_stream)
 
 BaseByteStream &BaseByteStream::write(
     io::BaseByteStream &other_stream, const size_t size)
+{
+    return write(other_stream, size, nullptr);
+}
+
+BaseByteStream &BaseByteStream::write(
+    io::BaseByteStream &other_stream,
+    const size_t size,
+    const std::function<void(const u8 *chunk, const size_t size)> &on_chunk)
 {
     const auto buffer_size = 16 * 1024;
+    bstr buffer(std::min<size_t>(buffer_size, size));
     size_t left = size;
-    for (const auto i : algo::range(0, size, buffer_size))
+    while (left)
     {
         const auto bytes_to_transcribe = std::min<size_t>(buffer_size, left);
-        write(other_stream.read(bytes_to_transcribe));
+        other_stream.read_impl(buffer.get<u8>(), bytes_to_transcribe);
+        if (on_chunk)
+            on_chunk(buffer.get<const u8>(), bytes_to_transcribe);
+        write_impl(buffer.get<const u8>(), bytes_to_transcribe);
         left -= bytes_to_transcribe;
     }
     return *this;
@@ -64,6 +64,13 @@ namespace io {
             return ret;
         }
 
+        // Reads into an existing buffer rather than allocating a new one.
+        void read(u8 *destination, const size_t bytes)
+        {
+            if (bytes)
+                read_impl(destination, bytes);
+        }
+
         template<typename T> T read()
         {
             static_assert(
@@ -117,6 +124,14 @@ namespace io {
         io::BaseByteStream &write(
             io::BaseByteStream &other_stream, const size_t size);
 
+        // Same as above, but hands every chunk to given function on its way
+        // through, e.g. to checksum the data without a second pass over it.
+        io::BaseByteStream &write(
+            io::BaseByteStream &other_stream,
+            const size_t size,
+            const std::function<void(const u8 *chunk, const size_t size)>
+                &on_chunk);
+
         io::BaseByteStream &write_zero_padded(
             const bstr &bytes, const size_t target_size);
 
@@ -16,41 +16,160 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "io/file_byte_stream.h"
+#include <algorithm>
 #include <cstdio>
+#include <cstring>
 #include "algo/locale.h"
 #include "err.h"
 
 #if _WIN32
     #include <fcntl.h>
     #include <io.h>
+    #include <mutex>
     #include <sys/stat.h>
     #include <sys/types.h>
+#else
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
 #endif
 
 using namespace au;
 using namespace au::io;
 
-struct FileByteStream::Priv final
+// Small reads, such as headers read field by field, are served from a
+// per-stream buffer; anything bigger goes straight to the file.
+static const size_t read_buffer_size = 16 * 1024;
+static const size_t max_buffered_read_size = 256;
+
+namespace
 {
-    #if _WIN32
-        Priv(const path &path, FileMode mode) : path(path), mode(mode)
+    // Read-only file handle shared by a stream and all of its clones.
+    // Reads are positional, so there is no file cursor to fight over and
+    // the clones can be used from different threads at once.
+    class SharedReadHandle final
+    {
+    public:
+        SharedReadHandle(const io::path &path);
+        ~SharedReadHandle();
+
+        uoff_t size() const;
+        void read(
+            const uoff_t offset, void *destination, const size_t size) const;
+        void prefetch(const uoff_t offset, const uoff_t size) const;
+
+    private:
+        int fd;
+        uoff_t file_size;
+        #if _WIN32
+            // there is no pread(), so seeking and reading must go together
+            mutable std::mutex mutex;
+        #endif
+    };
+}
+
+#if _WIN32
+    SharedReadHandle::SharedReadHandle(const io::path &path)
+    {
+        fd = _wopen(path.wstr().c_str(), _O_RDONLY | _O_BINARY);
+        if (fd == -1)
+            throw err::FileNotFoundError("Could not open " + path.str());
+        file_size = _lseeki64(fd, 0, SEEK_END);
+    }
+
+    SharedReadHandle::~SharedReadHandle()
+    {
+        _close(fd);
+    }
+
+    void SharedReadHandle::read(
+        const uoff_t offset, void *destination, const size_t size) const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        _lseeki64(fd, offset, SEEK_SET);
+        auto output = static_cast<u8*>(destination);
+        auto left = size;
+        while (left)
         {
-            fd = _wopen(
-                path.wstr().c_str(),
-                (mode == FileMode::Write
-                    ? (_O_RDWR | _O_CREAT | _O_TRUNC)
-                    : _O_RDONLY)
-                | _O_BINARY,
-                _S_IREAD | _S_IWRITE);
-            if (fd == -1)
-                throw err::FileNotFoundError("Could not open " + path.str());
+            const auto chunk = std::min<size_t>(left, 0x40000000);
+            const auto ret = _read(fd, output, chunk);
+            if (ret <= 0)
+                throw err::EofError();
+            output += ret;
+            left -= ret;
         }
+    }
 
-        ~Priv()
+    void SharedReadHandle::prefetch(
+        const uoff_t offset, const uoff_t size) const
+    {
+    }
+#else
+    SharedReadHandle::SharedReadHandle(const io::path &path)
+    {
+        fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1)
+            throw err::FileNotFoundError("Could not open " + path.str());
+        struct stat info;
+        if (fstat(fd, &info) != 0)
         {
-            _close(fd);
+            ::close(fd);
+            throw err::IoError("Could not stat " + path.str());
+        }
+        file_size = info.st_size;
+    }
+
+    SharedReadHandle::~SharedReadHandle()
+    {
+        ::close(fd);
+    }
+
+    void SharedReadHandle::read(
+        const uoff_t offset, void *destination, const size_t size) const
+    {
+        auto output = static_cast<u8*>(destination);
+        auto pos = offset;
+        auto left = size;
+        while (left)
+        {
+            const auto ret = ::pread(fd, output, left, pos);
+            if (ret < 0 && errno == EINTR)
+                continue;
+            if (ret < 0)
+                throw err::IoError("Could not read file");
+            if (ret == 0)
+                throw err::EofError();
+            output += ret;
+            pos += ret;
+            left -= ret;
         }
+    }
 
+    void SharedReadHandle::prefetch(
+        const uoff_t offset, const uoff_t size) const
+    {
+        #ifdef POSIX_FADV_WILLNEED
+            // the read-in is asynchronous, so this returns right away
+            ::posix_fadvise(fd, offset, size, POSIX_FADV_WILLNEED);
+        #endif
+    }
+#endif
+
+uoff_t SharedReadHandle::size() const
+{
+    return file_size;
+}
+
+struct FileByteStream::Priv final
+{
+    Priv(const io::path &path, const FileMode mode);
+    Priv(const std::shared_ptr<const SharedReadHandle> handle, uoff_t pos);
+    ~Priv();
+
+    void read_buffered(void *destination, size_t size);
+
+    #if _WIN32
         uoff_t tell()
         {
             return _telli64(fd);
@@ -77,20 +196,6 @@ struct FileByteStream::Priv final
 
         int fd;
     #else
-        Priv(const path &path, FileMode mode) : path(path), mode(mode)
-        {
-            fd = std::fopen(
-                path.c_str(),
-                mode == FileMode::Write ? "w+b" : "rb");
-            if (!fd)
-                throw err::FileNotFoundError("Could not open " + path.str());
-        }
-
-        ~Priv()
-        {
-            fclose(fd);
-        }
-
         uoff_t tell()
         {
             return ftello(fd);
@@ -120,13 +225,119 @@ struct FileByteStream::Priv final
 
     io::path path;
     FileMode mode;
+
+    // files opened for reading go through a shared handle instead, with
+    // the cursor and a small read buffer of their own
+    std::shared_ptr<const SharedReadHandle> read_handle;
+    uoff_t read_pos;
+    bstr buffer;
+    uoff_t buffer_pos;
+    size_t buffer_fill;
 };
 
+FileByteStream::Priv::Priv(const io::path &path, const FileMode mode) :
+    path(path),
+    mode(mode),
+    read_pos(0),
+    buffer_pos(0),
+    buffer_fill(0)
+{
+    #if _WIN32
+        fd = -1;
+    #else
+        fd = nullptr;
+    #endif
+
+    if (mode == FileMode::Read)
+    {
+        read_handle = std::make_shared<SharedReadHandle>(path);
+        return;
+    }
+
+    #if _WIN32
+        fd = _wopen(
+            path.wstr().c_str(),
+            _O_RDWR | _O_CREAT | _O_TRUNC | _O_BINARY,
+            _S_IREAD | _S_IWRITE);
+        if (fd == -1)
+            throw err::FileNotFoundError("Could not open " + path.str());
+    #else
+        fd = std::fopen(path.c_str(), "w+b");
+        if (!fd)
+            throw err::FileNotFoundError("Could not open " + path.str());
+    #endif
+}
+
+FileByteStream::Priv::Priv(
+    const std::shared_ptr<const SharedReadHandle> handle, const uoff_t pos) :
+        mode(FileMode::Read),
+        read_handle(handle),
+        read_pos(pos),
+        buffer_pos(0),
+        buffer_fill(0)
+{
+    #if _WIN32
+        fd = -1;
+    #else
+        fd = nullptr;
+    #endif
+}
+
+FileByteStream::Priv::~Priv()
+{
+    #if _WIN32
+        if (fd != -1)
+            _close(fd);
+    #else
+        if (fd)
+            fclose(fd);
+    #endif
+}
+
+void FileByteStream::Priv::read_buffered(void *destination, size_t size)
+{
+    if (size > read_handle->size() - read_pos)
+        throw err::EofError();
+
+    auto output = static_cast<u8*>(destination);
+    if (read_pos >= buffer_pos && read_pos < buffer_pos + buffer_fill)
+    {
+        const auto chunk = std::min<size_t>(
+            size, buffer_pos + buffer_fill - read_pos);
+        std::memcpy(output, buffer.get<u8>() + (read_pos - buffer_pos), chunk);
+        output += chunk;
+        read_pos += chunk;
+        size -= chunk;
+    }
+    if (!size)
+        return;
+
+    if (size > max_buffered_read_size)
+    {
+        read_handle->read(read_pos, output, size);
+        read_pos += size;
+        return;
+    }
+
+    if (buffer.empty())
+        buffer.resize(read_buffer_size);
+    buffer_pos = read_pos;
+    buffer_fill = std::min<uoff_t>(
+        read_buffer_size, read_handle->size() - read_pos);
+    read_handle->read(buffer_pos, buffer.get<u8>(), buffer_fill);
+    std::memcpy(output, buffer.get<u8>(), size);
+    read_pos += size;
+}
+
 FileByteStream::FileByteStream(const path &path, const FileMode mode)
     : p(new Priv(path, mode))
 {
 }
 
+FileByteStream::FileByteStream(std::unique_ptr<Priv> p) : p(std::move(p))
+{
+}
+
 FileByteStream::~FileByteStream()
 {
 }
@@ -135,28 +346,40 @@ void FileByteStream::seek_impl(const uoff_t offset)
 {
     if (offset > size())
         throw err::EofError();
-    p->seek(offset, SEEK_SET);
+    if (p->read_handle)
+        p->read_pos = offset;
+    else
+        p->seek(offset, SEEK_SET);
 }
 
 void FileByteStream::read_impl(void *destination, const size_t size)
 {
     // destination MUST exist and size MUST be at least 1
-    p->read(destination, size);
+    if (p->read_handle)
+        p->read_buffered(destination, size);
+    else
+        p->read(destination, size);
 }
 
 void FileByteStream::write_impl(const void *source, const size_t size)
 {
     // source MUST exist and size MUST be at least 1
+    if (p->read_handle)
+        throw err::IoError("File is opened for reading only");
     p->write(source, size);
 }
 
 uoff_t FileByteStream::pos() const
 {
+    if (p->read_handle)
+        return p->read_pos;
     return p->tell();
 }
 
 uoff_t FileByteStream::size() const
 {
+    if (p->read_handle)
+        return p->read_handle->size();
     const auto old_pos = p->tell();
     p->seek(0, SEEK_END);
     const auto size = p->tell();
@@ -171,8 +394,20 @@ void FileByteStream::resize_impl(const uoff_t new_size)
     throw err::NotSupportedError("Truncating real files is not implemented");
 }
 
+void FileByteStream::prefetch(const uoff_t offset, const uoff_t size) const
+{
+    if (p->read_handle && offset < p->read_handle->size())
+        p->read_handle->prefetch(offset, size);
+}
+
 std::unique_ptr<io::BaseByteStream> FileByteStream::clone() const
 {
+    // clones of files opened for reading are just new cursors
+    if (p->read_handle)
+    {
+        return std::unique_ptr<FileByteStream>(new FileByteStream(
+            std::make_unique<Priv>(p->read_handle, p->read_pos)));
+    }
     auto ret = std::make_unique<FileByteStream>(p->path, p->mode);
     ret->seek(pos());
     return std::move(ret);
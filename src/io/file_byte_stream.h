@@ -31,6 +31,9 @@ namespace io {
         Write = 2,
     };
 
+    // Files opened for reading share a single read-only handle with all of
+    // their clones, so cloning is cheap and clones can be read from
+    // different threads at once.
     class FileByteStream final : public BaseByteStream
     {
     public:
@@ -42,6 +45,11 @@ namespace io {
 
         std::unique_ptr<BaseByteStream> clone() const override;
 
+        // Asks the system to start reading given range in the background.
+        // Only a hint: does nothing for files opened for writing or where
+        // the platform has no such facility.
+        void prefetch(const uoff_t offset, const uoff_t size) const;
+
     protected:
         void read_impl(void *destination, const size_t size) override;
         void write_impl(const void *source, const size_t size) override;
@@ -50,6 +58,7 @@ namespace io {
 
     private:
         struct Priv;
+        FileByteStream(std::unique_ptr<Priv> p);
         std::unique_ptr<Priv> p;
     };
 
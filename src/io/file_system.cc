@@ -17,6 +17,14 @@
 
 #include "io/file_system.h"
 #include <boost/filesystem/path.hpp>
+#include "err.h"
+
+#if _WIN32
+    #include <windows.h>
+#else
+    #include <sys/stat.h>
+    #include <sys/types.h>
+#endif
 
 using namespace au;
 using namespace au::io;
@@ -46,6 +54,56 @@ path io::absolute(const path &p)
     return boost::filesystem::absolute(p.str()).string();
 }
 
+uoff_t io::file_size(const path &p)
+{
+    return boost::filesystem::file_size(p.str());
+}
+
+u64 io::last_write_time(const path &p)
+{
+    return boost::filesystem::last_write_time(p.str());
+}
+
+bool FileIdentity::operator <(const FileIdentity &other) const
+{
+    return device != other.device
+        ? device < other.device
+        : inode < other.inode;
+}
+
+FileIdentity io::file_identity(const path &p)
+{
+    FileIdentity identity;
+    #if _WIN32
+        const auto handle = CreateFileW(
+            p.wstr().c_str(),
+            0,
+            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+            nullptr,
+            OPEN_EXISTING,
+            FILE_FLAG_BACKUP_SEMANTICS,
+            nullptr);
+        if (handle == INVALID_HANDLE_VALUE)
+            throw err::FileNotFoundError("Could not open " + p.str());
+        BY_HANDLE_FILE_INFORMATION info;
+        const auto result = GetFileInformationByHandle(handle, &info);
+        CloseHandle(handle);
+        if (!result)
+            throw err::IoError("Could not query " + p.str());
+        identity.device = info.dwVolumeSerialNumber;
+        identity.inode
+            = (static_cast<u64>(info.nFileIndexHigh) << 32)
+            | info.nFileIndexLow;
+    #else
+        struct stat info;
+        if (stat(p.c_str(), &info) != 0)
+            throw err::FileNotFoundError("Could not open " + p.str());
+        identity.device = info.st_dev;
+        identity.inode = info.st_ino;
+    #endif
+    return identity;
+}
+
 void io::create_directories(const path &p)
 {
     const auto bp = boost::filesystem::path(p.str());
@@ -19,6 +19,7 @@
 
 #include <boost/filesystem.hpp>
 #include "io/path.h"
+#include "types.h"
 
 namespace au {
 namespace io {
@@ -28,6 +29,20 @@ namespace io {
     bool is_directory(const path &p);
     bool is_regular_file(const path &p);
     path absolute(const path &p);
+    uoff_t file_size(const path &p);
+    u64 last_write_time(const path &p);
+
+    // Identifies the underlying file regardless of the path used to reach it
+    // (hardlinks, symlinks, relative paths and so on).
+    struct FileIdentity final
+    {
+        bool operator <(const FileIdentity &other) const;
+
+        u64 device;
+        u64 inode;
+    };
+
+    FileIdentity file_identity(const path &p);
 
     void create_directories(const path &p);
     void remove(const path &p);
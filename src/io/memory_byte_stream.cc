@@ -23,7 +23,7 @@ using namespace au;
 using namespace au::io;
 
 MemoryByteStream::MemoryByteStream(const std::shared_ptr<bstr> input)
-    : buffer(input), buffer_pos(0)
+    : buffer(input), buffer_pos(0), view_offset(0), view_size(0), is_view(false)
 {
 }
 
@@ -37,6 +37,11 @@ MemoryByteStream::MemoryByteStream(const bstr &buffer)
 {
 }
 
+MemoryByteStream::MemoryByteStream(bstr &&buffer)
+    : MemoryByteStream(std::make_shared<bstr>(std::move(buffer)))
+{
+}
+
 MemoryByteStream::MemoryByteStream(const char *buffer, const size_t buffer_size)
     : MemoryByteStream(std::make_shared<bstr>(buffer, buffer_size))
 {
@@ -56,8 +61,40 @@ MemoryByteStream::~MemoryByteStream()
 {
 }
 
+std::unique_ptr<MemoryByteStream> MemoryByteStream::slice(
+    MemoryByteStream &parent_stream, const size_t size)
+{
+    if (parent_stream.buffer_pos + size > parent_stream.size())
+        throw err::EofError();
+    auto ret = std::unique_ptr<MemoryByteStream>(
+        new MemoryByteStream(parent_stream.buffer));
+    ret->view_offset = parent_stream.view_offset + parent_stream.buffer_pos;
+    ret->view_size = size;
+    ret->is_view = true;
+    parent_stream.buffer_pos += size;
+    return ret;
+}
+
+// a buffer shared with slices or clones is never modified in place, so that
+// their views always stay within its bounds
+void MemoryByteStream::detach()
+{
+    const auto is_shared = buffer.use_count() > 1;
+    if (!is_view && !is_shared)
+        return;
+    if (is_shared || view_offset || view_size != buffer->size())
+    {
+        buffer = std::make_shared<bstr>(
+            buffer->get<const u8>() + view_offset, size());
+    }
+    view_offset = 0;
+    view_size = 0;
+    is_view = false;
+}
+
 io::BaseByteStream &MemoryByteStream::reserve(const uoff_t size)
 {
+    detach();
     if (buffer->size() < size)
         buffer->resize(size);
     return *this;
@@ -65,7 +102,7 @@ io::BaseByteStream &MemoryByteStream::reserve(const uoff_t size)
 
 void MemoryByteStream::seek_impl(const uoff_t offset)
 {
-    if (offset > buffer->size())
+    if (offset > size())
         throw err::EofError();
     buffer_pos = offset;
 }
@@ -73,9 +110,9 @@ void MemoryByteStream::seek_impl(const uoff_t offset)
 void MemoryByteStream::read_impl(void *destination, const size_t size)
 {
     // destination MUST exist and size MUST be at least 1
-    if (buffer_pos + size > buffer->size())
+    if (buffer_pos + size > this->size())
         throw err::EofError();
-    auto source_ptr = buffer->get<const u8>() + buffer_pos;
+    auto source_ptr = buffer->get<const u8>() + view_offset + buffer_pos;
     auto destination_ptr = reinterpret_cast<u8*>(destination);
     buffer_pos += size;
     std::memcpy(destination_ptr, source_ptr, size);
@@ -98,11 +135,12 @@ uoff_t MemoryByteStream::pos() const
 
 uoff_t MemoryByteStream::size() const
 {
-    return buffer->size();
+    return is_view ? view_size : buffer->size();
 }
 
 void MemoryByteStream::resize_impl(const uoff_t new_size)
 {
+    detach();
     buffer->resize(new_size);
     if (buffer_pos > new_size)
         buffer_pos = new_size;
@@ -111,6 +149,9 @@ void MemoryByteStream::resize_impl(const uoff_t new_size)
 std::unique_ptr<io::BaseByteStream> MemoryByteStream::clone() const
 {
     auto ret = std::unique_ptr<MemoryByteStream>(new MemoryByteStream(buffer));
+    ret->view_offset = view_offset;
+    ret->view_size = view_size;
+    ret->is_view = is_view;
     ret->seek(pos());
     return std::move(ret);
 }
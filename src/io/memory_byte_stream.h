@@ -31,10 +31,18 @@ namespace io {
         MemoryByteStream();
         MemoryByteStream(const char *buffer, const size_t buffer_size);
         MemoryByteStream(const bstr &buffer);
+        MemoryByteStream(bstr &&buffer);
         MemoryByteStream(BaseByteStream &other_stream, const size_t size);
         MemoryByteStream(BaseByteStream &other_stream);
+
         ~MemoryByteStream();
 
+        // Consumes size bytes from the parent stream without copying them.
+        // The streams share the underlying buffer until either is written
+        // to or resized, at which point the writer detaches its own copy.
+        static std::unique_ptr<MemoryByteStream> slice(
+            MemoryByteStream &parent_stream, const size_t size);
+
         uoff_t size() const override;
         uoff_t pos() const override;
 
@@ -50,9 +58,13 @@ namespace io {
 
     private:
         MemoryByteStream(const std::shared_ptr<bstr> buffer);
+        void detach();
 
         std::shared_ptr<bstr> buffer;
         uoff_t buffer_pos;
+        uoff_t view_offset;
+        uoff_t view_size;
+        bool is_view;
     };
 
 } }
@@ -16,6 +16,8 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "io/msb_bit_stream.h"
+#include <algorithm>
+#include "algo/range.h"
 
 using namespace au;
 using namespace au::io;
@@ -58,6 +60,21 @@ u32 MsbBitStream::read(const size_t bits)
     return (buffer >> bits_available) & mask;
 }
 
+void MsbBitStream::refill(const size_t bits)
+{
+    // a borrowed stream may be read by someone else after we are done with
+    // it, so it must not be read ahead past what was asked for
+    const size_t wanted = own_stream_holder
+        ? (63 - bits_available) / 8
+        : (bits - bits_available + 7) / 8;
+    const auto count = std::min<uoff_t>(wanted, input_stream->left());
+    u8 chunk[8];
+    input_stream->read(chunk, count);
+    for (const auto i : algo::range(count))
+        buffer = (buffer << 8) | chunk[i];
+    bits_available += count * 8;
+}
+
 void MsbBitStream::write(const size_t bits, const u32 value)
 {
     const auto mask = (1ull << bits) - 1;
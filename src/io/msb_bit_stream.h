@@ -31,8 +31,37 @@ namespace io {
         ~MsbBitStream();
         u32 read(const size_t bits) override;
         void flush() override;
+
+        // Returns the next bits without consuming them, padding with zeros
+        // past the end of the input. Streams that own their input refill
+        // as many bytes as the buffer holds, so that a run of peeks usually
+        // needs no further refill.
+        inline u32 peek_bits(const size_t bits)
+        {
+            if (bits_available < bits)
+                refill(bits);
+            const auto mask = (1ull << bits) - 1;
+            if (bits_available < bits)
+                return (buffer << (bits - bits_available)) & mask;
+            return (buffer >> (bits_available - bits)) & mask;
+        }
+
+        // Consumes bits, typically ones that were just peeked.
+        inline void skip_bits(const size_t bits)
+        {
+            if (bits_available < bits)
+            {
+                read(bits);
+                return;
+            }
+            bits_available -= bits;
+            position += bits;
+        }
+
         void write(const size_t bits, const u32 value) override;
     private:
+        void refill(const size_t bits);
+
         bool dirty;
     };
 
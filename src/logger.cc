@@ -16,30 +16,271 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "logger.h"
+#include <atomic>
+#include <condition_variable>
 #include <cstdarg>
+#include <future>
 #include <iostream>
 #include <mutex>
+#include <thread>
 #include "algo/format.h"
 #include "algo/str.h"
+#include "types.h"
 
 using namespace au;
 
-static std::mutex mutex;
+namespace
+{
+    struct Record final
+    {
+        bool to_stderr = false;
+        bool color_change = false;
+        Logger::Color color = Logger::Color::Original;
+        std::string prefix;
+        std::string text;
+        std::promise<void> *flushed = nullptr;
+    };
+
+    struct Node final
+    {
+        std::atomic<Node*> next {nullptr};
+        Record record;
+    };
+
+    // Loggers hand preformatted records over to a single writer thread
+    // through an intrusive MPSC queue: appending costs one pointer swap, so
+    // logging threads never wait for each other nor for the console. The
+    // queue is FIFO, which keeps the order of messages of any given task.
+    class Writer final
+    {
+    public:
+        Writer();
+        ~Writer();
+
+        void push(Record &&record);
+
+        // Blocks until everything pushed so far is written out.
+        void flush();
+
+    private:
+        void push_node(Node *node);
+        Node *pop();
+        bool empty() const;
+        void write(const Record &record) const;
+        void run();
+
+        Node stub;
+        std::atomic<Node*> head;
+        Node *tail;
+
+        std::mutex wake_mutex;
+        std::condition_variable wake;
+        std::atomic<bool> writer_waiting;
+        std::atomic<bool> stopping;
+        std::thread thread;
+    };
+}
+
+Writer::Writer() :
+    head(&stub),
+    tail(&stub),
+    writer_waiting(false),
+    stopping(false)
+{
+    thread = std::thread([this]() { run(); });
+}
+
+Writer::~Writer()
+{
+    {
+        std::unique_lock<std::mutex> lock(wake_mutex);
+        stopping = true;
+        wake.notify_one();
+    }
+    thread.join();
+}
+
+void Writer::push_node(Node *node)
+{
+    node->next.store(nullptr, std::memory_order_relaxed);
+    const auto prev = head.exchange(node);
+    prev->next.store(node, std::memory_order_release);
+}
+
+void Writer::push(Record &&record)
+{
+    const auto node = new Node;
+    node->record = std::move(record);
+    push_node(node);
+    // pairs with the check in run(): either the writer sees the new node or
+    // this sees the writer waiting
+    if (writer_waiting)
+    {
+        std::unique_lock<std::mutex> lock(wake_mutex);
+        wake.notify_one();
+    }
+}
+
+void Writer::flush()
+{
+    if (std::this_thread::get_id() == thread.get_id())
+        return;
+    std::promise<void> flushed;
+    Record record;
+    record.flushed = &flushed;
+    push(std::move(record));
+    flushed.get_future().wait();
+}
+
+// Returns nullptr both when the queue is empty and when a producer is in the
+// middle of appending; empty() tells these apart.
+Node *Writer::pop()
+{
+    auto node = tail;
+    auto next = node->next.load(std::memory_order_acquire);
+    if (node == &stub)
+    {
+        if (!next)
+            return nullptr;
+        tail = next;
+        node = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+    if (next)
+    {
+        tail = next;
+        return node;
+    }
+    if (node != head.load())
+        return nullptr;
+    push_node(&stub);
+    next = node->next.load(std::memory_order_acquire);
+    if (next)
+    {
+        tail = next;
+        return node;
+    }
+    return nullptr;
+}
+
+bool Writer::empty() const
+{
+    return tail == &stub && head.load() == &stub;
+}
+
+void Writer::write(const Record &record) const
+{
+    if (record.color_change)
+    {
+        set_console_color(record.color, false);
+        return;
+    }
+
+    if (record.to_stderr)
+        std::cout.flush();
+    auto &out = record.to_stderr ? std::cerr : std::cout;
+    const auto colored = record.color != Logger::Color::Original;
+    for (const auto &line : algo::split(record.text, '\n', true))
+    {
+        out << record.prefix;
+        if (colored)
+            set_console_color(record.color, record.to_stderr);
+        out << line;
+        if (colored)
+            set_console_color(Logger::Color::Original, record.to_stderr);
+    }
+}
+
+void Writer::run()
+{
+    while (true)
+    {
+        if (const auto node = pop())
+        {
+            if (node->record.flushed)
+            {
+                std::cout.flush();
+                node->record.flushed->set_value();
+            }
+            else
+                write(node->record);
+            delete node;
+            continue;
+        }
+
+        // the batch is done, so it's a good time to push it to the console
+        std::cout.flush();
+
+        std::unique_lock<std::mutex> lock(wake_mutex);
+        writer_waiting = true;
+        if (!empty())
+        {
+            // a producer is halfway through appending
+            writer_waiting = false;
+            lock.unlock();
+            std::this_thread::yield();
+            continue;
+        }
+        if (stopping)
+            break;
+        wake.wait(lock);
+        writer_waiting = false;
+    }
+}
+
+static Writer &get_writer()
+{
+    static Writer writer;
+    return writer;
+}
+
+static std::string escape_json(const std::string &input)
+{
+    std::string output;
+    output.reserve(input.size());
+    for (const auto c : input)
+    {
+        if (c == '"' || c == '\\')
+        {
+            output += '\\';
+            output += c;
+        }
+        else if (c == '\n')
+            output += "\\n";
+        else if (c == '\r')
+            output += "\\r";
+        else if (c == '\t')
+            output += "\\t";
+        else if (static_cast<u8>(c) < 0x20)
+            output += algo::format("\\u%04x", c);
+        else
+            output += c;
+    }
+    return output;
+}
 
 struct Logger::Priv final
 {
-    Priv(Logger &logger);
+    Priv();
+    ~Priv();
     void log(
         const MessageType type, const std::string fmt, std::va_list args) const;
+    std::string make_json_lines(
+        const MessageType type, const std::string &text) const;
 
-    Logger &logger;
     Color colors[6];
     int muted = 0;
     bool colors_enabled = true;
+    bool json_enabled = false;
     std::string prefix;
+
+    // JSON records are emitted a whole line at a time
+    mutable std::mutex pending_mutex;
+    mutable std::string pending_text;
+    mutable MessageType pending_type;
 };
 
-Logger::Priv::Priv(Logger &logger) : logger(logger)
+Logger::Priv::Priv()
 {
     colors[MessageType::Summary] = Color::Original;
     colors[MessageType::Info] = Color::Original;
@@ -49,35 +290,77 @@ Logger::Priv::Priv(Logger &logger) : logger(logger)
     colors[MessageType::Debug] = Color::Cyan;
 }
 
+Logger::Priv::~Priv()
+{
+    if (!pending_text.empty())
+    {
+        Record record;
+        record.text = make_json_lines(pending_type, "\n");
+        get_writer().push(std::move(record));
+    }
+}
+
+std::string Logger::Priv::make_json_lines(
+    const MessageType type, const std::string &text) const
+{
+    static const char *type_names[] =
+    {
+        "summary", "info", "success", "warning", "error", "debug",
+    };
+
+    std::unique_lock<std::mutex> lock(pending_mutex);
+    if (pending_text.empty())
+        pending_type = type;
+    pending_text += text;
+    std::string output;
+    size_t pos;
+    while ((pos = pending_text.find('\n')) != std::string::npos)
+    {
+        output += algo::format(
+            "{\"type\": \"%s\", \"prefix\": \"%s\", \"message\": \"%s\"}\n",
+            type_names[pending_type],
+            escape_json(prefix).c_str(),
+            escape_json(pending_text.substr(0, pos)).c_str());
+        pending_text.erase(0, pos + 1);
+        pending_type = type;
+    }
+    return output;
+}
+
 void Logger::Priv::log(
     const MessageType type, const std::string fmt, std::va_list args) const
 {
-    std::unique_lock<std::mutex> lock(mutex);
     if (muted & (1 << type))
         return;
-    auto *out = &std::cout;
-    if (type == MessageType::Warning || type == MessageType::Error)
-        out = &std::cerr;
-    const auto output = algo::format(fmt, args);
-    for (const auto line : algo::split(output, '\n', true))
-    {
-        (*out) << prefix;
-        if (colors_enabled && colors[type] != Color::Original)
-            logger.set_color(colors[type]);
-        (*out) << line;
-        if (colors_enabled && colors[type] != Color::Original)
-            logger.set_color(Color::Original);
+
+    Record record;
+    record.to_stderr
+        = type == MessageType::Warning || type == MessageType::Error;
+    if (json_enabled)
+    {
+        record.text = make_json_lines(type, algo::format(fmt, args));
+        if (record.text.empty())
+            return;
     }
+    else
+    {
+        record.text = algo::format(fmt, args);
+        record.prefix = prefix;
+        if (colors_enabled)
+            record.color = colors[type];
+    }
+    get_writer().push(std::move(record));
 }
 
-Logger::Logger(const Logger &other_logger) : p(new Priv(*this))
+Logger::Logger(const Logger &other_logger) : p(new Priv())
 {
     p->muted = other_logger.p->muted;
     p->colors_enabled = other_logger.p->colors_enabled;
+    p->json_enabled = other_logger.p->json_enabled;
     p->prefix = other_logger.p->prefix;
 }
 
-Logger::Logger() : p(new Priv(*this))
+Logger::Logger() : p(new Priv())
 {
     unmute();
 }
@@ -86,6 +369,16 @@ Logger::~Logger()
 {
 }
 
+void Logger::set_color(const Color c)
+{
+    if (p->json_enabled)
+        return;
+    Record record;
+    record.color_change = true;
+    record.color = c;
+    get_writer().push(std::move(record));
+}
+
 void Logger::set_prefix(const std::string &prefix)
 {
     p->prefix = prefix;
@@ -142,8 +435,7 @@ void Logger::debug(const std::string fmt, ...) const
 
 void Logger::flush() const
 {
-    std::cout.flush();
-    // stderr should be nonbuffered
+    get_writer().flush();
 }
 
 void Logger::mute()
@@ -180,3 +472,18 @@ void Logger::enable_colors()
 {
     p->colors_enabled = true;
 }
+
+bool Logger::json_enabled() const
+{
+    return p->json_enabled;
+}
+
+void Logger::disable_json()
+{
+    p->json_enabled = false;
+}
+
+void Logger::enable_json()
+{
+    p->json_enabled = true;
+}
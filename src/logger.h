@@ -69,6 +69,9 @@ namespace au {
         void warn(const std::string str, ...) const;
         void err(const std::string str, ...) const;
         void debug(const std::string str, ...) const;
+
+        // Messages are written asynchronously; this waits until everything
+        // logged so far has reached the console.
         void flush() const;
 
         void mute();
@@ -80,9 +83,18 @@ namespace au {
         void disable_colors();
         void enable_colors();
 
+        // Writes every line as a JSON object instead of plain text.
+        bool json_enabled() const;
+        void disable_json();
+        void enable_json();
+
     private:
         struct Priv;
         std::unique_ptr<Priv> p;
     };
 
+    // Implemented by logger_ansi.cc, logger_win.cc or logger_dummy.cc,
+    // depending on the platform. Only ever called by the log writer thread.
+    void set_console_color(const Logger::Color color, const bool to_stderr);
+
 }
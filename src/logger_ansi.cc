@@ -45,10 +45,10 @@ static std::string get_ansi_color(const Logger::Color c)
     return "";
 }
 
-void Logger::set_color(const Logger::Color c)
+void au::set_console_color(const Logger::Color c, const bool to_stderr)
 {
-    if (isatty(STDIN_FILENO))
-        std::cout << get_ansi_color(c);
-    if (isatty(STDERR_FILENO))
-        std::cerr << get_ansi_color(c);
+    static const bool stdout_is_tty = isatty(STDOUT_FILENO);
+    static const bool stderr_is_tty = isatty(STDERR_FILENO);
+    if (to_stderr ? stderr_is_tty : stdout_is_tty)
+        (to_stderr ? std::cerr : std::cout) << get_ansi_color(c);
 }
@@ -19,6 +19,6 @@
 
 using namespace au;
 
-void Logger::set_color(const Color c)
+void au::set_console_color(const Logger::Color c, const bool to_stderr)
 {
 }
@@ -16,6 +16,7 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "logger.h"
+#include <iostream>
 #include <windows.h>
 
 using namespace au;
@@ -73,8 +74,12 @@ static WORD get_win_color(const Logger::Color c)
     throw std::logic_error("Unknown color");
 }
 
-void Logger::set_color(const Logger::Color c)
+void au::set_console_color(const Logger::Color c, const bool to_stderr)
 {
-    HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
-    SetConsoleTextAttribute(hConsole, get_win_color(c));
+    static const HANDLE stdout_handle = GetStdHandle(STD_OUTPUT_HANDLE);
+    static const HANDLE stderr_handle = GetStdHandle(STD_ERROR_HANDLE);
+    // the console attributes apply to whatever reaches the console next
+    std::cout.flush();
+    SetConsoleTextAttribute(
+        to_stderr ? stderr_handle : stdout_handle, get_win_color(c));
 }
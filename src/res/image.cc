@@ -17,21 +17,51 @@
 
 #include "res/image.h"
 #include <algorithm>
+#include <cstring>
 #include "algo/format.h"
 #include "algo/range.h"
 #include "err.h"
 
+#if defined(__SSE2__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define IMAGE_USE_SSE2
+    #include <emmintrin.h>
+#endif
+
 using namespace au;
 using namespace au::res;
 
 static const Pixel transparent_pixel = {0, 0, 0, 0};
 
-Image::Image(const Image &other) : Grid(other)
+static size_t get_buffer_size(const size_t width, const size_t height)
+{
+    if (!width || !height)
+        throw err::BadDataSizeError();
+    return width * height * sizeof(Pixel);
+}
+
+Image::Image(const size_t width, const size_t height) :
+    pixels(get_buffer_size(width, height)),
+    _width(width),
+    _height(height)
+{
+}
+
+Image::Image(const size_t width, const size_t height, bstr &&input) :
+    pixels(std::move(input)),
+    _width(width),
+    _height(height)
 {
+    const auto size = get_buffer_size(width, height);
+    if (pixels.size() < size)
+        throw err::BadDataSizeError();
+    pixels.resize(size);
 }
 
-Image::Image(const size_t width, const size_t height) : Grid(width, height)
+Image::Image(const ConstImageView &view) : Image(view.width(), view.height())
 {
+    for (const auto y : algo::range(_height))
+        std::memcpy(row(y), view.row(y), _width * sizeof(Pixel));
 }
 
 Image::Image(
@@ -42,9 +72,28 @@ Image::Image(
 {
     if (input.size() < pixel_format_to_bpp(fmt) * width * height)
         throw err::BadDataSizeError();
-    if (!width || !height)
+    read_pixels(input.get<const u8>(), begin(), width * height, fmt);
+}
+
+Image::Image(
+    const size_t width,
+    const size_t height,
+    bstr &&input,
+    const PixelFormat fmt) : _width(width), _height(height)
+{
+    const auto size = get_buffer_size(width, height);
+    if (input.size() < pixel_format_to_bpp(fmt) * width * height)
         throw err::BadDataSizeError();
-    read_pixels(input.get<const u8>(), content, fmt);
+    if (fmt == PixelFormat::BGRA8888)
+    {
+        pixels = std::move(input);
+        pixels.resize(size);
+    }
+    else
+    {
+        pixels.resize(size);
+        read_pixels(input.get<const u8>(), begin(), width * height, fmt);
+    }
 }
 
 Image::Image(
@@ -80,14 +129,71 @@ Image::Image(
     apply_palette(palette);
 }
 
+Image::Image(Image &&other) :
+    pixels(std::move(other.pixels)),
+    _width(other._width),
+    _height(other._height)
+{
+    other._width = 0;
+    other._height = 0;
+}
+
+Image &Image::operator =(Image &&other)
+{
+    pixels = std::move(other.pixels);
+    _width = other._width;
+    _height = other._height;
+    other._width = 0;
+    other._height = 0;
+    return *this;
+}
+
+Image Image::clone() const
+{
+    return Image(_width, _height, bstr(pixels));
+}
+
+ImageView Image::view()
+{
+    return ImageView(begin(), _width, _height, _width);
+}
+
+ConstImageView Image::view() const
+{
+    return ConstImageView(begin(), _width, _height, _width);
+}
+
+ImageView Image::view(
+    const size_t x, const size_t y, const size_t width, const size_t height)
+{
+    return view().crop(x, y, width, height);
+}
+
+ConstImageView Image::view(
+    const size_t x,
+    const size_t y,
+    const size_t width,
+    const size_t height) const
+{
+    return view().crop(x, y, width, height);
+}
+
+bstr Image::release()
+{
+    bstr output(std::move(pixels));
+    pixels = bstr();
+    _width = 0;
+    _height = 0;
+    return output;
+}
+
 Image &Image::invert()
 {
-    for (const auto y : algo::range(_height))
-    for (const auto x : algo::range(_width))
+    for (auto &c : *this)
     {
-        at(x, y).r ^= 0xFF;
-        at(x, y).g ^= 0xFF;
-        at(x, y).b ^= 0xFF;
+        c.r ^= 0xFF;
+        c.g ^= 0xFF;
+        c.b ^= 0xFF;
     }
     return *this;
 }
@@ -95,57 +201,65 @@ Image &Image::invert()
 Image &Image::flip_vertically()
 {
     for (const auto y : algo::range(_height >> 1))
-    for (const auto x : algo::range(_width))
-    {
-        const auto t = at(x, _height - 1 - y);
-        at(x, _height - 1 - y) = at(x, y);
-        at(x, y) = t;
-    }
+        std::swap_ranges(row(y), row(y) + _width, row(_height - 1 - y));
     return *this;
 }
 
 Image &Image::flip_horizontally()
 {
     for (const auto y : algo::range(_height))
-    for (const auto x : algo::range(_width >> 1))
-    {
-        const auto t = at(_width - 1 - x, y);
-        at(_width - 1 - x, y) = at(x, y);
-        at(x, y) = t;
-    }
+        std::reverse(row(y), row(y) + _width);
     return *this;
 }
 
 Image &Image::offset(const int x_offset, const int y_offset)
 {
-    res::Image old_image(*this);
-    crop(_width + x_offset, _height + y_offset);
-    for (auto &c : content)
-        c = transparent_pixel;
-    return overlay(old_image, x_offset, y_offset, OverlayKind::OverwriteAll);
+    Image output(_width + x_offset, _height + y_offset);
+    output.overlay(*this, x_offset, y_offset, OverlayKind::OverwriteAll);
+    return *this = std::move(output);
 }
 
 Image &Image::crop(const size_t new_width, const size_t new_height)
 {
-    std::vector<Pixel> old_content(content.begin(), content.end());
-    if (!new_width || !new_height)
-        throw err::BadDataSizeError();
+    const auto new_size = get_buffer_size(new_width, new_height);
     const auto old_width = _width;
-    const auto old_height = _height;
-    _width = new_width;
-    _height = new_height;
-    content.resize(new_width * new_height);
-    for (const auto y : algo::range(std::min(old_height, new_height)))
-    for (const auto x : algo::range(std::min(old_width, new_width)))
+    const auto copy_width = std::min(old_width, new_width);
+    const auto copy_height = std::min(_height, new_height);
+    if (new_size > pixels.size())
+        pixels.resize(new_size);
+
+    // the rows are moved within the buffer: towards its start when the
+    // image gets narrower, towards its end when it gets wider
+    auto data = begin();
+    if (new_width <= old_width)
+    {
+        for (const auto y : algo::range(copy_height))
+        {
+            std::memmove(
+                data + y * new_width,
+                data + y * old_width,
+                copy_width * sizeof(Pixel));
+        }
+    }
+    else
     {
-        content[y * new_width + x] = old_content[y * old_width + x];
+        for (auto y = copy_height; y-- > 0; )
+        {
+            const auto target = data + y * new_width;
+            std::memmove(
+                target, data + y * old_width, copy_width * sizeof(Pixel));
+            std::fill(
+                target + copy_width, target + new_width, transparent_pixel);
+        }
     }
-    for (const auto y : algo::range(old_height, new_height))
-    for (const auto x : algo::range(new_width))
-        content[y * new_width + x] = transparent_pixel;
-    for (const auto y : algo::range(old_height))
-    for (const auto x : algo::range(old_width, new_width))
-        content[y * new_width + x] = transparent_pixel;
+    std::fill(
+        data + copy_height * new_width,
+        data + new_height * new_width,
+        transparent_pixel);
+
+    pixels.resize(new_size);
+    _width = new_width;
+    _height = new_height;
     return *this;
 }
 
@@ -153,16 +267,16 @@ Image &Image::apply_mask(const Image &other)
 {
     if (other.width() != _width || other.height() != _height)
         throw std::logic_error("Mask image size is different from image size");
-    for (const auto y : algo::range(_height))
-    for (const auto x : algo::range(_width))
-        at(x, y).a = other.at(x, y).r;
+    auto target = begin();
+    for (const auto &c : other)
+        (target++)->a = c.r;
     return *this;
 }
 
 Image &Image::apply_palette(const Palette &palette)
 {
     const auto palette_size = palette.size();
-    for (auto &c : content)
+    for (auto &c : *this)
     {
         if (c.r < palette_size)
             c = palette[c.r];
@@ -173,17 +287,80 @@ Image &Image::apply_palette(const Palette &palette)
 }
 
 Image &Image::overlay(
-    const Image &other,
-    const OverlayKind overlay_kind)
+    const ConstImageView &other, const OverlayKind overlay_kind)
 {
     return overlay(other, 0, 0, overlay_kind);
 }
 
+Image &Image::overlay(const Image &other, const OverlayKind overlay_kind)
+{
+    return overlay(other.view(), 0, 0, overlay_kind);
+}
+
 Image &Image::overlay(
     const Image &other,
     const int target_x,
     const int target_y,
     const OverlayKind overlay_kind)
+{
+    return overlay(other.view(), target_x, target_y, overlay_kind);
+}
+
+static void overwrite_non_transparent(
+    Pixel *target, const Pixel *source, const size_t count)
+{
+    size_t i = 0;
+    #ifdef IMAGE_USE_SSE2
+        const auto zero = _mm_setzero_si128();
+        for (; i + 4 <= count; i += 4)
+        {
+            const auto src = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(source + i));
+            const auto dst = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(target + i));
+            const auto transparent
+                = _mm_cmpeq_epi32(_mm_srli_epi32(src, 24), zero);
+            _mm_storeu_si128(
+                reinterpret_cast<__m128i*>(target + i),
+                _mm_or_si128(
+                    _mm_and_si128(transparent, dst),
+                    _mm_andnot_si128(transparent, src)));
+        }
+    #endif
+    for (; i < count; i++)
+        if (source[i].a)
+            target[i] = source[i];
+}
+
+static void add_simple(Pixel *target, const Pixel *source, const size_t count)
+{
+    size_t i = 0;
+    #ifdef IMAGE_USE_SSE2
+        const auto color_mask = _mm_set1_epi32(0x00FFFFFF);
+        for (; i + 4 <= count; i += 4)
+        {
+            const auto src = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(source + i));
+            const auto dst = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(target + i));
+            _mm_storeu_si128(
+                reinterpret_cast<__m128i*>(target + i),
+                _mm_add_epi8(dst, _mm_and_si128(src, color_mask)));
+        }
+    #endif
+    for (; i < count; i++)
+    {
+        target[i].r += source[i].r;
+        target[i].g += source[i].g;
+        target[i].b += source[i].b;
+    }
+}
+
+Image &Image::overlay(
+    const ConstImageView &other,
+    const int target_x,
+    const int target_y,
+    const OverlayKind overlay_kind)
 {
     const int x1 = std::max<int>(0, target_x);
     const int x2 = std::min<int>(width(), target_x + other.width());
@@ -191,37 +368,22 @@ Image &Image::overlay(
     const int y2 = std::min<int>(height(), target_y + other.height());
     const int source_x = -target_x;
     const int source_y = -target_y;
-    if (overlay_kind == OverlayKind::OverwriteAll)
-    {
-        for (const auto y : algo::range(y1, y2))
-        for (const auto x : algo::range(x1, x2))
-            at(x, y) = other.at(source_x + x, source_y + y);
-    }
-    else if (overlay_kind == OverlayKind::OverwriteNonTransparent)
-    {
-        for (const auto y : algo::range(y1, y2))
-        for (const auto x : algo::range(x1, x2))
-        {
-            const auto &source_pixel = other.at(source_x + x, source_y + y);
-            if (source_pixel.a)
-                at(x, y) = source_pixel;
-        }
-    }
-    else if (overlay_kind == OverlayKind::AddSimple)
-    {
-        for (const auto y : algo::range(y1, y2))
-        for (const auto x : algo::range(x1, x2))
-        {
-            auto &target_pixel = at(x, y);
-            const auto &source_pixel = other.at(source_x + x, source_y + y);
-            target_pixel.r += source_pixel.r;
-            target_pixel.g += source_pixel.g;
-            target_pixel.b += source_pixel.b;
-        }
-    }
-    else
+    if (x1 >= x2 || y1 >= y2)
+        return *this;
+
+    const auto count = x2 - x1;
+    for (const auto y : algo::range(y1, y2))
     {
-        throw std::logic_error("Unknown overlay kind");
+        auto target = &at(x1, y);
+        const auto source = other.row(source_y + y) + source_x + x1;
+        if (overlay_kind == OverlayKind::OverwriteAll)
+            std::memmove(target, source, count * sizeof(Pixel));
+        else if (overlay_kind == OverlayKind::OverwriteNonTransparent)
+            overwrite_non_transparent(target, source, count);
+        else if (overlay_kind == OverlayKind::AddSimple)
+            add_simple(target, source, count);
+        else
+            throw std::logic_error("Unknown overlay kind");
     }
     return *this;
 }
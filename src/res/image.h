@@ -17,8 +17,9 @@
 
 #pragma once
 
+#include <cstddef>
 #include <memory>
-#include "algo/grid.h"
+#include <stdexcept>
 #include "io/base_byte_stream.h"
 #include "res/palette.h"
 #include "res/pixel.h"
@@ -27,7 +28,90 @@
 namespace au {
 namespace res {
 
-    class Image final : public algo::Grid<Pixel>
+    // Non-owning window into pixels laid out row by row, stride pixels
+    // apart. The stride may be negative, which makes for vertically
+    // flipped views. Views are only valid as long as the pixels they point
+    // to, so they are meant to be passed around, not kept.
+    template<typename T> class ImageViewImpl final
+    {
+    public:
+        ImageViewImpl(
+            T *pixels,
+            const size_t width,
+            const size_t height,
+            const std::ptrdiff_t stride) :
+                pixels(pixels),
+                _width(width),
+                _height(height),
+                _stride(stride)
+        {
+        }
+
+        // views of mutable pixels can be used wherever read-only ones are
+        operator ImageViewImpl<const T>() const
+        {
+            return ImageViewImpl<const T>(pixels, _width, _height, _stride);
+        }
+
+        size_t width() const
+        {
+            return _width;
+        }
+
+        size_t height() const
+        {
+            return _height;
+        }
+
+        std::ptrdiff_t stride() const
+        {
+            return _stride;
+        }
+
+        T *row(const size_t y) const
+        {
+            return pixels + static_cast<std::ptrdiff_t>(y) * _stride;
+        }
+
+        T &at(const size_t x, const size_t y) const
+        {
+            return row(y)[x];
+        }
+
+        ImageViewImpl crop(
+            const size_t x,
+            const size_t y,
+            const size_t width,
+            const size_t height) const
+        {
+            if (x + width > _width || y + height > _height)
+                throw std::logic_error("View region is out of bounds");
+            return ImageViewImpl(&at(x, y), width, height, _stride);
+        }
+
+        ImageViewImpl flip_vertically() const
+        {
+            return ImageViewImpl(
+                _height ? row(_height - 1) : pixels,
+                _width,
+                _height,
+                -_stride);
+        }
+
+    private:
+        T *pixels;
+        size_t _width, _height;
+        std::ptrdiff_t _stride;
+    };
+
+    using ImageView = ImageViewImpl<Pixel>;
+    using ConstImageView = ImageViewImpl<const Pixel>;
+
+    // Packed BGRA image. The pixels live in a single buffer, row after row,
+    // so decoders can write into it directly or hand over a buffer they
+    // already decoded to. Images are move-only; copies need to be asked
+    // for with clone().
+    class Image final
     {
     public:
         enum class OverlayKind : u8
@@ -37,16 +121,25 @@ namespace res {
             AddSimple,
         };
 
-        Image(const Image &other);
-
         Image(const size_t width, const size_t height);
 
+        // Takes over given BGRA8888 buffer without copying it.
+        Image(const size_t width, const size_t height, bstr &&pixels);
+
+        explicit Image(const ConstImageView &view);
+
         Image(
             const size_t width,
             const size_t height,
             const bstr &input,
             const PixelFormat fmt);
 
+        Image(
+            const size_t width,
+            const size_t height,
+            bstr &&input,
+            const PixelFormat fmt);
+
         Image(
             const size_t width,
             const size_t height,
@@ -65,6 +158,79 @@ namespace res {
             io::BaseByteStream &input_stream,
             const Palette &palette);
 
+        Image(const Image &other) = delete;
+        Image(Image &&other);
+        Image &operator =(const Image &other) = delete;
+        Image &operator =(Image &&other);
+
+        Image clone() const;
+
+        size_t width() const
+        {
+            return _width;
+        }
+
+        size_t height() const
+        {
+            return _height;
+        }
+
+        Pixel *row(const size_t y)
+        {
+            return begin() + y * _width;
+        }
+
+        const Pixel *row(const size_t y) const
+        {
+            return begin() + y * _width;
+        }
+
+        Pixel &at(const size_t x, const size_t y)
+        {
+            return row(y)[x];
+        }
+
+        const Pixel &at(const size_t x, const size_t y) const
+        {
+            return row(y)[x];
+        }
+
+        Pixel *begin()
+        {
+            return pixels.get<Pixel>();
+        }
+
+        Pixel *end()
+        {
+            return pixels.end<Pixel>();
+        }
+
+        const Pixel *begin() const
+        {
+            return pixels.get<const Pixel>();
+        }
+
+        const Pixel *end() const
+        {
+            return pixels.end<const Pixel>();
+        }
+
+        ImageView view();
+        ConstImageView view() const;
+        ImageView view(
+            const size_t x,
+            const size_t y,
+            const size_t width,
+            const size_t height);
+        ConstImageView view(
+            const size_t x,
+            const size_t y,
+            const size_t width,
+            const size_t height) const;
+
+        // Releases the underlying BGRA8888 buffer, leaving the image empty.
+        bstr release();
+
         Image &flip_vertically();
         Image &flip_horizontally();
         Image &offset(const int x, const int y);
@@ -75,12 +241,22 @@ namespace res {
         Image &apply_palette(const Palette &palette);
 
         Image &overlay(
-            const Image &other, const OverlayKind overlay_kind);
+            const ConstImageView &other, const OverlayKind overlay_kind);
+        Image &overlay(
+            const ConstImageView &other,
+            const int target_x,
+            const int target_y,
+            const OverlayKind overlay_kind);
+        Image &overlay(const Image &other, const OverlayKind overlay_kind);
         Image &overlay(
             const Image &other,
             const int target_x,
             const int target_y,
             const OverlayKind overlay_kind);
+
+    private:
+        bstr pixels;
+        size_t _width, _height;
     };
 
 } }
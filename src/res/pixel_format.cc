@@ -256,18 +256,21 @@ namespace res {
     }
 
     void read_pixels(
-        const u8 *input_ptr, std::vector<Pixel> &output, const PixelFormat fmt)
+        const u8 *input_ptr,
+        Pixel *output,
+        const size_t count,
+        const PixelFormat fmt)
     {
         // save those precious CPU cycles
         if (fmt == PixelFormat::BGRA8888)
         {
-            std::memcpy(output.data(), input_ptr, output.size() * 4);
+            std::memcpy(output, input_ptr, count * 4);
             return;
         }
 
         // I don't think there is a better alternative to this
         using PF = PixelFormat;
-        std::function<void(const u8 *, std::vector<Pixel> &)> impl;
+        std::function<void(const u8 *, Pixel *, size_t)> impl;
         switch (fmt)
         {
             case PF::Gray8:     impl = read_pixels<PF::Gray8>; break;
@@ -295,7 +298,13 @@ namespace res {
                 throw std::logic_error(
                     algo::format("Unsupported pixel format: %d", fmt));
         }
-        impl(input_ptr, output);
+        impl(input_ptr, output, count);
+    }
+
+    void read_pixels(
+        const u8 *input_ptr, std::vector<Pixel> &output, const PixelFormat fmt)
+    {
+        read_pixels(input_ptr, output.data(), output.size(), fmt);
     }
 
 } }
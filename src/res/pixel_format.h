@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <vector>
+#include "algo/range.h"
 #include "io/base_byte_stream.h"
 #include "res/pixel.h"
 
@@ -84,12 +86,18 @@ namespace res {
     template<PixelFormat fmt> Pixel read_pixel(const u8 *&ptr);
 
     template<PixelFormat fmt> void read_pixels(
-        const u8 *input_ptr, std::vector<Pixel> &output)
+        const u8 *input_ptr, Pixel *output, const size_t count)
     {
-        for (auto &c : output)
-            c = read_pixel<fmt>(input_ptr);
+        for (const auto i : algo::range(count))
+            output[i] = read_pixel<fmt>(input_ptr);
     }
 
+    void read_pixels(
+        const u8 *input_ptr,
+        Pixel *output,
+        const size_t count,
+        const PixelFormat fmt);
+
     void read_pixels(
         const u8 *input_ptr,
         std::vector<Pixel> &output,
@@ -18,18 +18,60 @@
 #include "virtual_file_system.h"
 #include <map>
 #include <mutex>
-#include <set>
+#include <unordered_map>
 #include "algo/str.h"
 #include "err.h"
 #include "io/file_system.h"
 
 using namespace au;
 
+namespace
+{
+    // Case-insensitive lookup tables of all files within given directory.
+    // For each key, the first file in the directory traversal order wins.
+    struct DirectoryIndex final
+    {
+        DirectoryIndex(const io::path &directory);
+
+        std::unordered_map<std::string, io::path> by_stem;
+        std::unordered_map<std::string, io::path> by_name;
+        std::unordered_map<std::string, io::path> by_path;
+    };
+}
+
 static std::mutex mutex;
 static std::map<io::path, std::function<std::unique_ptr<io::File>()>> factories;
-static std::set<io::path> directories;
+static std::map<io::path, std::unique_ptr<DirectoryIndex>> directories;
 static bool enabled = true;
 
+DirectoryIndex::DirectoryIndex(const io::path &directory)
+{
+    for (const auto &path : io::recursive_directory_range(directory))
+    {
+        if (io::is_directory(path))
+            continue;
+        by_stem.emplace(algo::lower(path.stem()), path);
+        by_name.emplace(algo::lower(path.name()), path);
+        by_path.emplace(io::path(algo::lower(path.str())).str(), path);
+    }
+}
+
+static std::unique_ptr<io::File> find_in_directories(
+    std::unordered_map<std::string, io::path> DirectoryIndex::*table,
+    const std::string &key)
+{
+    for (auto &kv : directories)
+    {
+        if (!kv.second)
+            kv.second = std::make_unique<DirectoryIndex>(kv.first);
+        const auto &paths = (*kv.second).*table;
+        const auto it = paths.find(key);
+        if (it != paths.end())
+            return std::make_unique<io::File>(it->second, io::FileMode::Read);
+    }
+    return nullptr;
+}
+
 void VirtualFileSystem::disable()
 {
     std::unique_lock<std::mutex> lock(mutex);
@@ -44,6 +86,7 @@ void VirtualFileSystem::enable()
 
 void VirtualFileSystem::clear()
 {
+    std::unique_lock<std::mutex> lock(mutex);
     directories.clear();
     factories.clear();
 }
@@ -66,8 +109,8 @@ void VirtualFileSystem::unregister_file(const io::path &path)
 void VirtualFileSystem::register_directory(const io::path &path)
 {
     std::unique_lock<std::mutex> lock(mutex);
-    if (enabled)
-        directories.insert(path);
+    if (enabled && directories.find(path) == directories.end())
+        directories[path] = nullptr;
 }
 
 void VirtualFileSystem::unregister_directory(const io::path &path)
@@ -76,6 +119,14 @@ void VirtualFileSystem::unregister_directory(const io::path &path)
     directories.erase(path);
 }
 
+void VirtualFileSystem::refresh_directory(const io::path &path)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    const auto it = directories.find(path);
+    if (it != directories.end())
+        it->second = nullptr;
+}
+
 std::unique_ptr<io::File> VirtualFileSystem::get_by_stem(
     const std::string &stem)
 {
@@ -88,12 +139,7 @@ std::unique_ptr<io::File> VirtualFileSystem::get_by_stem(
         if (kv.first.stem() == check)
             return kv.second();
 
-    for (const auto &directory : directories)
-    for (const auto &other_path : io::recursive_directory_range(directory))
-        if (algo::lower(other_path.stem()) == check)
-            return std::make_unique<io::File>(other_path, io::FileMode::Read);
-
-    return nullptr;
+    return find_in_directories(&DirectoryIndex::by_stem, check);
 }
 
 std::unique_ptr<io::File> VirtualFileSystem::get_by_name(
@@ -108,12 +154,7 @@ std::unique_ptr<io::File> VirtualFileSystem::get_by_name(
         if (kv.first.name() == check)
             return kv.second();
 
-    for (const auto &directory : directories)
-    for (const auto &other_path : io::recursive_directory_range(directory))
-        if (algo::lower(other_path.name()) == check)
-            return std::make_unique<io::File>(other_path, io::FileMode::Read);
-
-    return nullptr;
+    return find_in_directories(&DirectoryIndex::by_name, check);
 }
 
 std::unique_ptr<io::File> VirtualFileSystem::get_by_path(const io::path &path)
@@ -126,12 +167,5 @@ std::unique_ptr<io::File> VirtualFileSystem::get_by_path(const io::path &path)
     if (factories.find(check) != factories.end())
         return factories[check]();
 
-    for (const auto &directory : directories)
-    for (const auto &other_path : io::recursive_directory_range(directory))
-    {
-        if (io::path(algo::lower(other_path.str())) == check)
-            return std::make_unique<io::File>(other_path, io::FileMode::Read);
-    }
-
-    return nullptr;
+    return find_in_directories(&DirectoryIndex::by_path, check.str());
 }
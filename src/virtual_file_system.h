@@ -36,8 +36,11 @@ namespace au {
             const std::function<std::unique_ptr<io::File>()> factory);
         static void unregister_file(const io::path &path);
 
+        // Directory contents are indexed on the first lookup and the index
+        // is reused until the directory is refreshed or unregistered.
         static void register_directory(const io::path &path);
         static void unregister_directory(const io::path &path);
+        static void refresh_directory(const io::path &path);
 
         static std::unique_ptr<io::File> get_by_stem(const std::string &stem);
         static std::unique_ptr<io::File> get_by_name(const std::string &name);
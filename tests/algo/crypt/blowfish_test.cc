@@ -42,4 +42,13 @@ TEST_CASE("Blowfish decoding", "[algo][crypt]")
             bf.decrypt(bf.encrypt("1234"_b)),
             "1234\x00\x00\x00\x00"_b);
     }
+
+    SECTION("Decrypting in place")
+    {
+        static const bstr test_key = "test_key"_b;
+        const Blowfish bf(test_key);
+        auto data = bf.encrypt("12345678abcdefgh"_b) + "tail"_b;
+        bf.decrypt_in_place(data.get<u8>(), data.size());
+        tests::compare_binary(data, "12345678abcdefghtail"_b);
+    }
 }
@@ -0,0 +1,155 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "algo/crypt/crc.h"
+#include "algo/range.h"
+#include "io/memory_byte_stream.h"
+#include "test_support/catch.h"
+
+using namespace au;
+using namespace au::algo::crypt;
+
+static const bstr check_input = "123456789"_b;
+
+static u32 reference_crc32(const bstr &input)
+{
+    u32 crc = 0xFFFFFFFF;
+    for (const auto c : input)
+    {
+        crc ^= c;
+        for (const auto i : algo::range(8))
+            crc = (crc >> 1) ^ (crc & 1 ? 0xEDB88320 : 0);
+    }
+    return ~crc;
+}
+
+static bstr make_data(const size_t size)
+{
+    bstr data(size);
+    u32 seed = 1;
+    for (auto &c : data)
+    {
+        seed = seed * 1103515245 + 12345;
+        c = seed >> 16;
+    }
+    return data;
+}
+
+TEST_CASE("CRC", "[algo][crypt]")
+{
+    SECTION("Check values")
+    {
+        REQUIRE(Crc(CrcKind::Crc16Hca).digest() == 0);
+        REQUIRE(crc32(""_b) == 0);
+        REQUIRE(crc32(check_input) == 0xCBF43926);
+
+        Crc crc16(CrcKind::Crc16Hca);
+        crc16.update(check_input);
+        REQUIRE(crc16.digest() == 0xFEE8);
+
+        Crc crc32c(CrcKind::Crc32c);
+        crc32c.update(check_input);
+        REQUIRE(crc32c.digest() == 0xE3069283);
+    }
+
+    SECTION("Custom specs")
+    {
+        Crc crc8({8, 0x07, 0, false, 0});
+        crc8.update(check_input);
+        REQUIRE(crc8.digest() == 0xF4);
+
+        Crc crc16_arc({16, 0x8005, 0, true, 0});
+        crc16_arc.update(check_input);
+        REQUIRE(crc16_arc.digest() == 0xBB3D);
+
+        Crc crc64_xz({
+            64, 0x42F0E1EBA9EA3693, 0xFFFFFFFFFFFFFFFF, true,
+            0xFFFFFFFFFFFFFFFF});
+        crc64_xz.update(check_input);
+        REQUIRE(crc64_xz.digest() == 0x995DC9BBDF1939FA);
+
+        Crc crc64_we({
+            64, 0x42F0E1EBA9EA3693, 0xFFFFFFFFFFFFFFFF, false,
+            0xFFFFFFFFFFFFFFFF});
+        crc64_we.update(check_input);
+        REQUIRE(crc64_we.digest() == 0x62EC59E3F1A4F00A);
+    }
+
+    SECTION("HCA blocks with appended checksum verify to zero")
+    {
+        auto block = make_data(100);
+        Crc crc(CrcKind::Crc16Hca);
+        crc.update(block.get<const u8>(), block.size() - 2);
+        const auto checksum = crc.digest();
+        block[98] = checksum >> 8;
+        block[99] = checksum;
+        REQUIRE(algo::crypt::crc(
+            CrcKind::Crc16Hca, block.get<const u8>(), block.size()) == 0);
+    }
+
+    SECTION("Every size and alignment matches the reference")
+    {
+        const auto data = make_data(600);
+        for (const auto offset : algo::range(4))
+        for (const auto size : algo::range(600 - offset))
+        {
+            const auto input = data.substr(offset, size);
+            INFO("offset " << offset << ", size " << size);
+            REQUIRE(crc32(input) == reference_crc32(input));
+        }
+    }
+
+    SECTION("Incremental updates")
+    {
+        const auto data = make_data(1000);
+        for (const auto kind
+            : {CrcKind::Crc16Hca, CrcKind::Crc32, CrcKind::Crc32c})
+        {
+            const auto expected = algo::crypt::crc(
+                kind, data.get<const u8>(), data.size());
+            Crc crc(kind);
+            for (const auto i : algo::range(0, data.size(), 77))
+            {
+                crc.update(data.substr(i, 77));
+                const auto size = std::min<size_t>(i + 77, data.size());
+                REQUIRE(crc.digest()
+                    == algo::crypt::crc(kind, data.get<const u8>(), size));
+            }
+            REQUIRE(crc.digest() == expected);
+            crc.reset();
+            crc.update(data);
+            REQUIRE(crc.digest() == expected);
+        }
+    }
+
+    SECTION("Checksumming stream copies")
+    {
+        const auto data = make_data(100000);
+        io::MemoryByteStream input_stream(data);
+        io::MemoryByteStream output_stream;
+        Crc crc(CrcKind::Crc32);
+        output_stream.write(
+            input_stream,
+            data.size(),
+            [&](const u8 *chunk, const size_t size)
+            {
+                crc.update(chunk, size);
+            });
+        REQUIRE(output_stream.seek(0).read_to_eof() == data);
+        REQUIRE(crc.digest() == crc32(data));
+    }
+}
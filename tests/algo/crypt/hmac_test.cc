@@ -22,12 +22,42 @@
 using namespace au;
 using namespace au::algo::crypt;
 
+static const bstr expected_hash =
+    "\x28\x7A\x0F\xB8\x9A\x7F\xBD\xFA\x5B\x55\x38\x63\x69\x18\xE5\x37"
+    "\xA5\xB8\x30\x65\xE4\xFF\x33\x12\x68\xB7\xAA\xA1\x15\xDD\xE0\x47"
+    "\xA9\xB0\xF4\xFB\x5B\x82\x86\x08\xFC\x0B\x63\x27\xF1\x00\x55\xF7"
+    "\x63\x7B\x05\x8E\x9E\x0D\xBB\x9E\x69\x89\x01\xA3\xE6\xDD\x46\x1C"_b;
+
 TEST_CASE("HMAC", "[algo][crypt]")
 {
-    tests::compare_binary(
-        algo::crypt::hmac("test"_b, "key"_b, algo::crypt::HmacKind::Sha512),
-        "\x28\x7A\x0F\xB8\x9A\x7F\xBD\xFA\x5B\x55\x38\x63\x69\x18\xE5\x37"
-        "\xA5\xB8\x30\x65\xE4\xFF\x33\x12\x68\xB7\xAA\xA1\x15\xDD\xE0\x47"
-        "\xA9\xB0\xF4\xFB\x5B\x82\x86\x08\xFC\x0B\x63\x27\xF1\x00\x55\xF7"
-        "\x63\x7B\x05\x8E\x9E\x0D\xBB\x9E\x69\x89\x01\xA3\xE6\xDD\x46\x1C"_b);
+    SECTION("Plain HMAC")
+    {
+        tests::compare_binary(
+            algo::crypt::hmac("test"_b, "key"_b, HmacKind::Sha512),
+            expected_hash);
+    }
+
+    SECTION("Reusing the context")
+    {
+        Hmac hmac(HmacKind::Sha512);
+        bstr output(hmac.digest_size());
+        for (const auto &key : {"other key"_b, "key"_b})
+        {
+            hmac.init(key.get<const u8>(), key.size());
+            hmac.update("te"_b.get<const u8>(), 2);
+            hmac.update("st"_b.get<const u8>(), 2);
+            hmac.finalize(output.get<u8>());
+        }
+        tests::compare_binary(output, expected_hash);
+    }
+
+    SECTION("Keys longer than the block size")
+    {
+        bstr key(200);
+        for (auto &c : key)
+            c = 'k';
+        tests::compare_binary(
+            algo::crypt::hmac("test"_b, key, HmacKind::Sha512).substr(0, 4),
+            "\x5B\xF7\x23\xC3"_b);
+    }
 }
@@ -39,4 +39,15 @@ TEST_CASE("MD5", "[algo][crypt]")
             "\x7E\x8E\xFD\x2F\x05\x58\x82\x92"
             "\x58\xC8\x1F\xC9\x59\x81\xCF\xFF"_b);
     }
+
+    SECTION("Streaming")
+    {
+        Md5 md5({0, 0, 0, 0});
+        md5.update("te"_b);
+        md5.update("st"_b);
+        const auto expected_hash = algo::crypt::md5("test"_b, {0, 0, 0, 0});
+        tests::compare_binary(md5.finalize(), expected_hash);
+        md5.update("test"_b);
+        tests::compare_binary(md5.finalize(), expected_hash);
+    }
 }
@@ -22,13 +22,27 @@
 using namespace au;
 using namespace au::algo::crypt;
 
+static const bstr expected_hash =
+    "\xA9\x4A\x8F\xE5"
+    "\xCC\xB1\x9B\xA6"
+    "\x1C\x4C\x08\x73"
+    "\xD3\x91\xE9\x87"
+    "\x98\x2F\xBB\xD3"_b;
+
 TEST_CASE("SHA1", "[algo][crypt]")
 {
-    tests::compare_binary(
-        algo::crypt::sha1("test"_b),
-        "\xA9\x4A\x8F\xE5"
-        "\xCC\xB1\x9B\xA6"
-        "\x1C\x4C\x08\x73"
-        "\xD3\x91\xE9\x87"
-        "\x98\x2F\xBB\xD3"_b);
+    SECTION("Plain SHA1")
+    {
+        tests::compare_binary(algo::crypt::sha1("test"_b), expected_hash);
+    }
+
+    SECTION("Streaming")
+    {
+        Sha1 sha1;
+        sha1.update("te"_b);
+        sha1.update("st"_b);
+        tests::compare_binary(sha1.finalize(), expected_hash);
+        sha1.update("test"_b);
+        tests::compare_binary(sha1.finalize(), expected_hash);
+    }
 }
@@ -0,0 +1,173 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "algo/crypt/xor.h"
+#include "algo/binary.h"
+#include "algo/range.h"
+#include "err.h"
+#include "test_support/catch.h"
+
+using namespace au;
+using namespace au::algo::crypt;
+
+static const std::vector<size_t> sizes = {0, 1, 7, 63, 64, 65, 255, 4099};
+
+static bstr make_data(const size_t size, u32 seed = 1)
+{
+    bstr data(size);
+    for (auto &c : data)
+    {
+        seed = seed * 1103515245 + 12345;
+        c = seed >> 16;
+    }
+    return data;
+}
+
+static u64 reference_add(const u64 a, const u64 b, const PackedLanes lanes)
+{
+    switch (lanes)
+    {
+        case PackedLanes::U8: return algo::padb(a, b);
+        case PackedLanes::U16: return algo::padw(a, b);
+        case PackedLanes::U32: return algo::padd(a, b);
+        default: return a + b;
+    }
+}
+
+TEST_CASE("XOR kernels", "[algo][crypt]")
+{
+    SECTION("Repeating key")
+    {
+        for (const auto key_size : {1, 3, 8, 17, 256, 300})
+        for (const auto key_pos : {0, 5, 1000})
+        for (const auto size : sizes)
+        {
+            const auto key = make_data(key_size, 7);
+            auto expected = make_data(size);
+            for (const auto i : algo::range(size))
+                expected[i] ^= key[(i + key_pos) % key.size()];
+            auto actual = make_data(size);
+            xor_repeating(actual, key, key_pos);
+            REQUIRE(actual == expected);
+        }
+    }
+
+    SECTION("Empty key")
+    {
+        auto data = make_data(10);
+        REQUIRE_THROWS_AS(xor_repeating(data, ""_b), err::BadDataSizeError);
+    }
+
+    SECTION("Single byte")
+    {
+        for (const auto size : sizes)
+        {
+            auto expected = make_data(size);
+            for (auto &c : expected)
+                c ^= 0x5A;
+            auto actual = make_data(size);
+            xor_byte(actual, 0x5A);
+            REQUIRE(actual == expected);
+        }
+    }
+
+    SECTION("Rolling key")
+    {
+        for (const auto size : sizes)
+        {
+            auto expected = make_data(size);
+            u8 key = 0xC5;
+            for (auto &c : expected)
+            {
+                c ^= key;
+                key += 0x5C;
+            }
+            auto actual = make_data(size);
+            xor_rolling(actual.get<u8>(), actual.size(), 0xC5, 0x5C);
+            REQUIRE(actual == expected);
+        }
+    }
+
+    SECTION("Packed-add keystream")
+    {
+        for (const auto lanes : {
+            PackedLanes::U8, PackedLanes::U16, PackedLanes::U32,
+            PackedLanes::U64})
+        for (const auto size : sizes)
+        {
+            auto expected = make_data(size);
+            u64 key = 0xA73C5F9DA73C5F9D;
+            for (const auto i : algo::range(size / 8))
+            {
+                key = reference_add(key, 0xCE24F523CE24F523, lanes);
+                expected.get<u64>()[i] ^= key;
+            }
+            auto actual = make_data(size);
+            xor_packed_add(
+                actual.get<u8>(),
+                actual.size(),
+                0xA73C5F9DA73C5F9D,
+                0xCE24F523CE24F523,
+                lanes);
+            REQUIRE(actual == expected);
+        }
+    }
+
+    SECTION("Chained packed-add keystream")
+    {
+        for (const auto lanes : {
+            PackedLanes::U8, PackedLanes::U16, PackedLanes::U32,
+            PackedLanes::U64})
+        for (const auto size : sizes)
+        {
+            auto expected = make_data(size);
+            u64 key = 0xA73C5F9DA73C5F9D;
+            u64 feedback = 0x1234567812345678;
+            for (const auto i : algo::range(size / 8))
+            {
+                key = reference_add(key, 0xCE24F523CE24F523, lanes);
+                key ^= feedback;
+                feedback = expected.get<u64>()[i] ^= key;
+            }
+            auto actual = make_data(size);
+            xor_packed_add_chained(
+                actual.get<u8>(),
+                actual.size(),
+                0xA73C5F9DA73C5F9D,
+                0xCE24F523CE24F523,
+                0x1234567812345678,
+                lanes);
+            REQUIRE(actual == expected);
+        }
+    }
+
+    SECTION("Byte transforms")
+    {
+        u8 table[0x100];
+        for (const auto i : algo::range(0x100))
+            table[i] = algo::rotr<u8>((i - 0x7C) ^ 0x35, 3);
+        for (const auto size : sizes)
+        {
+            auto expected = make_data(size);
+            for (auto &c : expected)
+                c = algo::rotr<u8>((c - 0x7C) ^ 0x35, 3);
+            auto actual = make_data(size);
+            transform_bytes(actual.get<u8>(), actual.size(), table);
+            REQUIRE(actual == expected);
+        }
+    }
+}
@@ -0,0 +1,154 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "algo/pack/huffman_table.h"
+#include "algo/range.h"
+#include "err.h"
+#include "io/memory_byte_stream.h"
+#include "test_support/catch.h"
+
+using namespace au;
+using namespace au::algo::pack;
+
+static bstr encode(
+    const std::vector<HuffmanTable::Code> &codes,
+    const std::vector<u32> &symbols)
+{
+    io::MemoryByteStream output_stream;
+    {
+        io::MsbBitStream bit_stream(output_stream);
+        for (const auto symbol : symbols)
+        for (const auto &code : codes)
+            if (code.symbol == symbol)
+                bit_stream.write(code.size, code.bits);
+    }
+    return output_stream.seek(0).read_to_eof();
+}
+
+static void test_round_trip(
+    const HuffmanTable &table,
+    const std::vector<HuffmanTable::Code> &codes,
+    const std::vector<u32> &symbols)
+{
+    io::MsbBitStream bit_stream(encode(codes, symbols));
+    for (const auto symbol : symbols)
+        REQUIRE(table.decode(bit_stream) == symbol);
+}
+
+TEST_CASE("Table Huffman decoding", "[algo][pack]")
+{
+    std::vector<u32> symbols;
+    for (const auto i : algo::range(1000))
+        symbols.push_back((i * 7 + i / 3) % 13);
+
+    SECTION("Canonical codes")
+    {
+        std::vector<size_t> code_sizes {2, 1, 3, 3};
+        const auto table = HuffmanTable::from_code_sizes(code_sizes);
+        const std::vector<HuffmanTable::Code> codes
+        {
+            {0b10, 2, 0},
+            {0b0, 1, 1},
+            {0b110, 3, 2},
+            {0b111, 3, 3},
+        };
+        test_round_trip(table, codes, {0, 1, 2, 3, 3, 1, 0, 2, 1, 1});
+    }
+
+    SECTION("Codes longer than the primary table")
+    {
+        // 0, 10, 110, ..., so that codes get up to 12 bits long
+        std::vector<HuffmanTable::Code> codes;
+        for (const auto i : algo::range(13))
+        {
+            const auto size = std::min<size_t>(i + 1, 12);
+            const auto bits = ((1 << size) - 2) | (i == 12 ? 1 : 0);
+            codes.push_back(
+                {static_cast<u32>(bits), size, static_cast<u32>(i)});
+        }
+        for (const auto table_bits : {1, 3, 9, 16})
+        {
+            const HuffmanTable table(codes, table_bits);
+            test_round_trip(table, codes, symbols);
+        }
+    }
+
+    SECTION("Arbitrary trees")
+    {
+        // inner nodes 10 and 11, leaves 0 to 2
+        const auto table = HuffmanTable::from_tree(
+            10,
+            [](const u32 node) { return node < 10; },
+            [](const u32 node, const u32 bit)
+            {
+                if (node == 10)
+                    return bit ? 11u : 2u;
+                return bit ? 1u : 0u;
+            });
+        const std::vector<HuffmanTable::Code> codes
+        {
+            {0b10, 2, 0},
+            {0b11, 2, 1},
+            {0b0, 1, 2},
+        };
+        test_round_trip(table, codes, {2, 0, 1, 1, 2, 2, 0});
+    }
+
+    SECTION("Single symbol trees consume no bits")
+    {
+        const auto table = HuffmanTable::from_tree(
+            5,
+            [](const u32 node) { return true; },
+            [](const u32 node, const u32 bit) { return node; });
+        io::MsbBitStream bit_stream("\xFF"_b);
+        REQUIRE(table.decode(bit_stream) == 5);
+        REQUIRE(bit_stream.pos() == 0);
+    }
+
+    SECTION("Unreachable branches")
+    {
+        const auto table = HuffmanTable::from_tree(
+            10,
+            [](const u32 node) { return node < 10; },
+            [](const u32 node, const u32 bit)
+            {
+                return bit ? HuffmanTable::invalid_node : 3u;
+            });
+        io::MsbBitStream bit_stream("\x7F"_b);
+        REQUIRE(table.decode(bit_stream) == 3);
+        REQUIRE_THROWS_AS(table.decode(bit_stream), err::CorruptDataError);
+    }
+
+    SECTION("Ambiguous codes")
+    {
+        const std::vector<HuffmanTable::Code> codes
+        {
+            {0b1, 1, 0},
+            {0b10, 2, 1},
+        };
+        REQUIRE_THROWS_AS(HuffmanTable(codes), err::CorruptDataError);
+    }
+
+    SECTION("Truncated input")
+    {
+        const auto table = HuffmanTable::from_code_sizes({1, 2, 2});
+        io::MsbBitStream bit_stream("\xFF"_b);
+        for (const auto i : algo::range(4))
+            REQUIRE(table.decode(bit_stream) == 2);
+        REQUIRE_THROWS_AS(table.decode(bit_stream), err::EofError);
+    }
+}
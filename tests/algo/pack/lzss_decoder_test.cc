@@ -0,0 +1,173 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "algo/pack/lzss_decoder.h"
+#include "algo/range.h"
+#include "test_support/catch.h"
+#include "test_support/common.h"
+
+using namespace au;
+using namespace au::algo::pack;
+
+namespace
+{
+    struct InvertedFormat final : BaseLzssFormat
+    {
+        static const bool msb_first_flags = true;
+        static const bool literal_flag = false;
+        static const u8 input_xor = 0xFF;
+    };
+
+    struct RelativeFormat final : BaseLzssFormat
+    {
+        static const size_t dictionary_size = 0x100;
+        static const u8 dictionary_fill = 0x20;
+        static const bool relative_offsets = true;
+
+        static inline bool read_match(
+            const u8 *&input_ptr,
+            const u8 *input_end,
+            size_t &offset,
+            size_t &size)
+        {
+            if (input_end - input_ptr < 2)
+                return false;
+            offset = input_ptr[0] + 1;
+            size = (input_ptr[1] & 0x1F) + 1;
+            input_ptr += 2;
+            return true;
+        }
+    };
+
+    // Plain ring buffer decoder the fast paths are checked against
+    template<typename Format> class ReferenceDecoder final
+    {
+    public:
+        ReferenceDecoder() :
+            dict(Format::dictionary_size, Format::dictionary_fill),
+            dict_pos(Format::initial_dictionary_pos)
+        {
+        }
+
+        bstr decode(const bstr &input, const size_t output_size)
+        {
+            const auto mask = dict.size() - 1;
+            auto input_ptr = input.get<const u8>();
+            const auto input_end = input.end<const u8>();
+            bstr output(output_size);
+            size_t output_pos = 0;
+            u8 flags = 0;
+            size_t flags_left = 0;
+            while (output_pos < output_size)
+            {
+                if (!flags_left)
+                {
+                    if (input_ptr == input_end)
+                        break;
+                    flags = *input_ptr++ ^ Format::input_xor;
+                    flags_left = 8;
+                }
+                const bool flag = Format::msb_first_flags
+                    ? (flags >> (flags_left - 1)) & 1
+                    : (flags >> (8 - flags_left)) & 1;
+                flags_left--;
+                if (flag == Format::literal_flag)
+                {
+                    if (input_ptr == input_end)
+                        break;
+                    const u8 c = *input_ptr++ ^ Format::input_xor;
+                    output[output_pos++] = dict[dict_pos++ & mask] = c;
+                    continue;
+                }
+                size_t offset, size;
+                if (!Format::read_match(input_ptr, input_end, offset, size))
+                    break;
+                auto source_pos = Format::relative_offsets
+                    ? dict_pos - offset
+                    : offset;
+                while (size-- && output_pos < output_size)
+                {
+                    const u8 c = dict[source_pos++ & mask];
+                    output[output_pos++] = dict[dict_pos++ & mask] = c;
+                }
+            }
+            return output;
+        }
+
+    private:
+        std::vector<u8> dict;
+        size_t dict_pos;
+    };
+}
+
+static bstr make_input(const size_t size, u32 seed)
+{
+    bstr input(size);
+    for (const auto i : algo::range(size))
+    {
+        seed = seed * 1103515245 + 12345;
+        input[i] = seed >> 16;
+    }
+    return input;
+}
+
+template<typename Format> static void test_format()
+{
+    LzssDecoder<Format> decoder;
+    ReferenceDecoder<Format> reference_decoder;
+    // the second round continues the dictionary of the first one
+    for (const auto round : algo::range(2))
+    {
+        const auto input = make_input(0x3000, round + 1);
+        const auto expected = reference_decoder.decode(input, 0x8000);
+        const auto actual = decoder.decode(input, 0x8000);
+        tests::compare_binary(actual, expected);
+    }
+}
+
+TEST_CASE("LZSS decoding engine", "[algo][pack]")
+{
+    SECTION("Classic layout")
+    {
+        test_format<BaseLzssFormat>();
+    }
+
+    SECTION("Inverted flags and input")
+    {
+        test_format<InvertedFormat>();
+    }
+
+    SECTION("Relative offsets")
+    {
+        test_format<RelativeFormat>();
+    }
+
+    SECTION("Truncated input")
+    {
+        LzssDecoder<BaseLzssFormat> decoder;
+        bstr output(10);
+        size_t output_size = output.size();
+        const auto input = "\x03" "ab\x01"_b;
+        REQUIRE(decoder.decode(
+            input.get<const u8>(),
+            input.size(),
+            output.get<u8>(),
+            output_size) == 3);
+        REQUIRE(output_size == 2);
+        REQUIRE(output.substr(0, 2) == "ab"_b);
+    }
+}
@@ -0,0 +1,112 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "algo/parallel.h"
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+#include "algo/range.h"
+#include "err.h"
+#include "test_support/catch.h"
+
+using namespace au;
+
+namespace
+{
+    class Helpers final
+    {
+    public:
+        Helpers(const size_t count) : running(true)
+        {
+            for (const auto i : algo::range(count))
+            {
+                threads.push_back(std::thread([&]()
+                {
+                    while (running)
+                        algo::help_parallel_for(std::chrono::milliseconds(1));
+                }));
+            }
+        }
+
+        ~Helpers()
+        {
+            running = false;
+            for (auto &thread : threads)
+                thread.join();
+        }
+
+    private:
+        std::atomic<bool> running;
+        std::vector<std::thread> threads;
+    };
+}
+
+TEST_CASE("Parallel for", "[algo]")
+{
+    std::vector<int> output(100);
+    const auto func = [&](const size_t i) { output[i] = i * 2; };
+
+    SECTION("Without helpers")
+    {
+        std::set<std::thread::id> thread_ids;
+        algo::parallel_for(output.size(), [&](const size_t i)
+        {
+            func(i);
+            thread_ids.insert(std::this_thread::get_id());
+        });
+        REQUIRE(thread_ids.size() == 1);
+        REQUIRE(*thread_ids.begin() == std::this_thread::get_id());
+    }
+
+    SECTION("With helpers")
+    {
+        Helpers helpers(3);
+        algo::parallel_for(output.size(), func);
+    }
+
+    SECTION("Nested")
+    {
+        Helpers helpers(3);
+        algo::parallel_for(10, [&](const size_t i)
+        {
+            algo::parallel_for(10, [&](const size_t j)
+            {
+                func(i * 10 + j);
+            });
+        });
+    }
+
+    for (const auto i : algo::range(output.size()))
+        REQUIRE(output[i] == i * 2);
+}
+
+TEST_CASE("Parallel for errors", "[algo]")
+{
+    Helpers helpers(3);
+    std::atomic<size_t> call_count(0);
+    REQUIRE_THROWS_AS(
+        algo::parallel_for(1000, [&](const size_t i)
+        {
+            call_count++;
+            if (i == 5)
+                throw err::CorruptDataError("Broken block");
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }),
+        err::CorruptDataError);
+    REQUIRE(call_count < 1000);
+}
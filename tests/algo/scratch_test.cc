@@ -0,0 +1,95 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "algo/scratch.h"
+#include <thread>
+#include "test_support/catch.h"
+
+using namespace au;
+
+TEST_CASE("Scratch buffers", "[algo]")
+{
+    algo::trim_scratch();
+
+    SECTION("Buffers are zeroed by default")
+    {
+        {
+            algo::ScratchBuffer buffer(100);
+            for (auto &c : *buffer)
+                c = 0xFF;
+        }
+        algo::ScratchBuffer buffer(50);
+        REQUIRE(*buffer == bstr(50));
+    }
+
+    SECTION("Returned buffers are reused")
+    {
+        const u8 *ptr;
+        {
+            algo::ScratchBuffer buffer(1000);
+            ptr = buffer->get<const u8>();
+        }
+        const auto stats_before = algo::get_scratch_stats();
+        {
+            algo::ScratchBuffer buffer(500, false);
+            REQUIRE(buffer->size() == 500);
+            REQUIRE(buffer->get<const u8>() == ptr);
+        }
+        const auto stats_after = algo::get_scratch_stats();
+        REQUIRE(stats_after.borrow_count == stats_before.borrow_count + 1);
+        REQUIRE(stats_after.allocation_count == stats_before.allocation_count);
+    }
+
+    SECTION("Nested buffers are distinct")
+    {
+        algo::ScratchBuffer buffer1(100);
+        algo::ScratchBuffer buffer2(100);
+        REQUIRE(buffer1->get<const u8>() != buffer2->get<const u8>());
+    }
+
+    SECTION("Pools are per thread")
+    {
+        const u8 *ptr;
+        {
+            algo::ScratchBuffer buffer(1000);
+            ptr = buffer->get<const u8>();
+        }
+        const u8 *other_ptr = nullptr;
+        std::thread thread([&]()
+        {
+            algo::ScratchBuffer buffer(1000);
+            other_ptr = buffer->get<const u8>();
+        });
+        thread.join();
+        REQUIRE(other_ptr != ptr);
+    }
+
+    SECTION("Trimming drops buffers beyond the budget")
+    {
+        {
+            algo::ScratchBuffer buffer(128 * 1024 * 1024, false);
+        }
+        algo::trim_scratch();
+        const auto stats_before = algo::get_scratch_stats();
+        algo::ScratchBuffer buffer(128 * 1024 * 1024, false);
+        const auto stats_after = algo::get_scratch_stats();
+        REQUIRE(stats_after.allocation_count
+            == stats_before.allocation_count + 1);
+    }
+
+    algo::trim_scratch();
+}
@@ -56,7 +56,7 @@ TEST_CASE("Aoi AGF images", "[dec]")
         }
 
         input_file.stream.seek(8).write_le<u32>(input_file.stream.size());
-        const auto expected_image = input_image;
+        const auto expected_image = input_image.clone();
         const auto actual_image = tests::decode(decoder, input_file);
         tests::compare_images(actual_image, expected_image);
     }
@@ -96,7 +96,7 @@ TEST_CASE("Aoi AGF images", "[dec]")
         }
 
         input_file.stream.seek(8).write_le<u32>(input_file.stream.size());
-        const auto expected_image = input_image;
+        const auto expected_image = input_image.clone();
         const auto actual_image = tests::decode(decoder, input_file);
         tests::compare_images(actual_image, expected_image);
     }
@@ -137,7 +137,7 @@ TEST_CASE("Aoi AGF images", "[dec]")
         }
 
         input_file.stream.seek(8).write_le<u32>(input_file.stream.size());
-        const auto expected_image = input_image;
+        const auto expected_image = input_image.clone();
         const auto actual_image = tests::decode(decoder, input_file);
         tests::compare_images(actual_image, expected_image);
     }
@@ -183,7 +183,7 @@ TEST_CASE("Aoi AGF images", "[dec]")
         }
 
         input_file.stream.seek(8).write_le<u32>(input_file.stream.size());
-        const auto expected_image = input_image;
+        const auto expected_image = input_image.clone();
         const auto actual_image = tests::decode(decoder, input_file);
         tests::compare_images(actual_image, expected_image);
     }
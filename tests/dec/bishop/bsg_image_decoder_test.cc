@@ -119,7 +119,7 @@ TEST_CASE("Bishop BSG images", "[dec]")
             expected_image.width() * expected_image.height() * 4);
         input_file.stream.write_le<u32>(0);
         const auto data_offset = input_file.stream.pos();
-        auto tmp_image = expected_image;
+        auto tmp_image = expected_image.clone();
         tmp_image.flip_vertically();
         for (const auto &p : tmp_image) input_file.stream.write<u8>(p.b);
         for (const auto &p : tmp_image) input_file.stream.write<u8>(p.g);
@@ -139,7 +139,7 @@ TEST_CASE("Bishop BSG images", "[dec]")
             expected_image.width() * expected_image.height() * 3);
         input_file.stream.write_le<u32>(0);
         const auto data_offset = input_file.stream.pos();
-        auto tmp_image = expected_image;
+        auto tmp_image = expected_image.clone();
         tmp_image.flip_vertically();
         for (const auto &p : tmp_image) input_file.stream.write<u8>(p.b);
         for (const auto &p : tmp_image) input_file.stream.write<u8>(p.g);
@@ -150,7 +150,7 @@ TEST_CASE("Bishop BSG images", "[dec]")
     SECTION("Uncompressed, palette")
     {
         const auto palette_result = tests::get_palette_test_image();
-        expected_image = std::get<0>(palette_result);
+        expected_image = std::get<0>(palette_result).clone();
         const auto palette_indices = std::get<1>(palette_result);
         const auto input_palette = std::get<2>(palette_result);
         write_header(
@@ -189,7 +189,7 @@ TEST_CASE("Bishop BSG images", "[dec]")
             expected_image.width() * expected_image.height() * 3);
         input_file.stream.write_le<u32>(0);
         const auto data_offset = input_file.stream.pos();
-        auto tmp_image = expected_image;
+        auto tmp_image = expected_image.clone();
         tmp_image.flip_vertically();
         for (const auto i : algo::range(3))
         {
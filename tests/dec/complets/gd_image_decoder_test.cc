@@ -160,7 +160,7 @@ static void do_test(const bstr &magic, const size_t width, const size_t height)
             c.b--;
     }
 
-    res::Image input_image = expected_image;
+    auto input_image = expected_image.clone();
     input_image.flip_vertically();
 
     io::File input_file;
@@ -0,0 +1,188 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "dec/derived_key_cache.h"
+#include <atomic>
+#include <thread>
+#include "algo/range.h"
+#include "err.h"
+#include "io/file_byte_stream.h"
+#include "io/file_system.h"
+#include "test_support/catch.h"
+
+using namespace au;
+
+static const io::path source_path = "tests/trash.src";
+static const io::path other_source_path = "tests/trash-other.src";
+static const io::path cache_path = "tests/trash.out";
+
+static void write_file(const io::path &path, const bstr &content)
+{
+    io::FileByteStream stream(path, io::FileMode::Write);
+    stream.write(content);
+}
+
+TEST_CASE("Derived key cache", "[dec]")
+{
+    dec::DerivedKeyCache::clear();
+    write_file(source_path, "source"_b);
+    write_file(other_source_path, "other source"_b);
+    const std::vector<io::path> source_paths = {source_path};
+
+    size_t derive_count = 0;
+    const auto derive_func = [&]()
+    {
+        derive_count++;
+        return "key"_b;
+    };
+
+    SECTION("Keys are derived once")
+    {
+        REQUIRE(dec::DerivedKeyCache::get("a", source_paths, derive_func)
+            == "key"_b);
+        REQUIRE(dec::DerivedKeyCache::get("a", source_paths, derive_func)
+            == "key"_b);
+        REQUIRE(derive_count == 1);
+        dec::DerivedKeyCache::get("b", source_paths, derive_func);
+        dec::DerivedKeyCache::get("a", {other_source_path}, derive_func);
+        REQUIRE(derive_count == 3);
+    }
+
+    SECTION("Keys derived from no source files are not cached")
+    {
+        dec::DerivedKeyCache::get("a", {}, derive_func);
+        dec::DerivedKeyCache::get("a", {}, derive_func);
+        REQUIRE(derive_count == 2);
+    }
+
+    SECTION("Errors are not cached")
+    {
+        REQUIRE_THROWS(dec::DerivedKeyCache::get("a", source_paths, []()
+            -> bstr
+            {
+                throw err::FileNotFoundError("No executables found");
+            }));
+        dec::DerivedKeyCache::get("a", source_paths, derive_func);
+        REQUIRE(derive_count == 1);
+    }
+
+    SECTION("Concurrent callers share the derivation")
+    {
+        std::atomic<size_t> concurrent_count(0);
+        std::vector<std::thread> threads;
+        for (const auto i : algo::range(4))
+        {
+            threads.push_back(std::thread([&]()
+            {
+                dec::DerivedKeyCache::get("a", source_paths, [&]()
+                {
+                    concurrent_count++;
+                    std::this_thread::sleep_for(
+                        std::chrono::milliseconds(20));
+                    return ""_b;
+                });
+            }));
+        }
+        for (auto &thread : threads)
+            thread.join();
+        REQUIRE(concurrent_count == 1);
+    }
+
+    SECTION("Changed source files invalidate cached keys")
+    {
+        dec::DerivedKeyCache::get("a", source_paths, derive_func);
+        write_file(source_path, "changed source"_b);
+        dec::DerivedKeyCache::get("a", source_paths, derive_func);
+        REQUIRE(derive_count == 2);
+    }
+
+    SECTION("Added source files invalidate cached keys")
+    {
+        dec::DerivedKeyCache::get("a", source_paths, derive_func);
+        dec::DerivedKeyCache::get(
+            "a", {source_path, other_source_path}, derive_func);
+        REQUIRE(derive_count == 2);
+    }
+
+    SECTION("Persisting keys")
+    {
+        dec::DerivedKeyCache::get(
+            "a", source_paths, []() { return "persisted"_b; });
+        dec::DerivedKeyCache::save(cache_path);
+
+        dec::DerivedKeyCache::clear();
+        REQUIRE(dec::DerivedKeyCache::load(cache_path));
+        REQUIRE(dec::DerivedKeyCache::get("a", source_paths, derive_func)
+            == "persisted"_b);
+        REQUIRE(derive_count == 0);
+
+        SECTION("Changed source files invalidate persisted keys")
+        {
+            write_file(source_path, "changed source"_b);
+            dec::DerivedKeyCache::clear();
+            REQUIRE(dec::DerivedKeyCache::load(cache_path));
+            REQUIRE(dec::DerivedKeyCache::get("a", source_paths, derive_func)
+                == "key"_b);
+            REQUIRE(derive_count == 1);
+        }
+    }
+
+    SECTION("Corrupt persisted keys are ignored")
+    {
+        dec::DerivedKeyCache::get(
+            "a", source_paths, []() { return "persisted"_b; });
+        dec::DerivedKeyCache::save(cache_path);
+        const auto content = io::FileByteStream(
+            cache_path, io::FileMode::Read).read_to_eof();
+
+        SECTION("Bad magic")
+        {
+            write_file(cache_path, "garbage"_b);
+        }
+
+        SECTION("Huge slot count")
+        {
+            write_file(
+                cache_path, content.substr(0, 8) + "\xFF\xFF\xFF\x7F"_b);
+        }
+
+        SECTION("Huge string size")
+        {
+            write_file(
+                cache_path,
+                content.substr(0, 12) + "\xFF\xFF\xFF\x7F"_b
+                    + content.substr(16));
+        }
+
+        SECTION("Truncated file")
+        {
+            write_file(cache_path, content.substr(0, content.size() - 1));
+        }
+
+        dec::DerivedKeyCache::clear();
+        REQUIRE(!dec::DerivedKeyCache::load(cache_path));
+        REQUIRE(dec::DerivedKeyCache::get("a", source_paths, derive_func)
+            == "key"_b);
+        REQUIRE(derive_count == 1);
+    }
+
+    if (io::exists(cache_path))
+        io::remove(cache_path);
+    io::remove(source_path);
+    io::remove(other_source_path);
+    dec::DerivedKeyCache::clear();
+}
@@ -63,7 +63,7 @@ TEST_CASE("GPK2 GFB images", "[dec]")
         input_file.stream.write(data);
         input_file.stream.seek(12).write_le<u32>(data.size());
 
-        const auto expected_image = input_image;
+        const auto expected_image = input_image.clone();
         const auto actual_image = tests::decode(decoder, input_file);
         tests::compare_images(actual_image, expected_image);
     }
@@ -94,7 +94,7 @@ TEST_CASE("GPK2 GFB images", "[dec]")
             input_file.stream.write<u8>(input_image.at(x, y).r);
         }
 
-        const auto expected_image = input_image;
+        const auto expected_image = input_image.clone();
         const auto actual_image = tests::decode(decoder, input_file);
         tests::compare_images(actual_image, expected_image);
     }
@@ -126,7 +126,7 @@ TEST_CASE("GPK2 GFB images", "[dec]")
             input_file.stream.write<u8>(0);
         }
 
-        const auto expected_image = input_image;
+        const auto expected_image = input_image.clone();
         const auto actual_image = tests::decode(decoder, input_file);
         tests::compare_images(actual_image, expected_image);
     }
@@ -159,7 +159,7 @@ TEST_CASE("GPK2 GFB images", "[dec]")
             input_file.stream.write<u8>(x ^ y);
         }
 
-        auto expected_image = input_image;
+        auto expected_image = input_image.clone();
         for (const auto y : algo::range(input_image.height() - 1, -1, -1))
         for (const auto x : algo::range(input_image.width()))
             expected_image.at(x, y).a = x ^ y;
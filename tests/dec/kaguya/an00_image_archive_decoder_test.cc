@@ -26,11 +26,9 @@ using namespace au::dec::kaguya;
 
 TEST_CASE("Atelier Kaguya AN00 image archives", "[dec]")
 {
-    const std::vector<res::Image> expected_images =
-    {
-        tests::get_transparent_test_image(),
-        tests::get_opaque_test_image(),
-    };
+    std::vector<res::Image> expected_images;
+    expected_images.push_back(tests::get_transparent_test_image());
+    expected_images.push_back(tests::get_opaque_test_image());
     io::File input_file;
     input_file.stream.write("AN00"_b);
     input_file.stream.write_le<u32>(0);
@@ -49,7 +47,7 @@ TEST_CASE("Atelier Kaguya AN00 image archives", "[dec]")
         input_file.stream.write_le<u32>('?');
         input_file.stream.write_le<u32>(image.width());
         input_file.stream.write_le<u32>(image.height());
-        res::Image flipped_image(image);
+        auto flipped_image = image.clone();
         flipped_image.flip_vertically();
         tests::write_32_bit_image(input_file.stream, flipped_image);
     }
@@ -44,13 +44,10 @@ TEST_CASE("Kaguya AO images", "[dec]")
         input_file.stream.write<u8>(input_image.at(x, y).r);
         input_file.stream.write<u8>(input_image.at(x, y).a);
     }
-    const auto expected_image
-        = res::Image(input_image.width() + 1, input_image.height() + 2)
-            .overlay(
-                input_image,
-                1,
-                2,
-                res::Image::OverlayKind::OverwriteNonTransparent);
+    res::Image expected_image(
+        input_image.width() + 1, input_image.height() + 2);
+    expected_image.overlay(
+        input_image, 1, 2, res::Image::OverlayKind::OverwriteNonTransparent);
     const auto actual_image = tests::decode(decoder, input_file);
     tests::compare_images(actual_image, expected_image);
 }
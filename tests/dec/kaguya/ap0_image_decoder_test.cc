@@ -37,7 +37,7 @@ TEST_CASE("Kaguya AP0 images", "[dec]")
     for (const auto x : algo::range(input_image.width()))
         input_file.stream.write<u8>(input_image.at(x, y).a);
 
-    auto expected_image = input_image;
+    auto expected_image = input_image.clone();
     for (const auto y : algo::range(input_image.height() - 1, -1, -1))
     for (const auto x : algo::range(input_image.width()))
     {
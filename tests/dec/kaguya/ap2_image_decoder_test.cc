@@ -55,7 +55,7 @@ TEST_CASE("Kaguya AP2 images", "[dec]")
         input_file.stream.write<u8>(input_image.at(x, y).a);
     }
 
-    const auto expected_image = input_image;
+    const auto expected_image = input_image.clone();
     const auto actual_image = tests::decode(decoder, input_file);
     tests::compare_images(actual_image, expected_image);
 }
@@ -100,7 +100,7 @@ TEST_CASE("Kaguya APS3 images", "[dec]")
         input_file.stream.write(data_comp);
     }
 
-    const auto expected_image = input_image;
+    const auto expected_image = input_image.clone();
     const auto actual_image = tests::decode(decoder, input_file);
     tests::compare_images(actual_image, expected_image);
 }
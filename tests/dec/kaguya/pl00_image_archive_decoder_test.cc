@@ -26,11 +26,9 @@ using namespace au::dec::kaguya;
 
 TEST_CASE("Atelier Kaguya PL00 image archives", "[dec]")
 {
-    const std::vector<res::Image> expected_images =
-    {
-        tests::get_opaque_test_image(),
-        tests::get_transparent_test_image(),
-    };
+    std::vector<res::Image> expected_images;
+    expected_images.push_back(tests::get_opaque_test_image());
+    expected_images.push_back(tests::get_transparent_test_image());
 
     io::File input_file;
     input_file.stream.write("PL00"_b);
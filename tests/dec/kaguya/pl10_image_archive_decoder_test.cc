@@ -39,12 +39,10 @@ static void mutate_image(res::Image &image)
 
 TEST_CASE("Atelier Kaguya PL10 image archives", "[dec]")
 {
-    std::vector<res::Image> expected_images =
-    {
-        tests::get_transparent_test_image(),
-        tests::get_transparent_test_image(),
-        tests::get_transparent_test_image(),
-    };
+    std::vector<res::Image> expected_images;
+    expected_images.push_back(tests::get_transparent_test_image());
+    expected_images.push_back(tests::get_transparent_test_image());
+    expected_images.push_back(tests::get_transparent_test_image());
     mutate_image(expected_images[1]);
     mutate_image(expected_images[2]);
 
@@ -66,7 +64,7 @@ TEST_CASE("Atelier Kaguya PL10 image archives", "[dec]")
         input_file.stream.write_le<u32>(base_image.height());
         input_file.stream.write_le<u32>(4);
 
-        res::Image flipped_image(base_image);
+        auto flipped_image = base_image.clone();
         flipped_image.flip_vertically();
         tests::write_32_bit_image(input_file.stream, flipped_image);
 
@@ -77,7 +75,7 @@ TEST_CASE("Atelier Kaguya PL10 image archives", "[dec]")
 
     for (const auto i : algo::range(1, expected_images.size()))
     {
-        res::Image flipped_image(expected_images[i]);
+        auto flipped_image = expected_images[i].clone();
         flipped_image.flip_vertically();
 
         io::MemoryByteStream tmp_stream;
@@ -36,7 +36,7 @@ TEST_CASE("Kaguya raw mask images", "[dec]")
     for (const auto x : algo::range(input_image.width()))
         input_file.stream.write<u8>(input_image.at(x, y).a);
 
-    auto expected_image = input_image;
+    auto expected_image = input_image.clone();
     for (auto &c : expected_image)
     {
         c.r = c.g = c.b = c.a;
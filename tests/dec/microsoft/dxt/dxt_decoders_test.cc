@@ -0,0 +1,151 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "dec/microsoft/dxt/dxt_decoders.h"
+#include "algo/format.h"
+#include "algo/range.h"
+#include "io/memory_byte_stream.h"
+#include "test_support/catch.h"
+
+using namespace au;
+using namespace au::dec::microsoft;
+
+namespace
+{
+    class BlockWriter final
+    {
+    public:
+        BlockWriter(const size_t size) : data(size), pos(0)
+        {
+        }
+
+        BlockWriter &put(const u32 value, const size_t bits)
+        {
+            for (const auto i : algo::range(bits))
+            {
+                if ((value >> i) & 1)
+                    data[pos / 8] |= 1 << (pos % 8);
+                pos++;
+            }
+            return *this;
+        }
+
+        bstr data;
+
+    private:
+        size_t pos;
+    };
+}
+
+static void compare_pixel(const res::Pixel &actual, const res::Pixel &expected)
+{
+    INFO(algo::format(
+        "Actual: %02x%02x%02x%02x, expected: %02x%02x%02x%02x",
+        actual.b, actual.g, actual.r, actual.a,
+        expected.b, expected.g, expected.r, expected.a));
+    REQUIRE(actual == expected);
+}
+
+TEST_CASE("DXT texture blocks", "[dec]")
+{
+    SECTION("DXT1 blocks are placed in the right spots")
+    {
+        BlockWriter writer(8 * 4);
+        for (const auto i : algo::range(4))
+        {
+            writer.put(i == 3 ? 0xF800 : 0x001F, 16);
+            writer.put(i == 3 ? 0x001F : 0xF800, 16);
+            writer.put(i == 3 ? 0x000000E4 : 0, 32);
+        }
+        io::MemoryByteStream input_stream(writer.data);
+        const auto image = dxt::decode_dxt1(input_stream, 5, 6);
+        REQUIRE(image->width() == 8);
+        REQUIRE(image->height() == 8);
+        compare_pixel(image->at(0, 0), {0xF8, 0, 0, 0xFF});
+        compare_pixel(image->at(3, 7), {0xF8, 0, 0, 0xFF});
+        compare_pixel(image->at(7, 7), {0, 0, 0xF8, 0xFF});
+        compare_pixel(image->at(4, 4), {0, 0, 0xF8, 0xFF});
+        compare_pixel(image->at(5, 4), {0xF8, 0, 0, 0xFF});
+        compare_pixel(image->at(6, 4), {82, 0, 165, 0xFF});
+        compare_pixel(image->at(7, 4), {165, 0, 82, 0xFF});
+        compare_pixel(image->at(4, 5), {0, 0, 0xF8, 0xFF});
+    }
+
+    SECTION("BC4")
+    {
+        BlockWriter writer(8);
+        writer.put(200, 8).put(100, 8).put(0, 3).put(1, 3).put(2, 3);
+        io::MemoryByteStream input_stream(writer.data);
+        const auto image = dxt::decode_bc4(input_stream, 4, 4);
+        compare_pixel(image->at(0, 0), {200, 200, 200, 0xFF});
+        compare_pixel(image->at(1, 0), {100, 100, 100, 0xFF});
+        compare_pixel(image->at(2, 0), {185, 185, 185, 0xFF});
+    }
+
+    SECTION("BC5")
+    {
+        BlockWriter writer(16);
+        writer.put(200, 8).put(100, 8).put(1, 3).put(0, 45);
+        writer.put(50, 8).put(10, 8).put(0, 3).put(1, 3);
+        io::MemoryByteStream input_stream(writer.data);
+        const auto image = dxt::decode_bc5(input_stream, 4, 4);
+        compare_pixel(image->at(0, 0), {0, 50, 100, 0xFF});
+        compare_pixel(image->at(1, 0), {0, 10, 200, 0xFF});
+    }
+
+    SECTION("BC7 with single subset")
+    {
+        BlockWriter writer(16);
+        writer.put(1 << 6, 7);
+        writer.put(127, 7).put(0, 7);
+        writer.put(0, 7).put(127, 7);
+        writer.put(64, 7).put(64, 7);
+        writer.put(127, 7).put(127, 7);
+        writer.put(1, 1).put(0, 1);
+        writer.put(0, 3);
+        for (const auto i : algo::range(1, 15))
+            writer.put(i == 5 ? 8 : 0, 4);
+        writer.put(15, 4);
+        io::MemoryByteStream input_stream(writer.data);
+        const auto image = dxt::decode_bc7(input_stream, 4, 4);
+        compare_pixel(image->at(0, 0), {129, 1, 255, 255});
+        compare_pixel(image->at(1, 1), {128, 135, 120, 254});
+        compare_pixel(image->at(3, 3), {128, 254, 0, 254});
+    }
+
+    SECTION("BC7 with two subsets")
+    {
+        BlockWriter writer(16);
+        writer.put(2, 2);
+        writer.put(0, 6);
+        writer.put(0, 6).put(0, 6).put(63, 6).put(63, 6);
+        writer.put(0, 6 * 8);
+        writer.put(0, 1).put(1, 1);
+        io::MemoryByteStream input_stream(writer.data);
+        const auto image = dxt::decode_bc7(input_stream, 4, 4);
+        compare_pixel(image->at(0, 0), {0, 0, 0, 0xFF});
+        compare_pixel(image->at(1, 3), {0, 0, 0, 0xFF});
+        compare_pixel(image->at(2, 0), {2, 2, 255, 0xFF});
+        compare_pixel(image->at(3, 3), {2, 2, 255, 0xFF});
+    }
+
+    SECTION("Truncated input")
+    {
+        io::MemoryByteStream input_stream(bstr(8 * 3));
+        REQUIRE_THROWS(dxt::decode_dxt1(input_stream, 8, 8));
+    }
+}
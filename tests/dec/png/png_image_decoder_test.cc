@@ -99,3 +99,40 @@ TEST_CASE("PNG images with extra chunks", "[dec]")
         REQUIRE(chunks["POSn"] == "\x00\x00\x00\x6C\x00\x00\x00\x60"_b);
     }
 }
+
+TEST_CASE("PNG images with uncommon pixel formats", "[dec]")
+{
+    Logger dummy_logger;
+    dummy_logger.mute();
+    const auto decoder = PngImageDecoder();
+
+    SECTION("2-bit palette with transparency")
+    {
+        const auto input_file = tests::file_from_path(dir + "palette_2bit.png");
+        const auto image = decoder.decode(dummy_logger, *input_file);
+        REQUIRE(image.width() == 2);
+        REQUIRE(image.height() == 2);
+        REQUIRE(image.at(0, 0) == res::Pixel({0, 0, 0xFF, 0xFF}));
+        REQUIRE(image.at(1, 0) == res::Pixel({0, 0xFF, 0, 0x80}));
+        REQUIRE(image.at(0, 1) == res::Pixel({30, 20, 10, 0xFF}));
+        REQUIRE(image.at(1, 1) == res::Pixel({0, 0, 0xFF, 0xFF}));
+    }
+
+    SECTION("16-bit grayscale with alpha")
+    {
+        const auto input_file
+            = tests::file_from_path(dir + "gray_alpha_16bit.png");
+        const auto image = decoder.decode(dummy_logger, *input_file);
+        REQUIRE(image.at(0, 0) == res::Pixel({0x12, 0x12, 0x12, 0xFF}));
+        REQUIRE(image.at(1, 0) == res::Pixel({0xAB, 0xAB, 0xAB, 0x80}));
+    }
+
+    SECTION("Trailing data is left in the stream")
+    {
+        const auto png_data = tests::file_from_path(dir + "palette_2bit.png")
+            ->stream.read_to_eof();
+        io::File input_file("test.png", png_data + "trailer"_b);
+        decoder.decode(dummy_logger, input_file);
+        REQUIRE(input_file.stream.pos() == png_data.size());
+    }
+}
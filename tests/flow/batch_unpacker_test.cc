@@ -0,0 +1,221 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "flow/batch_unpacker.h"
+#include <mutex>
+#include "algo/format.h"
+#include "algo/range.h"
+#include "err.h"
+#include "flow/file_saver_callback.h"
+#include "test_support/catch.h"
+
+using namespace au;
+
+static const auto archive_path
+    = "tests/dec/kirikiri/files/xp3/xp3-shuffled.xp3";
+
+TEST_CASE("Parsing batch jobs", "[flow]")
+{
+    SECTION("Options and input paths")
+    {
+        const auto job = flow::parse_batch_job(
+            "--out=dir -d=kirikiri/xp3 --plugin=noop --rename a.xp3 b.xp3");
+        REQUIRE(job.output_dir == io::path("dir"));
+        REQUIRE(job.decoder == "kirikiri/xp3");
+        REQUIRE(!job.overwrite);
+        REQUIRE(job.enable_nested_decoding);
+        REQUIRE(job.input_paths.size() == 2);
+        REQUIRE(job.input_paths[0] == io::path("a.xp3"));
+        REQUIRE(job.input_paths[1] == io::path("b.xp3"));
+        REQUIRE(job.arguments.size() == 6);
+        REQUIRE(job.arguments[2] == "--plugin=noop");
+    }
+
+    SECTION("Defaults")
+    {
+        const auto job = flow::parse_batch_job("  --no-recurse\ta.xp3 ");
+        REQUIRE(job.output_dir == io::path("./"));
+        REQUIRE(job.decoder.empty());
+        REQUIRE(job.overwrite);
+        REQUIRE(!job.enable_nested_decoding);
+        REQUIRE(job.input_paths.size() == 1);
+    }
+
+    SECTION("Quoting")
+    {
+        const auto job = flow::parse_batch_job(
+            R"(--out="my dir" 'it''s "here"' a\ b.xp3 "")");
+        REQUIRE(job.output_dir == io::path("my dir"));
+        REQUIRE(job.input_paths.size() == 3);
+        REQUIRE(job.input_paths[0] == io::path("its \"here\""));
+        REQUIRE(job.input_paths[1] == io::path("a b.xp3"));
+        REQUIRE(job.input_paths[2] == io::path(""));
+    }
+
+    SECTION("Malformed jobs")
+    {
+        REQUIRE_THROWS_AS(
+            flow::parse_batch_job("--out=dir"), err::UsageError);
+        REQUIRE_THROWS_AS(
+            flow::parse_batch_job("\"a.xp3"), err::UsageError);
+        REQUIRE_THROWS_AS(
+            flow::parse_batch_job("a.xp3\\"), err::UsageError);
+    }
+}
+
+TEST_CASE("Batch unpacking", "[flow]")
+{
+    if (!dec::Registry::instance().has_decoder("kirikiri/xp3"))
+        return;
+
+    Logger dummy_logger;
+    dummy_logger.mute();
+
+    std::mutex mutex;
+    std::vector<flow::BatchJobResult> results(3);
+    std::vector<std::vector<io::path>> saved_paths(3);
+    const auto make_file_saver = [&](const size_t job_index)
+    {
+        return std::make_unique<flow::FileSaverCallback>(
+            [&, job_index](std::shared_ptr<io::File> saved_file)
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                saved_paths[job_index].push_back(saved_file->path);
+            });
+    };
+
+    SECTION("Jobs have their own settings")
+    {
+        const flow::BatchUnpackerContext context(
+            dummy_logger, dec::Registry::instance(), {}, 0, 0, {});
+        flow::BatchUnpacker batch_unpacker(context);
+        const std::vector<std::string> lines
+        {
+            algo::format("--plugin=noop %s", archive_path),
+            algo::format("%s", archive_path),
+            algo::format("--dec=kirikiri/xp3 --plugin=noop %s", archive_path),
+        };
+        batch_unpacker.run(4, [&]()
+        {
+            for (const auto i : algo::range(lines.size()))
+            {
+                batch_unpacker.add_job(
+                    flow::parse_batch_job(lines[i]),
+                    make_file_saver(i),
+                    [&, i](const flow::BatchJobResult &result)
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        results[i] = result;
+                    });
+            }
+        });
+
+        for (const auto i : {0, 2})
+        {
+            REQUIRE(results[i].input_file_count == 1);
+            REQUIRE(results[i].error_count == 0);
+            REQUIRE(results[i].saved_file_count == 2);
+            REQUIRE(saved_paths[i].size() == 2);
+        }
+        // no plugin chosen
+        REQUIRE(results[1].error_count == 1);
+        REQUIRE(results[1].saved_file_count == 0);
+        REQUIRE(saved_paths[1].empty());
+    }
+
+    SECTION("Default arguments apply to every job")
+    {
+        const flow::BatchUnpackerContext context(
+            dummy_logger, dec::Registry::instance(), {}, 0, 0,
+            {"--plugin=noop"});
+        flow::BatchUnpacker batch_unpacker(context);
+        batch_unpacker.run(2, [&]()
+        {
+            batch_unpacker.add_job(
+                flow::parse_batch_job(algo::format("%s", archive_path)),
+                make_file_saver(0),
+                [&](const flow::BatchJobResult &result)
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    results[0] = result;
+                });
+        });
+
+        REQUIRE(results[0].error_count == 0);
+        REQUIRE(results[0].saved_file_count == 2);
+        REQUIRE(saved_paths[0].size() == 2);
+    }
+
+    SECTION("Unknown decoders are rejected")
+    {
+        const flow::BatchUnpackerContext context(
+            dummy_logger, dec::Registry::instance(), {}, 0, 0, {});
+        flow::BatchUnpacker batch_unpacker(context);
+        batch_unpacker.run(1, [&]()
+        {
+            REQUIRE_THROWS_AS(
+                batch_unpacker.add_job(
+                    flow::parse_batch_job(
+                        algo::format("--dec=nonexistent %s", archive_path)),
+                    make_file_saver(0),
+                    nullptr),
+                err::UsageError);
+        });
+    }
+
+    SECTION("Producers throwing anything fail the run")
+    {
+        const flow::BatchUnpackerContext context(
+            dummy_logger, dec::Registry::instance(), {}, 0, 0, {});
+        flow::BatchUnpacker batch_unpacker(context);
+        REQUIRE(!batch_unpacker.run(2, []() { throw 1; }));
+    }
+
+    SECTION("Jobs over the memory budget wait for the others")
+    {
+        const flow::BatchUnpackerContext context(
+            dummy_logger, dec::Registry::instance(), {}, 0, 1, {});
+        flow::BatchUnpacker batch_unpacker(context);
+        std::vector<std::string> events;
+        batch_unpacker.run(4, [&]()
+        {
+            for (const auto i : algo::range(3))
+            {
+                auto file_saver = std::make_unique<flow::FileSaverCallback>(
+                    [&, i](std::shared_ptr<io::File> saved_file)
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        events.push_back(algo::format("save %d", i));
+                    });
+                batch_unpacker.add_job(
+                    flow::parse_batch_job(
+                        algo::format("--plugin=noop %s", archive_path)),
+                    std::move(file_saver),
+                    [&, i](const flow::BatchJobResult &result)
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        events.push_back(algo::format("finish %d", i));
+                    });
+            }
+        });
+        REQUIRE(events == std::vector<std::string>({
+            "save 0", "save 0", "finish 0",
+            "save 1", "save 1", "finish 1",
+            "save 2", "save 2", "finish 2",
+        }));
+    }
+}
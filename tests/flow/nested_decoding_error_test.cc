@@ -145,8 +145,8 @@ TEST_CASE("Erroreus nested files still get unpacked", "[flow]")
     const auto saved_files = tests::flow_unpack(*registry, true, dummy_file);
 
     REQUIRE(saved_files.size() == 2);
-    tests::compare_paths(saved_files[0]->path, "archive.arc/erroreus.rgb");
-    tests::compare_paths(saved_files[1]->path, "archive.arc/undecoded.txt");
+    tests::compare_paths(saved_files[0]->path, "archive.arc/undecoded.txt");
+    tests::compare_paths(saved_files[1]->path, "archive.arc/erroreus.rgb");
     REQUIRE(saved_files[0]->stream.read_to_eof() == "original"_b);
     REQUIRE(saved_files[1]->stream.read_to_eof() == "original"_b);
 }
@@ -180,11 +180,11 @@ TEST_CASE("Erroreus nested archive entries do not copy archives", "[flow]")
     const auto saved_files = tests::flow_unpack(*registry, true, dummy_file);
 
     REQUIRE(saved_files.size() == 3);
-    tests::compare_paths(
-        saved_files[0]->path, "archive.arc/nested.arc/erroreus.rgb");
+    tests::compare_paths(saved_files[0]->path, "archive.arc/erroreus.rgb");
     tests::compare_paths(
         saved_files[1]->path, "archive.arc/nested.arc/undecoded.txt");
-    tests::compare_paths(saved_files[2]->path, "archive.arc/erroreus.rgb");
+    tests::compare_paths(
+        saved_files[2]->path, "archive.arc/nested.arc/erroreus.rgb");
     REQUIRE(saved_files[0]->stream.read_to_eof() == "original"_b);
     REQUIRE(saved_files[1]->stream.read_to_eof() == "original"_b);
     REQUIRE(saved_files[2]->stream.read_to_eof() == "original"_b);
@@ -0,0 +1,133 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "flow/task_scheduler.h"
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include "algo/range.h"
+#include "test_support/catch.h"
+
+using namespace au;
+using namespace au::flow;
+
+namespace
+{
+    class TestTask final : public ITask
+    {
+    public:
+        TestTask(std::vector<int> &output, std::mutex &mutex, const int id)
+            : output(output), mutex(mutex), id(id)
+        {
+        }
+
+        bool work() const override
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            output.push_back(id);
+            return true;
+        }
+
+    private:
+        std::vector<int> &output;
+        std::mutex &mutex;
+        const int id;
+    };
+}
+
+TEST_CASE("Task scheduler", "[flow]")
+{
+    TaskScheduler task_scheduler;
+    std::vector<int> output;
+    std::mutex output_mutex;
+
+    SECTION("Weighted tasks run heaviest first after regular tasks")
+    {
+        task_scheduler.push_weighted(
+            std::make_shared<TestTask>(output, output_mutex, 1), 10);
+        task_scheduler.push_weighted(
+            std::make_shared<TestTask>(output, output_mutex, 2), 30);
+        task_scheduler.push_back(
+            std::make_shared<TestTask>(output, output_mutex, 3));
+        task_scheduler.push_weighted(
+            std::make_shared<TestTask>(output, output_mutex, 4), 20);
+        const auto result = task_scheduler.run(1);
+        REQUIRE(result.success_count == 4);
+        REQUIRE(result.error_count == 0);
+        REQUIRE(output == std::vector<int>({3, 2, 4, 1}));
+    }
+
+    SECTION("Sequences run in order ahead of other tasks")
+    {
+        task_scheduler.push_back(
+            std::make_shared<TestTask>(output, output_mutex, 1));
+        std::vector<std::shared_ptr<ITask>> sequence;
+        for (const auto i : algo::range(2, 40))
+            sequence.push_back(
+                std::make_shared<TestTask>(output, output_mutex, i));
+        task_scheduler.push_front_sequence(sequence);
+        task_scheduler.push_front(
+            std::make_shared<TestTask>(output, output_mutex, 0));
+        const auto result = task_scheduler.run(1);
+        REQUIRE(result.success_count == 40);
+        std::vector<int> expected_output;
+        expected_output.push_back(0);
+        for (const auto i : algo::range(2, 40))
+            expected_output.push_back(i);
+        expected_output.push_back(1);
+        REQUIRE(output == expected_output);
+    }
+
+    SECTION("Sequences are split between workers")
+    {
+        std::vector<std::shared_ptr<ITask>> sequence;
+        for (const auto i : algo::range(1000))
+            sequence.push_back(
+                std::make_shared<TestTask>(output, output_mutex, i));
+        task_scheduler.push_front_sequence(sequence);
+        const auto result = task_scheduler.run(4);
+        REQUIRE(result.success_count == 1000);
+        std::sort(output.begin(), output.end());
+        for (const auto i : algo::range(1000))
+            REQUIRE(output[i] == i);
+    }
+
+    SECTION("Workers wait for producers")
+    {
+        task_scheduler.start_producing();
+        std::thread producer_thread([&]()
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            task_scheduler.push_back(
+                std::make_shared<TestTask>(output, output_mutex, 1));
+            task_scheduler.finish_producing();
+        });
+        const auto result = task_scheduler.run(1);
+        producer_thread.join();
+        REQUIRE(result.success_count == 1);
+        REQUIRE(output == std::vector<int>({1}));
+    }
+
+    SECTION("Finishing without any tasks")
+    {
+        task_scheduler.start_producing();
+        task_scheduler.finish_producing();
+        const auto result = task_scheduler.run(2);
+        REQUIRE(result.success_count == 0);
+        REQUIRE(result.error_count == 0);
+    }
+}
@@ -0,0 +1,117 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "flow/unpack_daemon.h"
+#include <algorithm>
+#include <sys/stat.h>
+#include <thread>
+#include "algo/range.h"
+#include "err.h"
+#include "io/file_system.h"
+#include "test_support/catch.h"
+
+#ifndef _WIN32
+
+using namespace au;
+
+static const io::path socket_path = "tests/trash.sock";
+static const auto output_dir = io::absolute("tests/trash-daemon");
+static const auto archive_path
+    = io::absolute("tests/dec/kirikiri/files/xp3/xp3-shuffled.xp3").str();
+
+static std::vector<std::string> submit(const std::vector<std::string> &lines)
+{
+    flow::UnpackDaemonClient client(socket_path);
+    for (const auto &line : lines)
+        client.send(line);
+    client.finish_sending();
+    std::vector<std::string> responses;
+    std::string response;
+    while (client.receive(response))
+        responses.push_back(response);
+    return responses;
+}
+
+TEST_CASE("Unpack daemon", "[flow]")
+{
+    if (!dec::Registry::instance().has_decoder("kirikiri/xp3"))
+        return;
+
+    Logger dummy_logger;
+    dummy_logger.mute();
+    const flow::BatchUnpackerContext context(
+        dummy_logger, dec::Registry::instance(), {}, 0, 0, {});
+    flow::UnpackDaemon daemon(context, socket_path);
+    std::thread daemon_thread([&]() { daemon.run(2); });
+
+    REQUIRE_THROWS_AS(
+        flow::UnpackDaemon(context, socket_path), err::IoError);
+
+    struct stat socket_info;
+    REQUIRE(::stat(socket_path.c_str(), &socket_info) == 0);
+    REQUIRE((socket_info.st_mode & 0777) == 0600);
+
+    // a client that never reads its responses gets hung up on once they
+    // pile up, without holding up the workers or other clients
+    flow::UnpackDaemonClient silent_client(socket_path);
+    const auto silent_request = "job --dec=" + std::string(64 * 1024, 'x')
+        + " --out=" + output_dir.str() + " " + archive_path;
+    try
+    {
+        for (const auto i : algo::range(64))
+            silent_client.send(silent_request);
+    }
+    catch (const err::IoError &)
+    {
+    }
+
+    auto responses = submit({
+        "job --plugin=noop --out=" + output_dir.str() + " " + archive_path,
+        "job --dec=nonexistent --out=" + output_dir.str() + " " + archive_path,
+        "what",
+        "job --out=" + output_dir.str() + " relative.xp3",
+        "job " + archive_path,
+    });
+    std::sort(responses.begin(), responses.end());
+    REQUIRE(responses.size() == 7);
+    REQUIRE(responses[0].find("1 finished 2 0 ") == 0);
+    REQUIRE(responses[1].find("1 saved ") == 0);
+    REQUIRE(responses[2].find("1 saved ") == 0);
+    REQUIRE(responses[3] == "2 rejected Unknown decoder: nonexistent");
+    REQUIRE(responses[4] == "3 rejected Unknown request");
+    REQUIRE(responses[5]
+        == "4 rejected Input path must be absolute: relative.xp3");
+    REQUIRE(responses[6] == "5 rejected Output directory must be absolute: ./");
+
+    // idle clients don't keep the daemon from stopping
+    flow::UnpackDaemonClient idle_client(socket_path);
+    REQUIRE(submit({"stop"}).empty());
+    daemon_thread.join();
+    std::string response;
+    REQUIRE(!idle_client.receive(response));
+    size_t silent_response_count = 0;
+    while (silent_client.receive(response))
+        silent_response_count++;
+    REQUIRE(silent_response_count < 64);
+
+    for (const auto i : {1, 2})
+        io::remove(responses[i].substr(std::string("1 saved ").size()));
+    io::remove(output_dir / "xp3-shuffled~.xp3");
+    io::remove(output_dir);
+}
+
+#endif
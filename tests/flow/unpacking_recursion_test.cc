@@ -17,6 +17,7 @@
 
 #include "dec/base_archive_decoder.h"
 #include "dec/base_file_decoder.h"
+#include "dec/png/png_image_decoder.h"
 #include "io/memory_byte_stream.h"
 #include "test_support/catch.h"
 #include "test_support/common.h"
@@ -69,6 +70,9 @@ static std::unique_ptr<Registry> create_registry()
     registry->add_decoder(
         "test/test-image",
         []() { return std::make_shared<TestFileDecoder>(); });
+    registry->add_decoder(
+        "png/png",
+        []() { return std::make_shared<png::PngImageDecoder>(); });
     return registry;
 }
 
@@ -89,7 +93,7 @@ static bstr make_archive(
 
 std::vector<std::string> TestArchiveDecoder::get_linked_formats() const
 {
-    return {"test/test-image", "test/test-archive"};
+    return {"test/test-image", "test/test-archive", "png/png"};
 }
 
 bool TestFileDecoder::is_recognized_impl(io::File &input_file) const
@@ -162,6 +166,59 @@ TEST_CASE("Recursive unpacking with nested files", "[flow]")
     REQUIRE(saved_files[0]->stream.read_to_eof() == "decoded_image"_b);
 }
 
+TEST_CASE("Recursive unpacking keeping nested images as-is", "[flow]")
+{
+    const auto registry = create_registry();
+    TestArchiveDecoder archive_decoder;
+
+    const auto png_content = "\x89PNG\x0D\x0A\x1A\x0Aoriginal"_b;
+    const std::map<std::string, flow::NestedImagePolicy> policies
+        = {{"png/png", flow::NestedImagePolicy::Keep}};
+
+    SECTION("Images with the right extension")
+    {
+        io::File dummy_file(
+            "archive.arc",
+            make_archive({tests::stub_file("image.png", png_content)}));
+        const auto saved_files = tests::flow_unpack(
+            *registry, true, dummy_file, policies);
+        REQUIRE(saved_files.size() == 1);
+        tests::compare_paths(saved_files[0]->path, "archive.arc/image.png");
+        REQUIRE(saved_files[0]->stream.read_to_eof() == png_content);
+    }
+
+    SECTION("Images without extension")
+    {
+        io::File dummy_file(
+            "archive.arc",
+            make_archive({tests::stub_file("image", png_content)}));
+        const auto saved_files = tests::flow_unpack(
+            *registry, true, dummy_file, policies);
+        REQUIRE(saved_files.size() == 1);
+        tests::compare_paths(saved_files[0]->path, "archive.arc/image.png");
+        REQUIRE(saved_files[0]->stream.read_to_eof() == png_content);
+    }
+}
+
+TEST_CASE("Recursive unpacking ignoring keep policy for non-images", "[flow]")
+{
+    const auto registry = create_registry();
+    TestArchiveDecoder archive_decoder;
+
+    io::File dummy_file(
+        "archive.arc",
+        make_archive({tests::stub_file("image.rgb", "original"_b)}));
+
+    const auto saved_files = tests::flow_unpack(
+        *registry,
+        true,
+        dummy_file,
+        {{"test/test-image", flow::NestedImagePolicy::Keep}});
+    REQUIRE(saved_files.size() == 1);
+    tests::compare_paths(saved_files[0]->path, "archive.arc/image.png");
+    REQUIRE(saved_files[0]->stream.read_to_eof() == "decoded_image"_b);
+}
+
 TEST_CASE("Recursive unpacking with nested archives", "[flow]")
 {
     const auto registry = create_registry();
@@ -183,11 +240,11 @@ TEST_CASE("Recursive unpacking with nested archives", "[flow]")
     const auto saved_files = tests::flow_unpack(*registry, true, dummy_file);
     REQUIRE(saved_files.size() == 2);
     tests::compare_paths(
-        saved_files[0]->path, "outer.arc/inner.arc/nested/text.txt");
+        saved_files[0]->path, "outer.arc/inner.arc/nested/image.png");
     tests::compare_paths(
-        saved_files[1]->path, "outer.arc/inner.arc/nested/image.png");
-    REQUIRE(saved_files[0]->stream.read_to_eof() == "text"_b);
-    REQUIRE(saved_files[1]->stream.read_to_eof() == "decoded_image"_b);
+        saved_files[1]->path, "outer.arc/inner.arc/nested/text.txt");
+    REQUIRE(saved_files[0]->stream.read_to_eof() == "decoded_image"_b);
+    REQUIRE(saved_files[1]->stream.read_to_eof() == "text"_b);
 }
 
 TEST_CASE(
@@ -234,6 +291,9 @@ TEST_CASE(
                 { paths_for_conversion.push_back(f.path); };
             return decoder;
         });
+    registry->add_decoder(
+        "png/png",
+        []() { return std::make_shared<png::PngImageDecoder>(); });
 
     const auto inner_arc_content = make_archive(
         {
@@ -0,0 +1,143 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "io/base_block_cipher_stream.h"
+#include "algo/range.h"
+#include "io/memory_byte_stream.h"
+#include "test_support/catch.h"
+#include "test_support/common.h"
+
+using namespace au;
+
+static const size_t block_size = 16;
+
+static u8 get_key(const uoff_t offset)
+{
+    return (offset / block_size) * 7 + offset % block_size;
+}
+
+namespace
+{
+    class XorStream final : public io::BaseBlockCipherStream
+    {
+    public:
+        XorStream(
+            io::BaseByteStream &parent_stream,
+            const uoff_t offset,
+            const uoff_t size,
+            size_t &decrypted_blocks) :
+                BaseBlockCipherStream(parent_stream, block_size, offset, size),
+                decrypted_blocks(decrypted_blocks)
+        {
+        }
+
+        std::unique_ptr<BaseByteStream> clone() const override
+        {
+            auto ret = std::make_unique<XorStream>(
+                get_parent_stream(), get_offset(), size(), decrypted_blocks);
+            ret->seek(pos());
+            return std::move(ret);
+        }
+
+    protected:
+        void decrypt_blocks(
+            const uoff_t offset, u8 *data, const size_t size) const override
+        {
+            REQUIRE(offset % block_size == 0);
+            for (const auto i : algo::range(size))
+                data[i] ^= get_key(offset + i);
+            decrypted_blocks += (size + block_size - 1) / block_size;
+        }
+
+    private:
+        size_t &decrypted_blocks;
+    };
+}
+
+static bstr encrypt(const bstr &input)
+{
+    bstr output(input);
+    for (const auto i : algo::range(output.size()))
+        output[i] ^= get_key(i);
+    return output;
+}
+
+static bstr make_input(const size_t size)
+{
+    bstr input(size);
+    for (const auto i : algo::range(size))
+        input[i] = i * 13;
+    return input;
+}
+
+TEST_CASE("BaseBlockCipherStream", "[io][stream]")
+{
+    const auto input = make_input(200);
+    io::MemoryByteStream parent_stream(encrypt(input));
+    size_t decrypted_blocks = 0;
+
+    SECTION("Small sequential reads")
+    {
+        XorStream stream(parent_stream, 0, input.size(), decrypted_blocks);
+        bstr output;
+        while (stream.left())
+            output += stream.read(std::min<size_t>(stream.left(), 3));
+        tests::compare_binary(output, input);
+        REQUIRE(decrypted_blocks == 13);
+    }
+
+    SECTION("Repeated reads hit the cache")
+    {
+        XorStream stream(parent_stream, 0, input.size(), decrypted_blocks);
+        for (const auto i : algo::range(10))
+        {
+            stream.seek(20);
+            REQUIRE(stream.read<u8>() == input[20]);
+        }
+        REQUIRE(decrypted_blocks == 1);
+    }
+
+    SECTION("Bulk reads")
+    {
+        XorStream stream(parent_stream, 0, input.size(), decrypted_blocks);
+        stream.seek(5);
+        tests::compare_binary(stream.read(150), input.substr(5, 150));
+        tests::compare_binary(stream.read_to_eof(), input.substr(155));
+    }
+
+    SECTION("Unaligned windows")
+    {
+        XorStream stream(parent_stream, 37, 100, decrypted_blocks);
+        REQUIRE(stream.size() == 100);
+        tests::compare_binary(stream.read(10), input.substr(37, 10));
+        stream.seek(90);
+        tests::compare_binary(stream.read_to_eof(), input.substr(127, 10));
+        REQUIRE_THROWS(stream.seek(101));
+        stream.seek(95);
+        REQUIRE_THROWS(stream.read(6));
+    }
+
+    SECTION("Clones")
+    {
+        XorStream stream(parent_stream, 37, 100, decrypted_blocks);
+        stream.seek(10);
+        const auto clone = stream.clone();
+        REQUIRE(clone->pos() == 10);
+        tests::compare_binary(clone->read(20), input.substr(47, 20));
+        REQUIRE(stream.pos() == 10);
+    }
+}
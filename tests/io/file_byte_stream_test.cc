@@ -16,6 +16,10 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "io/file_byte_stream.h"
+#include <thread>
+#include <vector>
+#include "algo/range.h"
+#include "err.h"
 #include "io/file_system.h"
 #include "test_support/catch.h"
 #include "test_support/common.h"
@@ -51,6 +55,73 @@ TEST_CASE("FileByteStream", "[io][stream]")
         io::remove("tests/trash.out");
     }
 
+    SECTION("Mixing small and large reads")
+    {
+        const auto path = "tests/dec/png/files/reimu_transparent.png";
+        const auto expected = io::FileByteStream(path, io::FileMode::Read)
+            .read_to_eof();
+        io::FileByteStream stream(path, io::FileMode::Read);
+        bstr actual;
+        size_t chunk_size = 1;
+        while (stream.left())
+        {
+            actual += stream.read(std::min<size_t>(chunk_size, stream.left()));
+            chunk_size = chunk_size * 3 % 40000 + 1;
+        }
+        REQUIRE(actual == expected);
+        REQUIRE_THROWS_AS(stream.read(1), err::EofError);
+        stream.seek(3);
+        REQUIRE(stream.read(5) == expected.substr(3, 5));
+    }
+
+    SECTION("Cloning files opened for reading")
+    {
+        const auto path = "tests/dec/png/files/reimu_transparent.png";
+        io::FileByteStream stream(path, io::FileMode::Read);
+        const auto expected = stream.read_to_eof();
+        stream.seek(10);
+
+        const auto clone = stream.clone();
+        REQUIRE(clone->pos() == 10);
+        REQUIRE(clone->size() == stream.size());
+        clone->seek(20);
+        REQUIRE(stream.pos() == 10);
+        REQUIRE(clone->read(4) == expected.substr(20, 4));
+        REQUIRE(stream.read(4) == expected.substr(10, 4));
+
+        std::vector<bstr> results(4);
+        std::vector<std::thread> threads;
+        for (const auto i : algo::range(results.size()))
+        {
+            threads.push_back(std::thread([&, i]()
+            {
+                auto thread_stream = stream.clone();
+                thread_stream->seek(0);
+                while (thread_stream->left())
+                {
+                    results[i] += thread_stream->read(
+                        std::min<size_t>(i * 100 + 7, thread_stream->left()));
+                }
+            }));
+        }
+        for (auto &thread : threads)
+            thread.join();
+        for (const auto &result : results)
+            REQUIRE(result == expected);
+    }
+
+    SECTION("Prefetching")
+    {
+        const auto path = "tests/dec/png/files/reimu_transparent.png";
+        io::FileByteStream stream(path, io::FileMode::Read);
+        const auto expected = stream.read_to_eof();
+        stream.seek(10);
+        stream.prefetch(0, stream.size());
+        stream.prefetch(stream.size() + 100, 100);
+        REQUIRE(stream.pos() == 10);
+        REQUIRE(stream.read_to_eof() == expected.substr(10));
+    }
+
     SECTION("Full test suite")
     {
         tests::stream_test(
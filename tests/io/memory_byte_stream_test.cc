@@ -29,4 +29,76 @@ TEST_CASE("MemoryByteStream", "[io][stream]")
             []() { return std::make_unique<io::MemoryByteStream>(); },
             []() { });
     }
+
+    SECTION("Slices")
+    {
+        io::MemoryByteStream parent_stream("abcdef"_b);
+        parent_stream.seek(1);
+        auto slice_stream = io::MemoryByteStream::slice(parent_stream, 3);
+        REQUIRE(parent_stream.pos() == 4);
+        REQUIRE(slice_stream->size() == 3);
+        REQUIRE(slice_stream->read_to_eof() == "bcd"_b);
+        REQUIRE(parent_stream.read_to_eof() == "ef"_b);
+    }
+
+    SECTION("Nested slices")
+    {
+        io::MemoryByteStream parent_stream("abcdef"_b);
+        parent_stream.seek(1);
+        auto slice_stream = io::MemoryByteStream::slice(parent_stream, 4);
+        slice_stream->seek(1);
+        auto nested_stream = io::MemoryByteStream::slice(*slice_stream, 2);
+        REQUIRE(nested_stream->read_to_eof() == "cd"_b);
+        REQUIRE(slice_stream->read_to_eof() == "e"_b);
+    }
+
+    SECTION("Slices beyond EOF")
+    {
+        io::MemoryByteStream parent_stream("abc"_b);
+        parent_stream.seek(1);
+        REQUIRE_THROWS(io::MemoryByteStream::slice(parent_stream, 3));
+        REQUIRE(parent_stream.pos() == 1);
+    }
+
+    SECTION("Writing to slices does not affect parent")
+    {
+        io::MemoryByteStream parent_stream("abcdef"_b);
+        parent_stream.seek(2);
+        auto slice_stream = io::MemoryByteStream::slice(parent_stream, 2);
+        slice_stream->write("XYZ"_b);
+        REQUIRE(slice_stream->seek(0).read_to_eof() == "XYZ"_b);
+        REQUIRE(parent_stream.seek(0).read_to_eof() == "abcdef"_b);
+    }
+
+    SECTION("Writing to parent does not affect slices")
+    {
+        io::MemoryByteStream parent_stream("abcdef"_b);
+        auto slice_stream = io::MemoryByteStream::slice(parent_stream, 3);
+        parent_stream.seek(0).write("XYZ"_b);
+        parent_stream.resize(4);
+        REQUIRE(parent_stream.seek(0).read_to_eof() == "XYZd"_b);
+        REQUIRE(slice_stream->read_to_eof() == "abc"_b);
+    }
+
+    SECTION("Resizing clones does not affect slices")
+    {
+        io::MemoryByteStream parent_stream("abcdef"_b);
+        auto clone_stream = parent_stream.clone();
+        parent_stream.seek(2);
+        auto slice_stream = io::MemoryByteStream::slice(parent_stream, 4);
+        clone_stream->resize(1);
+        clone_stream->seek(0).write("X"_b);
+        REQUIRE(clone_stream->seek(0).read_to_eof() == "X"_b);
+        REQUIRE(slice_stream->read_to_eof() == "cdef"_b);
+        REQUIRE(parent_stream.seek(0).read_to_eof() == "abcdef"_b);
+    }
+
+    SECTION("Copying from memory streams does not alias them")
+    {
+        io::MemoryByteStream parent_stream("abcdef"_b);
+        io::MemoryByteStream copy_stream(parent_stream, 3);
+        copy_stream.seek(0).write("X"_b);
+        REQUIRE(copy_stream.seek(0).read_to_eof() == "Xbc"_b);
+        REQUIRE(parent_stream.seek(0).read_to_eof() == "abcdef"_b);
+    }
 }
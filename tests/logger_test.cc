@@ -0,0 +1,133 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "logger.h"
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "algo/format.h"
+#include "algo/range.h"
+#include "algo/str.h"
+#include "test_support/catch.h"
+
+using namespace au;
+
+namespace
+{
+    class CapturedOutput final
+    {
+    public:
+        CapturedOutput() :
+            old_cout(std::cout.rdbuf(cout_stream.rdbuf())),
+            old_cerr(std::cerr.rdbuf(cerr_stream.rdbuf()))
+        {
+        }
+
+        ~CapturedOutput()
+        {
+            std::cout.rdbuf(old_cout);
+            std::cerr.rdbuf(old_cerr);
+        }
+
+        std::stringstream cout_stream;
+        std::stringstream cerr_stream;
+
+    private:
+        std::streambuf *old_cout;
+        std::streambuf *old_cerr;
+    };
+}
+
+TEST_CASE("Logger", "[core]")
+{
+    Logger logger;
+    logger.disable_colors();
+
+    SECTION("Plain text")
+    {
+        CapturedOutput output;
+        logger.set_prefix("[task 1] ");
+        logger.info("first %d\nsecond\n", 1);
+        logger.warn("careful\n");
+        logger.flush();
+        REQUIRE(output.cout_stream.str()
+            == "[task 1] first 1\n[task 1] second\n");
+        REQUIRE(output.cerr_stream.str() == "[task 1] careful\n");
+    }
+
+    SECTION("Muted messages")
+    {
+        CapturedOutput output;
+        logger.mute(Logger::MessageType::Info);
+        logger.info("hidden\n");
+        logger.success("shown\n");
+        logger.flush();
+        REQUIRE(output.cout_stream.str() == "shown\n");
+    }
+
+    SECTION("JSON lines")
+    {
+        CapturedOutput output;
+        logger.enable_json();
+        logger.set_prefix("[task 1] ");
+        logger.log(Logger::MessageType::Summary, "Executed ");
+        logger.log(Logger::MessageType::Summary, "\"5\" tasks\n");
+        logger.err("bad\tdata\n");
+        logger.flush();
+        REQUIRE(output.cout_stream.str()
+            == "{\"type\": \"summary\", \"prefix\": \"[task 1] \", "
+                "\"message\": \"Executed \\\"5\\\" tasks\"}\n");
+        REQUIRE(output.cerr_stream.str()
+            == "{\"type\": \"error\", \"prefix\": \"[task 1] \", "
+                "\"message\": \"bad\\tdata\"}\n");
+    }
+
+    SECTION("Messages of each logger keep their order")
+    {
+        CapturedOutput output;
+        std::vector<std::thread> threads;
+        for (const auto i : algo::range(4))
+        {
+            threads.push_back(std::thread([&, i]()
+            {
+                Logger task_logger(logger);
+                task_logger.set_prefix(algo::format("%d ", i));
+                for (const auto j : algo::range(100))
+                    task_logger.info("%d\n", j);
+            }));
+        }
+        for (auto &thread : threads)
+            thread.join();
+        logger.flush();
+
+        std::map<int, int> next_numbers;
+        const auto lines = algo::split(output.cout_stream.str(), '\n', false);
+        for (const auto &line : lines)
+        {
+            if (line.empty())
+                continue;
+            const auto parts = algo::split(line, ' ', false);
+            REQUIRE(parts.size() == 2);
+            const auto task = algo::from_string<int>(parts[0]);
+            const auto number = algo::from_string<int>(parts[1]);
+            REQUIRE(number == next_numbers[task]++);
+        }
+        REQUIRE(next_numbers.size() == 4);
+    }
+}
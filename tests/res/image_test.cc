@@ -17,6 +17,7 @@
 
 #include "res/image.h"
 #include "algo/range.h"
+#include "err.h"
 #include "test_support/catch.h"
 
 using namespace au;
@@ -169,6 +170,51 @@ TEST_CASE("Image overlays", "[res]")
     }
 }
 
+TEST_CASE("Image overlay blending", "[res]")
+{
+    // odd widths exercise both the vectorized part and the remainder
+    const auto width = 7;
+    res::Image overlay(width, 3);
+    res::Image base(width, 3);
+    for (const auto y : algo::range(overlay.height()))
+    for (const auto x : algo::range(overlay.width()))
+    {
+        overlay.at(x, y) = {
+            static_cast<u8>(x * 40),
+            static_cast<u8>(y * 50),
+            200,
+            static_cast<u8>((x + y) % 3 ? 0x80 : 0)};
+        base.at(x, y) = {100, 100, 100, 0x40};
+    }
+
+    SECTION("Overwriting non-transparent pixels")
+    {
+        base.overlay(
+            overlay, 0, 1, res::Image::OverlayKind::OverwriteNonTransparent);
+        for (const auto y : algo::range(base.height()))
+        for (const auto x : algo::range(base.width()))
+        {
+            const auto expected = y >= 1 && overlay.at(x, y - 1).a
+                ? overlay.at(x, y - 1)
+                : res::Pixel {100, 100, 100, 0x40};
+            REQUIRE(base.at(x, y) == expected);
+        }
+    }
+
+    SECTION("Adding colors")
+    {
+        base.overlay(overlay, res::Image::OverlayKind::AddSimple);
+        for (const auto y : algo::range(base.height()))
+        for (const auto x : algo::range(base.width()))
+        {
+            REQUIRE(base.at(x, y).b == static_cast<u8>(100 + x * 40));
+            REQUIRE(base.at(x, y).g == static_cast<u8>(100 + y * 50));
+            REQUIRE(base.at(x, y).r == static_cast<u8>(300));
+            REQUIRE(base.at(x, y).a == 0x40);
+        }
+    }
+}
+
 TEST_CASE("Image cropping", "[res]")
 {
     SECTION("Cutting pixels")
@@ -215,6 +261,30 @@ TEST_CASE("Image cropping", "[res]")
             REQUIRE(image.at(x, y).a == 0);
         }
     }
+
+    SECTION("Cutting columns, expanding rows")
+    {
+        auto image = create_test_image(5, 5);
+        image.crop(3, 7);
+        for (const auto x : algo::range(image.width()))
+        for (const auto y : algo::range(image.height()))
+        {
+            REQUIRE(image.at(x, y).r == (y < 5 ? x : 0));
+            REQUIRE(image.at(x, y).g == (y < 5 ? y : 0));
+        }
+    }
+
+    SECTION("Expanding columns, cutting rows")
+    {
+        auto image = create_test_image(5, 5);
+        image.crop(7, 3);
+        for (const auto x : algo::range(image.width()))
+        for (const auto y : algo::range(image.height()))
+        {
+            REQUIRE(image.at(x, y).r == (x < 5 ? x : 0));
+            REQUIRE(image.at(x, y).g == (x < 5 ? y : 0));
+        }
+    }
 }
 
 TEST_CASE("Image offsetting", "[res]")
@@ -269,3 +339,105 @@ TEST_CASE("Image offsetting", "[res]")
         }
     }
 }
+
+TEST_CASE("Image views", "[res]")
+{
+    auto image = create_test_image(5, 4);
+
+    SECTION("Cropped views")
+    {
+        const auto view = image.view(1, 2, 3, 2);
+        REQUIRE(view.width() == 3);
+        REQUIRE(view.height() == 2);
+        REQUIRE(view.stride() == 5);
+        for (const auto x : algo::range(view.width()))
+        for (const auto y : algo::range(view.height()))
+        {
+            REQUIRE(view.at(x, y).r == x + 1);
+            REQUIRE(view.at(x, y).g == y + 2);
+        }
+        REQUIRE(&view.at(0, 0) == &image.at(1, 2));
+        REQUIRE_THROWS(image.view(3, 0, 3, 1));
+    }
+
+    SECTION("Flipped views")
+    {
+        const auto view = image.view().flip_vertically();
+        for (const auto x : algo::range(view.width()))
+        for (const auto y : algo::range(view.height()))
+            REQUIRE(view.at(x, y) == image.at(x, image.height() - 1 - y));
+    }
+
+    SECTION("Materializing views")
+    {
+        const res::Image copy(image.view(1, 1, 2, 3).flip_vertically());
+        REQUIRE(copy.width() == 2);
+        REQUIRE(copy.height() == 3);
+        for (const auto x : algo::range(copy.width()))
+        for (const auto y : algo::range(copy.height()))
+            REQUIRE(copy.at(x, y) == image.at(x + 1, 3 - y));
+    }
+
+    SECTION("Overlaying views")
+    {
+        res::Image target(2, 2);
+        target.overlay(
+            image.view(3, 2, 2, 2), res::Image::OverlayKind::OverwriteAll);
+        for (const auto x : algo::range(target.width()))
+        for (const auto y : algo::range(target.height()))
+            REQUIRE(target.at(x, y) == image.at(x + 3, y + 2));
+    }
+}
+
+TEST_CASE("Image buffers", "[res]")
+{
+    SECTION("Adopting BGRA buffers")
+    {
+        bstr data(2 * 3 * 4);
+        for (const auto i : algo::range(data.size()))
+            data[i] = i;
+        const auto data_ptr = data.get<const u8>();
+        res::Image image(2, 3, std::move(data), res::PixelFormat::BGRA8888);
+        REQUIRE(reinterpret_cast<const u8*>(image.begin()) == data_ptr);
+        REQUIRE(image.at(1, 2) == res::Pixel {20, 21, 22, 23});
+    }
+
+    SECTION("Converting other formats")
+    {
+        res::Image image(
+            2, 1, "\x01\x02\x03\x04\x05\x06"_b, res::PixelFormat::BGR888);
+        REQUIRE(image.at(1, 0) == res::Pixel {4, 5, 6, 0xFF});
+    }
+
+    SECTION("Too small buffers")
+    {
+        REQUIRE_THROWS_AS(
+            res::Image(2, 2, bstr(15), res::PixelFormat::BGRA8888),
+            err::BadDataSizeError);
+        REQUIRE_THROWS_AS(res::Image(2, 2, bstr(15)), err::BadDataSizeError);
+    }
+
+    SECTION("Moving and cloning")
+    {
+        auto image = create_test_image(3, 3);
+        const auto clone = image.clone();
+        REQUIRE(clone.begin() != image.begin());
+        const auto pixels = image.begin();
+        const auto moved = std::move(image);
+        REQUIRE(moved.begin() == pixels);
+        REQUIRE(moved.width() == 3);
+        for (const auto x : algo::range(moved.width()))
+        for (const auto y : algo::range(moved.height()))
+            REQUIRE(moved.at(x, y) == clone.at(x, y));
+    }
+
+    SECTION("Releasing the buffer")
+    {
+        auto image = create_test_image(3, 2);
+        const auto pixels = reinterpret_cast<const u8*>(image.begin());
+        const auto data = image.release();
+        REQUIRE(data.size() == 3 * 2 * 4);
+        REQUIRE(data.get<const u8>() == pixels);
+        REQUIRE(image.width() == 0);
+    }
+}
@@ -17,14 +17,15 @@
 
 #include "test_support/flow_support.h"
 #include "flow/file_saver_callback.h"
-#include "flow/parallel_unpacker.h"
 
 using namespace au;
 
 std::vector<std::shared_ptr<io::File>> tests::flow_unpack(
     const dec::Registry &registry,
     const bool enable_nested_decoding,
-    io::File &input_file)
+    io::File &input_file,
+    const std::map<std::string, flow::NestedImagePolicy>
+        &nested_image_policies)
 {
     Logger dummy_logger;
     dummy_logger.mute();
@@ -44,7 +45,9 @@ std::vector<std::shared_ptr<io::File>> tests::flow_unpack(
         registry,
         enable_nested_decoding,
         {},
-        std::set<std::string>(name_list.begin(), name_list.end()));
+        std::set<std::string>(name_list.begin(), name_list.end()),
+        nested_image_policies,
+        0);
 
     flow::ParallelUnpacker unpacker(context);
     unpacker.add_input_file(
@@ -114,7 +114,8 @@ std::tuple<res::Image, algo::Grid<int>, res::Palette>
 
         output_grid.at(x, y) = palette_index;
     }
-    return std::make_tuple(output_image, output_grid, output_palette);
+    return std::make_tuple(
+        std::move(output_image), output_grid, output_palette);
 }
 
 void tests::compare_images(
@@ -19,6 +19,7 @@
 
 #include <memory>
 #include <tuple>
+#include "algo/grid.h"
 #include "io/file.h"
 #include "res/image.h"
 
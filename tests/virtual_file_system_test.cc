@@ -0,0 +1,97 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "virtual_file_system.h"
+#include <vector>
+#include "io/file_system.h"
+#include "test_support/catch.h"
+
+using namespace au;
+
+namespace
+{
+    struct TrashDirectory final
+    {
+        TrashDirectory(const io::path &path);
+        ~TrashDirectory();
+        void write(const std::string &name);
+
+        io::path path;
+        std::vector<io::path> files;
+    };
+}
+
+TrashDirectory::TrashDirectory(const io::path &path) : path(path)
+{
+    io::create_directories(path);
+}
+
+TrashDirectory::~TrashDirectory()
+{
+    VirtualFileSystem::clear();
+    for (const auto &file_path : files)
+        if (io::exists(file_path))
+            io::remove(file_path);
+    io::remove(path);
+}
+
+void TrashDirectory::write(const std::string &name)
+{
+    files.push_back(path / name);
+    io::File(files.back(), io::FileMode::Write).stream.write("x"_b);
+}
+
+TEST_CASE("Virtual file system", "[core]")
+{
+    TrashDirectory directory("tests/trash-vfs");
+    directory.write("file_test.cc");
+    directory.write("path_test.cc");
+
+    SECTION("Looking up files in registered directories")
+    {
+        VirtualFileSystem::register_directory(directory.path);
+        auto file = VirtualFileSystem::get_by_name("FILE_TEST.CC");
+        REQUIRE(file);
+        REQUIRE(file->path.name() == "file_test.cc");
+        REQUIRE(VirtualFileSystem::get_by_stem("Path_Test"));
+        REQUIRE(VirtualFileSystem::get_by_path("TESTS/TRASH-VFS/PATH_TEST.CC"));
+        REQUIRE(!VirtualFileSystem::get_by_name("nonexistent.cc"));
+    }
+
+    SECTION("Refreshing registered directories")
+    {
+        const std::string name = "refresh_test.tmp";
+        VirtualFileSystem::register_directory(directory.path);
+        REQUIRE(!VirtualFileSystem::get_by_name(name));
+
+        directory.write(name);
+        REQUIRE(!VirtualFileSystem::get_by_name(name));
+        VirtualFileSystem::refresh_directory(directory.path);
+        REQUIRE(VirtualFileSystem::get_by_name(name));
+
+        io::remove(directory.path / name);
+        VirtualFileSystem::refresh_directory(directory.path);
+        REQUIRE(!VirtualFileSystem::get_by_name(name));
+    }
+
+    SECTION("Unregistering directories")
+    {
+        VirtualFileSystem::register_directory(directory.path);
+        VirtualFileSystem::unregister_directory(directory.path);
+        REQUIRE(!VirtualFileSystem::get_by_name("file_test.cc"));
+    }
+}